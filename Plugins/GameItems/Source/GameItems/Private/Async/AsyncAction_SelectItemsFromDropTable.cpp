@@ -0,0 +1,62 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "Async/AsyncAction_SelectItemsFromDropTable.h"
+
+#include "GameItem.h"
+#include "GameItemSubsystem.h"
+
+
+UAsyncAction_SelectItemsFromDropTable* UAsyncAction_SelectItemsFromDropTable::SelectItemsFromDropTableAsync(
+	UObject* WorldContextObject, const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry)
+{
+	UAsyncAction_SelectItemsFromDropTable* NewAction = NewObject<UAsyncAction_SelectItemsFromDropTable>();
+	NewAction->WorldContextObject = WorldContextObject;
+	NewAction->Context = Context;
+	NewAction->DropTableEntry = DropTableEntry;
+	NewAction->RegisterWithGameInstance(WorldContextObject);
+	return NewAction;
+}
+
+UAsyncAction_SelectItemsFromDropTable* UAsyncAction_SelectItemsFromDropTable::CreateItemsFromDropTableAsync(
+	UObject* WorldContextObject, UObject* Outer, const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry)
+{
+	UAsyncAction_SelectItemsFromDropTable* NewAction = SelectItemsFromDropTableAsync(WorldContextObject, Context, DropTableEntry);
+	NewAction->Outer = Outer;
+	NewAction->bCreateItems = true;
+	return NewAction;
+}
+
+void UAsyncAction_SelectItemsFromDropTable::Activate()
+{
+	UGameItemSubsystem* ItemSubsystem = UGameItemSubsystem::Get(WorldContextObject.Get());
+	if (!ItemSubsystem)
+	{
+		OnItemsSelected(TArray<FGameItemDefStack>());
+		return;
+	}
+
+	ItemSubsystem->SelectItemsFromDropTableAsync(Context, DropTableEntry,
+		FGameItemDropItemsSelectedDelegate::CreateUObject(this, &ThisClass::OnItemsSelected));
+}
+
+void UAsyncAction_SelectItemsFromDropTable::OnItemsSelected(const TArray<FGameItemDefStack>& Stacks)
+{
+	TArray<UGameItem*> Items;
+	if (bCreateItems && Outer.IsValid())
+	{
+		if (UGameItemSubsystem* ItemSubsystem = UGameItemSubsystem::Get(WorldContextObject.Get()))
+		{
+			for (const FGameItemDefStack& Stack : Stacks)
+			{
+				if (UGameItem* NewItem = ItemSubsystem->CreateItem(Outer.Get(), Stack.ItemDef, Stack.Count))
+				{
+					Items.Add(NewItem);
+				}
+			}
+		}
+	}
+
+	OnComplete.Broadcast(Stacks, Items);
+	SetReadyToDestroy();
+}
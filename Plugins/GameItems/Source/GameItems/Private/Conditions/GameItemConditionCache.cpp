@@ -0,0 +1,150 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "Conditions/GameItemConditionCache.h"
+
+#include "GameItemsModule.h"
+#include "WorldConditionSchema.h"
+#include "Engine/World.h"
+#include "UObject/UObjectGlobals.h"
+
+
+FGameItemConditionCache& FGameItemConditionCache::Get()
+{
+	static FGameItemConditionCache Instance;
+	return Instance;
+}
+
+void FGameItemConditionCache::Initialize()
+{
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FGameItemConditionCache::OnPostGarbageCollect);
+	WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddRaw(this, &FGameItemConditionCache::OnWorldCleanup);
+
+#if WITH_EDITOR
+	ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddRaw(this, &FGameItemConditionCache::OnObjectPropertyChanged);
+#endif
+}
+
+void FGameItemConditionCache::Shutdown()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+#endif
+
+	Reset();
+}
+
+bool FGameItemConditionCache::Evaluate(const UObject& Owner, const FWorldConditionQueryDefinition& Condition, const UWorldConditionSchema& Schema,
+                                       TFunctionRef<void(FWorldConditionContextData& ContextData)> SetContextData)
+{
+	// only cache conditions that are members of the owner, whose offset can't be reused by other conditions
+	const UPTRINT OwnerAddress = reinterpret_cast<UPTRINT>(&Owner);
+	const UPTRINT ConditionAddress = reinterpret_cast<UPTRINT>(&Condition);
+	if (!IsInGameThread() || ConditionAddress < OwnerAddress ||
+		ConditionAddress + sizeof(FWorldConditionQueryDefinition) > OwnerAddress + Owner.GetClass()->GetStructureSize())
+	{
+		return EvaluateUncached(Owner, Condition, Schema, SetContextData);
+	}
+
+	const uint32 ConditionOffset = static_cast<uint32>(ConditionAddress - OwnerAddress);
+	TUniquePtr<FEntry>& EntryPtr = Entries.FindOrAdd(FKey(&Owner, ConditionOffset, &Schema));
+	if (!EntryPtr.IsValid())
+	{
+		EntryPtr = MakeUnique<FEntry>();
+		EntryPtr->State.Initialize(Owner, Condition);
+		EntryPtr->ContextData.Emplace(Schema);
+		INC_DWORD_STAT(STAT_GameItems_CachedConditionStates);
+	}
+
+	FEntry& Entry = *EntryPtr;
+	if (Entry.bInUse)
+	{
+		// evaluating recursively
+		return EvaluateUncached(Owner, Condition, Schema, SetContextData);
+	}
+
+	TGuardValue<bool> InUseGuard(Entry.bInUse, true);
+	SetContextData(Entry.ContextData.GetValue());
+
+	const FWorldConditionContext Context(Entry.State, Entry.ContextData.GetValue());
+	if (!Context.Activate())
+	{
+		return false;
+	}
+
+	const bool bIsTrue = Context.IsTrue();
+
+	Context.Deactivate();
+
+	return bIsTrue;
+}
+
+bool FGameItemConditionCache::EvaluateUncached(const UObject& Owner, const FWorldConditionQueryDefinition& Condition, const UWorldConditionSchema& Schema,
+                                               TFunctionRef<void(FWorldConditionContextData& ContextData)> SetContextData)
+{
+	FWorldConditionQueryState QueryState;
+	QueryState.Initialize(Owner, Condition);
+
+	FWorldConditionContextData ContextData(Schema);
+	SetContextData(ContextData);
+
+	const FWorldConditionContext Context(QueryState, ContextData);
+	if (!Context.Activate())
+	{
+		return false;
+	}
+
+	const bool bIsTrue = Context.IsTrue();
+
+	Context.Deactivate();
+
+	return bIsTrue;
+}
+
+void FGameItemConditionCache::Reset()
+{
+	DEC_DWORD_STAT_BY(STAT_GameItems_CachedConditionStates, Entries.Num());
+	Entries.Empty();
+}
+
+void FGameItemConditionCache::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (const auto& Elem : Entries)
+	{
+		Collector.AddPropertyReferencesWithStructARO(FWorldConditionQueryState::StaticStruct(), &Elem.Value->State);
+	}
+}
+
+FString FGameItemConditionCache::GetReferencerName() const
+{
+	return TEXT("FGameItemConditionCache");
+}
+
+void FGameItemConditionCache::OnPostGarbageCollect()
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().Get<0>().ResolveObjectPtr() || !It.Key().Get<2>().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+			DEC_DWORD_STAT(STAT_GameItems_CachedConditionStates);
+		}
+	}
+}
+
+void FGameItemConditionCache::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	// cached context data may still point to actors in the world
+	Reset();
+}
+
+#if WITH_EDITOR
+void FGameItemConditionCache::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// conditions may be edited on subobjects of the owner, e.g. item fragments, so clear everything
+	Reset();
+}
+#endif
@@ -42,10 +42,9 @@ FWorldConditionResult FGameItemCondition_ItemSlotted::IsTrue(const FWorldConditi
 		return Result;
 	}
 
-	const TArray<UGameItemContainer*> Containers = TargetItem->GetContainers();
-	for (const UGameItemContainer* Container : Containers)
+	for (const TWeakObjectPtr<UGameItemContainer>& Container : TargetItem->GetWeakContainers())
 	{
-		if (Container->GetOwnedTags().HasAny(ContainerTags))
+		if (Container.IsValid() && Container->HasAnyOwnedTags(ContainerTags))
 		{
 			Result.Value = EWorldConditionResultValue::IsTrue;
 			break;
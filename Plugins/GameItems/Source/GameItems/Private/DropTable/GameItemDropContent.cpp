@@ -5,6 +5,7 @@
 
 #include "GameItemDef.h"
 #include "GameItemSet.h"
+#include "GameItemsModule.h"
 #include "GameItemStatics.h"
 #include "DropTable/GameItemDropTableRow.h"
 #include "DropTable/GameItemSetEntrySelector.h"
@@ -13,6 +14,14 @@
 // FGameItemDropContent
 // --------------------
 
+bool FGameItemDropContent::ShouldGiveContent(const FGameItemDropContext& Context) const
+{
+	// support content that still overrides the deprecated version
+	PRAGMA_DISABLE_DEPRECATION_WARNINGS
+	return ShouldGiveContent();
+	PRAGMA_ENABLE_DEPRECATION_WARNINGS
+}
+
 bool FGameItemDropContent::ShouldGiveContent() const
 {
 	return true;
@@ -20,7 +29,7 @@ bool FGameItemDropContent::ShouldGiveContent() const
 
 void FGameItemDropContent::CheckAndSelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const
 {
-	if (ShouldGiveContent())
+	if (ShouldGiveContent(Context))
 	{
 		SelectItems(Context, OutItems);
 	}
@@ -34,27 +43,58 @@ void FGameItemDropContent::OnDataChanged()
 {
 }
 
+void FGameItemDropContent::GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const
+{
+}
+
 
 // FGameItemDropChancedContent
 // ---------------------------
 
-bool FGameItemDropChancedContent::ShouldGiveContent() const
+bool FGameItemDropChancedContent::ShouldGiveContent(const FGameItemDropContext& Context) const
 {
-	const float Value = FMath::FRand();
+	const float Value = Context.MakeRandomStream(EGameItemDropRoll::Chance).FRand();
 	return Value <= Chance;
 }
 
+bool FGameItemDropChancedContent::ShouldGiveContent() const
+{
+	return FMath::FRand() <= Chance;
+}
+
 
 // FGameItemDropContent_Combine
 // ----------------------------
 
 void FGameItemDropContent_Combine::SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const
+{
+	for (int32 Idx = 0; Idx < Contents.Num(); ++Idx)
+	{
+		if (const FGameItemDropContent* ContentPtr = Contents[Idx].GetPtr<FGameItemDropContent>())
+		{
+			ContentPtr->CheckAndSelectItems(Context.MakeSubContext(Idx), OutItems);
+		}
+	}
+}
+
+void FGameItemDropContent_Combine::OnDataChanged()
+{
+	for (TInstancedStruct<FGameItemDropContent>& Entry : Contents)
+	{
+		if (FGameItemDropContent* ContentPtr = Entry.GetMutablePtr<FGameItemDropContent>())
+		{
+			ContentPtr->OnDataChanged();
+		}
+	}
+}
+
+void FGameItemDropContent_Combine::GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const
 {
 	for (const TInstancedStruct<FGameItemDropContent>& Entry : Contents)
 	{
 		if (const FGameItemDropContent* ContentPtr = Entry.GetPtr<FGameItemDropContent>())
 		{
-			ContentPtr->CheckAndSelectItems(Context, OutItems);
+			ContentPtr->GatherSoftReferences(OutPaths, VisitedRows);
 		}
 	}
 }
@@ -65,24 +105,55 @@ void FGameItemDropContent_Combine::SelectItems(const FGameItemDropContext& Conte
 
 void FGameItemDropContent_Select::SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameItemDropContent_Select::SelectItems);
+
 	if (WeightedContents.IsEmpty())
 	{
 		return;
 	}
 
-	TArray<float> Probabilities;
-	Algo::Transform(WeightedContents, Probabilities, [](const FWeightedGameItemDropContent& Content)
+	// the table is also rebuilt if contents were added or removed without notifying
+	if (AliasTable.Num() != WeightedContents.Num())
 	{
-		return Content.Probability;
-	});
+		TArray<float> Probabilities;
+		Algo::Transform(WeightedContents, Probabilities, [](const FWeightedGameItemDropContent& Content)
+		{
+			return Content.Probability;
+		});
+		AliasTable.Build(Probabilities);
+	}
 
-	const int32 Idx = UGameItemStatics::GetWeightedRandomArrayIndex(Probabilities);
+	const int32 Idx = AliasTable.Sample(Context.MakeRandomStream(EGameItemDropRoll::Selection));
 	check(Idx != INDEX_NONE);
 
 	const FWeightedGameItemDropContent& WeightedContent = WeightedContents[Idx];
 	if (const FGameItemDropContent* ContentPtr = WeightedContent.Content.GetPtr<FGameItemDropContent>())
 	{
-		ContentPtr->CheckAndSelectItems(Context, OutItems);
+		ContentPtr->CheckAndSelectItems(Context.MakeSubContext(Idx), OutItems);
+	}
+}
+
+void FGameItemDropContent_Select::OnDataChanged()
+{
+	AliasTable.Reset();
+
+	for (FWeightedGameItemDropContent& WeightedContent : WeightedContents)
+	{
+		if (FGameItemDropContent* ContentPtr = WeightedContent.Content.GetMutablePtr<FGameItemDropContent>())
+		{
+			ContentPtr->OnDataChanged();
+		}
+	}
+}
+
+void FGameItemDropContent_Select::GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const
+{
+	for (const FWeightedGameItemDropContent& WeightedContent : WeightedContents)
+	{
+		if (const FGameItemDropContent* ContentPtr = WeightedContent.Content.GetPtr<FGameItemDropContent>())
+		{
+			ContentPtr->GatherSoftReferences(OutPaths, VisitedRows);
+		}
 	}
 }
 
@@ -98,12 +169,22 @@ void FGameItemDropContent_Item::SelectItems(const FGameItemDropContext& Context,
 	}
 }
 
+void FGameItemDropContent_Item::GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const
+{
+	if (!ItemDef.IsNull())
+	{
+		OutPaths.AddUnique(ItemDef.ToSoftObjectPath());
+	}
+}
+
 
 // FGameItemDropContent_ItemSet
 // ----------------------------
 
 void FGameItemDropContent_ItemSet::SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameItemDropContent_ItemSet::SelectItems);
+
 	const UGameItemSet* ItemSetPtr = ItemSet.LoadSynchronous();
 	if (!ItemSetPtr || ItemSetPtr->Items.IsEmpty())
 	{
@@ -126,11 +207,22 @@ void FGameItemDropContent_ItemSet::SelectItems(const FGameItemDropContext& Conte
 	SelectorCDO->SelectItems(SubContext, ItemSetPtr, OutItems);
 }
 
+void FGameItemDropContent_ItemSet::GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const
+{
+	// the set's items are loaded along with it
+	if (!ItemSet.IsNull())
+	{
+		OutPaths.AddUnique(ItemSet.ToSoftObjectPath());
+	}
+}
+
 // FGameItemDropContent_DropTableEntry
 // -----------------------------------
 
 void FGameItemDropContent_DropTableEntry::SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameItemDropContent_DropTableEntry::SelectItems);
+
 	static FString ContextString(TEXT("FGameItemDropContent_DropTableEntry::SelectItems"));
 	if (DropTableRow.IsNull())
 	{
@@ -143,7 +235,7 @@ void FGameItemDropContent_DropTableEntry::SelectItems(const FGameItemDropContext
 		return;
 	}
 
-	FGameItemDropContext SubContext = Context;
+	FGameItemDropContext SubContext = Context.MakeSubContext(0);
 	if (Params.IsValid())
 	{
 		// override parent params
@@ -152,3 +244,18 @@ void FGameItemDropContent_DropTableEntry::SelectItems(const FGameItemDropContext
 
 	UGameItemStatics::SelectItemsFromDropTableRow(SubContext, *Row, OutItems);
 }
+
+void FGameItemDropContent_DropTableEntry::GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const
+{
+	static FString ContextString(TEXT("FGameItemDropContent_DropTableEntry::GatherSoftReferences"));
+	if (DropTableRow.IsNull())
+	{
+		return;
+	}
+
+	// the drop table itself is a hard reference, so rows can be gathered immediately
+	if (const FGameItemDropTableRow* Row = DropTableRow.GetRow<FGameItemDropTableRow>(ContextString))
+	{
+		Row->GatherSoftReferences(OutPaths, VisitedRows);
+	}
+}
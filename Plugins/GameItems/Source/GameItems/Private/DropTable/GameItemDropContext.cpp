@@ -2,3 +2,49 @@
 
 
 #include "DropTable/GameItemDropContext.h"
+
+
+namespace GameItems::DropTable
+{
+	/**
+	 * The splitmix64 finalizer, so that every bit of a combined seed affects every bit of the result.
+	 * Consecutive seeds and child indices would otherwise produce streams with correlated first rolls.
+	 */
+	uint64 MixSeed(uint64 Value)
+	{
+		Value ^= Value >> 30;
+		Value *= 0xbf58476d1ce4e5b9ull;
+		Value ^= Value >> 27;
+		Value *= 0x94d049bb133111ebull;
+		Value ^= Value >> 31;
+		return Value;
+	}
+
+	uint64 CombineSeed(int32 Seed, uint32 Value)
+	{
+		return (static_cast<uint64>(static_cast<uint32>(Seed)) << 32) | Value;
+	}
+}
+
+
+FRandomStream FGameItemDropContext::MakeRandomStream(bool bInUseSeed, int32 InSeed, EGameItemDropRoll Roll)
+{
+	if (!bInUseSeed)
+	{
+		return FRandomStream(FMath::Rand());
+	}
+
+	using namespace GameItems::DropTable;
+	const uint64 Mixed = MixSeed(CombineSeed(InSeed, static_cast<uint32>(Roll) + 1));
+	return FRandomStream(static_cast<int32>(static_cast<uint32>(Mixed)));
+}
+
+int32 FGameItemDropContext::DeriveSeed(int32 InSeed, int32 ChildIndex)
+{
+	using namespace GameItems::DropTable;
+
+	// salted so that child seeds are unrelated to the seeds of the parent's own rolls
+	constexpr uint64 ChildSalt = 0x9e3779b97f4a7c15ull;
+	const uint64 Mixed = MixSeed(CombineSeed(InSeed, static_cast<uint32>(ChildIndex)) ^ ChildSalt);
+	return static_cast<int32>(static_cast<uint32>(Mixed));
+}
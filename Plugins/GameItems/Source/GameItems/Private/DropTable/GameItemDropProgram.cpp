@@ -0,0 +1,375 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "DropTable/GameItemDropProgram.h"
+
+#include "GameItemDef.h"
+#include "GameItemSet.h"
+#include "GameItemsModule.h"
+#include "DropTable/GameItemDropContent.h"
+#include "DropTable/GameItemDropContext.h"
+#include "DropTable/GameItemDropTableRow.h"
+#include "DropTable/GameItemSetEntrySelector.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("CompileDropProgram"), STAT_GameItems_CompileDropProgram, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("ExecuteDropProgram"), STAT_GameItems_ExecuteDropProgram, STATGROUP_GameItems);
+
+
+namespace GameItems::DropTable
+{
+	bool bUseCompiledPrograms = true;
+
+	FAutoConsoleVariableRef CVarUseCompiledPrograms(
+		TEXT("GameItems.DropTable.UseCompiledPrograms"),
+		bUseCompiledPrograms,
+		TEXT("Select items from drop tables by running compiled drop programs, instead of traversing drop content directly."));
+}
+
+
+// FGameItemDropProgram
+// --------------------
+
+std::atomic<uint32> FGameItemDropProgram::GlobalDataVersion = 1;
+
+TSharedRef<FGameItemDropProgram> FGameItemDropProgram::Compile(const FGameItemDropTableRow& Row)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_CompileDropProgram);
+
+	TSharedRef<FGameItemDropProgram> Program = MakeShared<FGameItemDropProgram>();
+	Program->SourceRow = &Row;
+	Program->DataVersion = GlobalDataVersion.load();
+
+	TArray<const FGameItemDropTableRow*> RowStack;
+	RowStack.Add(&Row);
+	Program->CompileContent(Row.Content, RowStack);
+
+	Program->Nodes.Shrink();
+	Program->Children.Shrink();
+	Program->AliasTables.Shrink();
+
+	return Program;
+}
+
+void FGameItemDropProgram::InvalidateAll()
+{
+	GlobalDataVersion.fetch_add(1);
+}
+
+bool FGameItemDropProgram::IsEnabled()
+{
+	return GameItems::DropTable::bUseCompiledPrograms;
+}
+
+bool FGameItemDropProgram::IsValidFor(const FGameItemDropTableRow& Row) const
+{
+	return SourceRow == &Row && DataVersion == GlobalDataVersion.load();
+}
+
+void FGameItemDropProgram::Execute(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_ExecuteDropProgram);
+
+	if (!Nodes.IsEmpty())
+	{
+		ExecuteNode(0, Context, Context.Seed, OutItems);
+	}
+}
+
+bool FGameItemDropProgram::PrepareParallelExecution() const
+{
+	check(IsInGameThread());
+
+	for (const FNode& Node : Nodes)
+	{
+		switch (Node.Type)
+		{
+		case EGameItemDropNodeType::Content:
+			return false;
+
+		case EGameItemDropNodeType::Item:
+			// definitions that aren't loaded would need to be loaded while rolling
+			if (!Node.ItemDef.IsValid() && !static_cast<const FGameItemDropContent_Item*>(Node.Content)->ItemDef.Get())
+			{
+				return false;
+			}
+			break;
+
+		case EGameItemDropNodeType::ItemSet:
+			{
+				const UGameItemSet* ItemSet = Node.ItemSet.Get();
+				if (!ItemSet)
+				{
+					ItemSet = static_cast<const FGameItemDropContent_ItemSet*>(Node.Content)->ItemSet.Get();
+				}
+				const UGameItemSetEntrySelector* Selector = Node.Selector.Get();
+				if (!ItemSet || !Selector)
+				{
+					return false;
+				}
+
+				// blueprint selectors can't run off the game thread
+				if (!Selector->GetClass()->HasAnyClassFlags(CLASS_Native) || !Selector->PrepareParallelSelection(ItemSet))
+				{
+					return false;
+				}
+				break;
+			}
+
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+int32 FGameItemDropProgram::AddNode(EGameItemDropNodeType Type)
+{
+	const int32 NodeIdx = Nodes.AddDefaulted();
+	Nodes[NodeIdx].Type = Type;
+	return NodeIdx;
+}
+
+void FGameItemDropProgram::SetChildren(int32 NodeIdx, TConstArrayView<int32> ChildNodes)
+{
+	FNode& Node = Nodes[NodeIdx];
+	Node.FirstChild = Children.Num();
+	Node.NumChildren = ChildNodes.Num();
+	Children.Append(ChildNodes.GetData(), ChildNodes.Num());
+}
+
+int32 FGameItemDropProgram::CompileContent(const TInstancedStruct<FGameItemDropContent>& Content, TArray<const FGameItemDropTableRow*>& RowStack)
+{
+	const UScriptStruct* ContentType = Content.GetScriptStruct();
+	const FGameItemDropContent* ContentPtr = Content.GetPtr<FGameItemDropContent>();
+	if (!ContentPtr || ContentType == FGameItemDropContent::StaticStruct())
+	{
+		// the base content never gives anything
+		return AddNode(EGameItemDropNodeType::None);
+	}
+
+	int32 NodeIdx = INDEX_NONE;
+
+	// only compile known types exactly, since subclasses may override selection
+	if (ContentType == FGameItemDropContent_Combine::StaticStruct())
+	{
+		const FGameItemDropContent_Combine& Combine = Content.Get<FGameItemDropContent_Combine>();
+		NodeIdx = AddNode(EGameItemDropNodeType::Combine);
+
+		TArray<int32> ChildNodes;
+		ChildNodes.Reserve(Combine.Contents.Num());
+		for (const TInstancedStruct<FGameItemDropContent>& Entry : Combine.Contents)
+		{
+			// invalid entries compile to None nodes, keeping child indices the same for deriving seeds
+			ChildNodes.Add(CompileContent(Entry, RowStack));
+		}
+		SetChildren(NodeIdx, ChildNodes);
+	}
+	else if (ContentType == FGameItemDropContent_Select::StaticStruct())
+	{
+		const FGameItemDropContent_Select& Select = Content.Get<FGameItemDropContent_Select>();
+		NodeIdx = AddNode(EGameItemDropNodeType::Select);
+
+		TArray<float> Probabilities;
+		TArray<int32> ChildNodes;
+		Probabilities.Reserve(Select.WeightedContents.Num());
+		ChildNodes.Reserve(Select.WeightedContents.Num());
+		for (const FWeightedGameItemDropContent& WeightedContent : Select.WeightedContents)
+		{
+			Probabilities.Add(WeightedContent.Probability);
+			ChildNodes.Add(CompileContent(WeightedContent.Content, RowStack));
+		}
+		SetChildren(NodeIdx, ChildNodes);
+
+		if (!Probabilities.IsEmpty())
+		{
+			const int32 AliasTableIdx = AliasTables.AddDefaulted();
+			AliasTables[AliasTableIdx].Build(Probabilities);
+			Nodes[NodeIdx].AliasTable = AliasTableIdx;
+		}
+	}
+	else if (ContentType == FGameItemDropContent_Item::StaticStruct())
+	{
+		const FGameItemDropContent_Item& Item = Content.Get<FGameItemDropContent_Item>();
+		NodeIdx = AddNode(EGameItemDropNodeType::Item);
+		// don't load anything while compiling, unloaded definitions are loaded when rolled instead
+		Nodes[NodeIdx].ItemDef = Item.ItemDef.Get();
+		Nodes[NodeIdx].Count = Item.Count;
+	}
+	else if (ContentType == FGameItemDropContent_ItemSet::StaticStruct())
+	{
+		const FGameItemDropContent_ItemSet& ItemSet = Content.Get<FGameItemDropContent_ItemSet>();
+		if (!ItemSet.SelectorClass)
+		{
+			// still roll the chance, but give nothing
+			NodeIdx = AddNode(EGameItemDropNodeType::None);
+		}
+		else
+		{
+			NodeIdx = AddNode(EGameItemDropNodeType::ItemSet);
+			Nodes[NodeIdx].ItemSet = ItemSet.ItemSet.Get();
+			Nodes[NodeIdx].Selector = GetDefault<UGameItemSetEntrySelector>(ItemSet.SelectorClass);
+			Nodes[NodeIdx].Params = ItemSet.Params.IsValid() ? &ItemSet.Params : nullptr;
+		}
+	}
+	else if (ContentType == FGameItemDropContent_DropTableEntry::StaticStruct())
+	{
+		const FGameItemDropContent_DropTableEntry& Entry = Content.Get<FGameItemDropContent_DropTableEntry>();
+
+		static FString ContextString(TEXT("FGameItemDropProgram::CompileContent"));
+		const FGameItemDropTableRow* Row = !Entry.DropTableRow.IsNull() ? Entry.DropTableRow.GetRow<FGameItemDropTableRow>(ContextString) : nullptr;
+		if (!Row)
+		{
+			NodeIdx = AddNode(EGameItemDropNodeType::None);
+		}
+		else if (RowStack.Contains(Row))
+		{
+			UE_LOG(LogGameItems, Error, TEXT("[%hs] Drop table row %s includes itself, it will give nothing."),
+			       __func__, *Entry.DropTableRow.ToDebugString());
+			NodeIdx = AddNode(EGameItemDropNodeType::None);
+		}
+		else
+		{
+			// inline the row's content
+			NodeIdx = AddNode(EGameItemDropNodeType::Params);
+			Nodes[NodeIdx].Params = Entry.Params.IsValid() ? &Entry.Params : nullptr;
+
+			RowStack.Push(Row);
+			const int32 ChildNode = CompileContent(Row->Content, RowStack);
+			RowStack.Pop();
+
+			SetChildren(NodeIdx, {ChildNode});
+		}
+	}
+	else
+	{
+		NodeIdx = AddNode(EGameItemDropNodeType::Content);
+	}
+
+	FNode& Node = Nodes[NodeIdx];
+	Node.Content = ContentPtr;
+	if (Node.Type != EGameItemDropNodeType::Content && ContentType->IsChildOf(FGameItemDropChancedContent::StaticStruct()))
+	{
+		Node.bRollChance = true;
+		Node.Chance = Content.Get<FGameItemDropChancedContent>().Chance;
+	}
+
+	return NodeIdx;
+}
+
+void FGameItemDropProgram::ExecuteNode(int32 NodeIdx, const FGameItemDropContext& Context, int32 Seed, TArray<FGameItemDefStack>& OutItems) const
+{
+	const FNode& Node = Nodes[NodeIdx];
+
+	if (Node.bRollChance)
+	{
+		const FRandomStream RandomStream = FGameItemDropContext::MakeRandomStream(Context.bUseSeed, Seed, EGameItemDropRoll::Chance);
+		if (RandomStream.FRand() > Node.Chance)
+		{
+			return;
+		}
+	}
+
+	switch (Node.Type)
+	{
+	case EGameItemDropNodeType::Combine:
+		for (int32 Idx = 0; Idx < Node.NumChildren; ++Idx)
+		{
+			ExecuteNode(Children[Node.FirstChild + Idx], Context, FGameItemDropContext::DeriveSeed(Seed, Idx), OutItems);
+		}
+		break;
+
+	case EGameItemDropNodeType::Select:
+		if (Node.AliasTable != INDEX_NONE)
+		{
+			const FRandomStream RandomStream = FGameItemDropContext::MakeRandomStream(Context.bUseSeed, Seed, EGameItemDropRoll::Selection);
+			const int32 Idx = AliasTables[Node.AliasTable].Sample(RandomStream);
+			check(Idx != INDEX_NONE && Idx < Node.NumChildren);
+			ExecuteNode(Children[Node.FirstChild + Idx], Context, FGameItemDropContext::DeriveSeed(Seed, Idx), OutItems);
+		}
+		break;
+
+	case EGameItemDropNodeType::Item:
+		{
+			UClass* ItemDefClass = Node.ItemDef.Get();
+			if (!ItemDefClass)
+			{
+				// the definition may not have been loaded when compiling, or unloaded since
+				ItemDefClass = static_cast<const FGameItemDropContent_Item*>(Node.Content)->ItemDef.LoadSynchronous();
+			}
+			if (ItemDefClass)
+			{
+				OutItems.Emplace(ItemDefClass, Node.Count);
+			}
+			break;
+		}
+
+	case EGameItemDropNodeType::Params:
+		if (Node.Params)
+		{
+			// override parent params
+			FGameItemDropContext SubContext = Context;
+			SubContext.Params = *Node.Params;
+			ExecuteNode(Children[Node.FirstChild], SubContext, FGameItemDropContext::DeriveSeed(Seed, 0), OutItems);
+		}
+		else
+		{
+			ExecuteNode(Children[Node.FirstChild], Context, FGameItemDropContext::DeriveSeed(Seed, 0), OutItems);
+		}
+		break;
+
+	case EGameItemDropNodeType::ItemSet:
+	case EGameItemDropNodeType::Content:
+		if (Node.Params || (Context.bUseSeed && Context.Seed != Seed))
+		{
+			FGameItemDropContext SubContext = Context;
+			SubContext.Seed = Seed;
+			if (Node.Params)
+			{
+				// override parent params
+				SubContext.Params = *Node.Params;
+			}
+			ExecuteNodeWithContext(Node, SubContext, OutItems);
+		}
+		else
+		{
+			ExecuteNodeWithContext(Node, Context, OutItems);
+		}
+		break;
+
+	case EGameItemDropNodeType::None:
+	default:
+		break;
+	}
+}
+
+void FGameItemDropProgram::ExecuteNodeWithContext(const FNode& Node, const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const
+{
+	if (Node.Type == EGameItemDropNodeType::Content)
+	{
+		// custom content rolls its own chance
+		Node.Content->CheckAndSelectItems(Context, OutItems);
+		return;
+	}
+
+	const UGameItemSet* ItemSet = Node.ItemSet.Get();
+	if (!ItemSet)
+	{
+		ItemSet = static_cast<const FGameItemDropContent_ItemSet*>(Node.Content)->ItemSet.LoadSynchronous();
+	}
+	const UGameItemSetEntrySelector* Selector = Node.Selector.Get();
+	if (ItemSet && !ItemSet->Items.IsEmpty() && Selector)
+	{
+		if (IsInGameThread())
+		{
+			Selector->SelectItems(Context, ItemSet, OutItems);
+		}
+		else
+		{
+			// SelectItems goes through ProcessEvent, which can't be used off the game thread.
+			// PrepareParallelExecution only allows native selectors, so this is the same function.
+			Selector->SelectItems_Implementation(Context, ItemSet, OutItems);
+		}
+	}
+}
@@ -0,0 +1,275 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "DropTable/GameItemDropSimulation.h"
+
+#include "GameItemDef.h"
+#include "GameItemsModule.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "DropTable/GameItemDropTableRow.h"
+#include "Fragments/GameItemFragment_EconValue.h"
+
+
+namespace GameItems::DropSimulation
+{
+	struct FItemCounter
+	{
+		int64 NumRollsDropped = 0;
+		int64 TotalCount = 0;
+		TMap<int32, int64> CountHistogram;
+	};
+
+	/** The results gathered by a single task, which are merged once all tasks are done. */
+	struct FTaskResult
+	{
+		TMap<UClass*, FItemCounter> Items;
+		TMap<int32, int64> NumStacksHistogram;
+
+		void Merge(const FTaskResult& Other)
+		{
+			for (const auto& Elem : Other.Items)
+			{
+				FItemCounter& Counter = Items.FindOrAdd(Elem.Key);
+				Counter.NumRollsDropped += Elem.Value.NumRollsDropped;
+				Counter.TotalCount += Elem.Value.TotalCount;
+				for (const auto& CountElem : Elem.Value.CountHistogram)
+				{
+					Counter.CountHistogram.FindOrAdd(CountElem.Key) += CountElem.Value;
+				}
+			}
+			for (const auto& Elem : Other.NumStacksHistogram)
+			{
+				NumStacksHistogram.FindOrAdd(Elem.Key) += Elem.Value;
+			}
+		}
+	};
+
+	void RunRolls(const FGameItemDropProgram& Program, const FGameItemDropContext& Context, int32 BaseSeed,
+	              int32 StartRoll, int32 EndRoll, FTaskResult& OutResult)
+	{
+		FGameItemDropContext RollContext = Context;
+		RollContext.bUseSeed = true;
+
+		TArray<FGameItemDefStack> Items;
+		TArray<TPair<UClass*, int32>, TInlineAllocator<16>> CountsByDef;
+
+		for (int32 RollIdx = StartRoll; RollIdx < EndRoll; ++RollIdx)
+		{
+			RollContext.Seed = FGameItemDropContext::DeriveSeed(BaseSeed, RollIdx);
+
+			Items.Reset();
+			Program.Execute(RollContext, Items);
+
+			OutResult.NumStacksHistogram.FindOrAdd(Items.Num()) += 1;
+
+			// combine stacks of the same item, there are usually only a few per roll
+			CountsByDef.Reset();
+			for (const FGameItemDefStack& Item : Items)
+			{
+				TPair<UClass*, int32>* Existing = CountsByDef.FindByPredicate([&Item](const TPair<UClass*, int32>& Pair)
+				{
+					return Pair.Key == Item.ItemDef.Get();
+				});
+				if (Existing)
+				{
+					Existing->Value += Item.Count;
+				}
+				else
+				{
+					CountsByDef.Emplace(Item.ItemDef.Get(), Item.Count);
+				}
+			}
+
+			for (const TPair<UClass*, int32>& Pair : CountsByDef)
+			{
+				FItemCounter& Counter = OutResult.Items.FindOrAdd(Pair.Key);
+				++Counter.NumRollsDropped;
+				Counter.TotalCount += Pair.Value;
+				Counter.CountHistogram.FindOrAdd(Pair.Value) += 1;
+			}
+		}
+	}
+
+	FString HistogramToString(const TMap<int32, int64>& Histogram, int64 Total, int32 MaxEntries)
+	{
+		TArray<int32> Keys;
+		Histogram.GetKeys(Keys);
+		Keys.Sort();
+
+		FString Result;
+		for (int32 Idx = 0; Idx < Keys.Num() && Idx < MaxEntries; ++Idx)
+		{
+			Result += FString::Printf(TEXT("%s%d:%.1f%%"), Idx > 0 ? TEXT(" ") : TEXT(""),
+			                          Keys[Idx], Total > 0 ? Histogram[Keys[Idx]] * 100.0 / Total : 0.0);
+		}
+		if (Keys.Num() > MaxEntries)
+		{
+			Result += TEXT(" ...");
+		}
+		return Result;
+	}
+
+	FString HistogramToJson(const TMap<int32, int64>& Histogram)
+	{
+		TArray<int32> Keys;
+		Histogram.GetKeys(Keys);
+		Keys.Sort();
+
+		FString Result = TEXT("{");
+		for (int32 Idx = 0; Idx < Keys.Num(); ++Idx)
+		{
+			Result += FString::Printf(TEXT("%s\"%d\": %lld"), Idx > 0 ? TEXT(", ") : TEXT(""), Keys[Idx], Histogram[Keys[Idx]]);
+		}
+		Result += TEXT("}");
+		return Result;
+	}
+}
+
+
+// FGameItemDropSimulationResult
+// -----------------------------
+
+void FGameItemDropSimulationResult::Dump(FOutputDevice& Ar) const
+{
+	using namespace GameItems::DropSimulation;
+
+	Ar.Logf(TEXT("Drop simulation %s: %d rolls in %.3fs (%.0f rolls/s, %d tasks), expected econ value %.2f"),
+	        *Name, NumRolls, Seconds, GetRollsPerSecond(), NumTasks, GetExpectedEconValue());
+	Ar.Logf(TEXT("  Stacks per roll: %s"), *HistogramToString(NumStacksHistogram, NumRolls, 10));
+	Ar.Logf(TEXT("  %-40s %8s %10s %12s %12s  %s"), TEXT("Item"), TEXT("Rate"), TEXT("MeanCount"), TEXT("CountPerRoll"),
+	        TEXT("EconPerRoll"), TEXT("Counts"));
+
+	for (const FGameItemDropSimulationItemStats& Item : Items)
+	{
+		Ar.Logf(TEXT("  %-40s %7.3f%% %10.2f %12.3f %12.3f  %s"),
+		        *GetNameSafe(Item.ItemDef),
+		        NumRolls > 0 ? Item.NumRollsDropped * 100.0 / NumRolls : 0.0,
+		        Item.NumRollsDropped > 0 ? static_cast<double>(Item.TotalCount) / Item.NumRollsDropped : 0.0,
+		        NumRolls > 0 ? static_cast<double>(Item.TotalCount) / NumRolls : 0.0,
+		        NumRolls > 0 ? Item.TotalCount * Item.EconValue / NumRolls : 0.0,
+		        *HistogramToString(Item.CountHistogram, Item.NumRollsDropped, 8));
+	}
+}
+
+FString FGameItemDropSimulationResult::ToJson() const
+{
+	using namespace GameItems::DropSimulation;
+
+	FString Json = FString::Printf(
+		TEXT("{\n\t\"name\": \"%s\", \"rolls\": %d, \"tasks\": %d, \"seconds\": %.6f, \"rollsPerSecond\": %.1f, ")
+		TEXT("\"expectedEconValue\": %.4f,\n\t\"stacksPerRoll\": %s,\n\t\"items\": [\n"),
+		*Name, NumRolls, NumTasks, Seconds, GetRollsPerSecond(), GetExpectedEconValue(), *HistogramToJson(NumStacksHistogram));
+
+	for (int32 Idx = 0; Idx < Items.Num(); ++Idx)
+	{
+		const FGameItemDropSimulationItemStats& Item = Items[Idx];
+		Json += FString::Printf(
+			TEXT("\t\t{\"itemDef\": \"%s\", \"rollsDropped\": %lld, \"totalCount\": %lld, \"econValue\": %.4f, \"counts\": %s}%s\n"),
+			*GetPathNameSafe(Item.ItemDef), Item.NumRollsDropped, Item.TotalCount, Item.EconValue, *HistogramToJson(Item.CountHistogram),
+			Idx < Items.Num() - 1 ? TEXT(",") : TEXT(""));
+	}
+
+	Json += TEXT("\t]\n}\n");
+	return Json;
+}
+
+FString FGameItemDropSimulationResult::ToCsv() const
+{
+	FString Csv = TEXT("ItemDef,Rolls,RollsDropped,DropRate,TotalCount,MeanCount,CountPerRoll,EconValue,EconPerRoll\n");
+	for (const FGameItemDropSimulationItemStats& Item : Items)
+	{
+		Csv += FString::Printf(TEXT("%s,%d,%lld,%.6f,%lld,%.4f,%.6f,%.4f,%.6f\n"),
+		                       *GetPathNameSafe(Item.ItemDef), NumRolls, Item.NumRollsDropped,
+		                       NumRolls > 0 ? static_cast<double>(Item.NumRollsDropped) / NumRolls : 0.0,
+		                       Item.TotalCount,
+		                       Item.NumRollsDropped > 0 ? static_cast<double>(Item.TotalCount) / Item.NumRollsDropped : 0.0,
+		                       NumRolls > 0 ? static_cast<double>(Item.TotalCount) / NumRolls : 0.0,
+		                       Item.EconValue,
+		                       NumRolls > 0 ? Item.TotalCount * Item.EconValue / NumRolls : 0.0);
+	}
+	return Csv;
+}
+
+
+// FGameItemDropSimulation
+// -----------------------
+
+FGameItemDropSimulationResult FGameItemDropSimulation::Run(const FGameItemDropTableRow& Row, const FGameItemDropContext& Context, const FParams& Params)
+{
+	using namespace GameItems::DropSimulation;
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameItemDropSimulation::Run);
+	check(IsInGameThread());
+
+	FGameItemDropSimulationResult Result;
+	Result.NumRolls = FMath::Max(Params.NumRolls, 0);
+
+	// load and compile everything before timing, since compiling doesn't load anything
+	TArray<FSoftObjectPath> SoftPaths;
+	Row.GatherSoftReferences(SoftPaths);
+	for (const FSoftObjectPath& SoftPath : SoftPaths)
+	{
+		SoftPath.TryLoad();
+	}
+
+	const TSharedRef<const FGameItemDropProgram> ProgramRef = Row.GetProgram();
+	const FGameItemDropProgram& Program = *ProgramRef;
+	const bool bParallel = Program.PrepareParallelExecution();
+	if (!bParallel)
+	{
+		UE_LOG(LogGameItems, Log, TEXT("[%hs] Drop table row can't run on worker threads, rolling on the game thread."), __func__);
+	}
+
+	const int32 MaxTasks = Params.MaxTasks > 0 ? Params.MaxTasks : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	Result.NumTasks = bParallel ? FMath::Clamp(Result.NumRolls / 1000, 1, MaxTasks) : 1;
+
+	TArray<FTaskResult> TaskResults;
+	TaskResults.SetNum(Result.NumTasks);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 RollsPerTask = FMath::DivideAndRoundUp(FMath::Max(Result.NumRolls, 1), Result.NumTasks);
+	ParallelFor(Result.NumTasks, [&](int32 TaskIdx)
+	{
+		const int32 StartRoll = TaskIdx * RollsPerTask;
+		const int32 EndRoll = FMath::Min(StartRoll + RollsPerTask, Result.NumRolls);
+		RunRolls(Program, Context, Params.Seed, StartRoll, EndRoll, TaskResults[TaskIdx]);
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+
+	FTaskResult Merged;
+	for (const FTaskResult& TaskResult : TaskResults)
+	{
+		Merged.Merge(TaskResult);
+	}
+
+	Result.NumStacksHistogram = MoveTemp(Merged.NumStacksHistogram);
+	Result.Items.Reserve(Merged.Items.Num());
+	for (auto& Elem : Merged.Items)
+	{
+		FGameItemDropSimulationItemStats& Item = Result.Items.AddDefaulted_GetRef();
+		Item.ItemDef = Elem.Key;
+		Item.NumRollsDropped = Elem.Value.NumRollsDropped;
+		Item.TotalCount = Elem.Value.TotalCount;
+		Item.CountHistogram = MoveTemp(Elem.Value.CountHistogram);
+
+		if (Item.ItemDef)
+		{
+			const UGameItemDef* ItemDefCDO = GetDefault<UGameItemDef>(Item.ItemDef);
+			if (const UGameItemFragment_EconValue* EconValueFrag = ItemDefCDO->FindFragment<UGameItemFragment_EconValue>())
+			{
+				Item.EconValue = EconValueFrag->EconValue;
+			}
+		}
+		Result.TotalEconValue += Item.TotalCount * static_cast<double>(Item.EconValue);
+	}
+
+	Result.Items.Sort([](const FGameItemDropSimulationItemStats& A, const FGameItemDropSimulationItemStats& B)
+	{
+		return A.NumRollsDropped > B.NumRollsDropped;
+	});
+
+	return Result;
+}
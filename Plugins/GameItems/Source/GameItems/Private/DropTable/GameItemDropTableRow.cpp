@@ -4,10 +4,66 @@
 #include "DropTable/GameItemDropTableRow.h"
 
 #include "DropTable/GameItemDropContent.h"
+#include "Misc/ScopeRWLock.h"
 
 
+namespace GameItems::DropTable
+{
+	/** Guards the compiled programs of all drop table rows. */
+	FRWLock ProgramLock;
+}
+
+
+void FGameItemDropTableRow::GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths) const
+{
+	TSet<const FGameItemDropTableRow*> VisitedRows;
+	GatherSoftReferences(OutPaths, VisitedRows);
+}
+
+void FGameItemDropTableRow::GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const
+{
+	bool bAlreadyVisited = false;
+	VisitedRows.Add(this, &bAlreadyVisited);
+	if (bAlreadyVisited)
+	{
+		return;
+	}
+
+	if (const FGameItemDropContent* ContentPtr = Content.GetPtr<FGameItemDropContent>())
+	{
+		ContentPtr->GatherSoftReferences(OutPaths, VisitedRows);
+	}
+}
+
+TSharedRef<const FGameItemDropProgram> FGameItemDropTableRow::GetProgram() const
+{
+	// also recompile rows that were copied, since the program points into the row it was compiled from
+	{
+		FReadScopeLock ReadLock(GameItems::DropTable::ProgramLock);
+		if (Program.IsValid() && Program->IsValidFor(*this))
+		{
+			return Program.ToSharedRef();
+		}
+	}
+
+	FWriteScopeLock WriteLock(GameItems::DropTable::ProgramLock);
+	if (!Program.IsValid() || !Program->IsValidFor(*this))
+	{
+		// another thread may have compiled it while waiting for the lock
+		Program = FGameItemDropProgram::Compile(*this);
+	}
+	return Program.ToSharedRef();
+}
+
 void FGameItemDropTableRow::OnDataTableChanged(const UDataTable* InDataTable, const FName InRowName)
 {
+	// other rows may include this one, so invalidate all compiled programs
+	{
+		FWriteScopeLock WriteLock(GameItems::DropTable::ProgramLock);
+		Program.Reset();
+	}
+	FGameItemDropProgram::InvalidateAll();
+
 	// notify content when data has changed
 	if (FGameItemDropContent* ContentPtr = Content.GetMutablePtr<FGameItemDropContent>())
 	{
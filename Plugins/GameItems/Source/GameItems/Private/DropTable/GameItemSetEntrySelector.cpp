@@ -62,6 +62,8 @@ float UGameItemSetEntrySelector::GetItemProbability_Implementation(const FGameIt
 void UGameItemSetEntrySelector::GetFilteredAndWeightedItems(const FGameItemDropContext& Context, const UGameItemSet* ItemSet,
                                                             TArray<FGameItemDefStack>& OutFilteredItems, TArray<float>& OutProbabilities) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSetEntrySelector::GetFilteredAndWeightedItems);
+
 	OutFilteredItems.Reset();
 	OutFilteredItems = ItemSet->Items.FilterByPredicate([&](const FGameItemDefStack& Entry)
 	{
@@ -75,6 +77,82 @@ void UGameItemSetEntrySelector::GetFilteredAndWeightedItems(const FGameItemDropC
 	});
 }
 
+bool UGameItemSetEntrySelector::PrepareParallelSelection(const UGameItemSet* ItemSet) const
+{
+	return false;
+}
+
+bool UGameItemSetEntrySelector::IsSelectionContextFree() const
+{
+	return false;
+}
+
+bool UGameItemSetEntrySelector::CanCacheSelection(const UGameItemSet* ItemSet) const
+{
+	if (!IsSelectionContextFree())
+	{
+		return false;
+	}
+
+	// blueprint subclasses of a context-free selector may still override the events
+	static const FName CanSelectItemName = GET_FUNCTION_NAME_CHECKED(UGameItemSetEntrySelector, CanSelectItem);
+	static const FName GetItemProbabilityName = GET_FUNCTION_NAME_CHECKED(UGameItemSetEntrySelector, GetItemProbability);
+	if (GetClass()->FindFunctionByName(CanSelectItemName)->GetOuter() != UGameItemSetEntrySelector::StaticClass() ||
+		GetClass()->FindFunctionByName(GetItemProbabilityName)->GetOuter() != UGameItemSetEntrySelector::StaticClass())
+	{
+		return false;
+	}
+
+	for (const FGameItemDefStack& Entry : ItemSet->Items)
+	{
+		if (!Entry.ItemDef)
+		{
+			return false;
+		}
+
+		if (bUseDropRules)
+		{
+			// drop rules with conditions or custom probabilities depend on the context
+			const UGameItemDef* ItemDefCDO = GetDefault<UGameItemDef>(Entry.ItemDef);
+			const UGameItemFragment_DropRules* DropRulesFrag = ItemDefCDO->FindFragment<UGameItemFragment_DropRules>();
+			if (DropRulesFrag && (DropRulesFrag->GetClass() != UGameItemFragment_DropRules::StaticClass() || DropRulesFrag->Condition.IsValid()))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+const FGameItemSetSelectionCache& UGameItemSetEntrySelector::GetSelectionCache(const UGameItemSet* ItemSet) const
+{
+	FGameItemSetSelectionCache& Cache = ItemSet->GetSelectionCache(this);
+
+	// also rebuild if items were added or removed without invalidating the cache
+	const uint32 DataVersion = UGameItemSet::GetSelectionDataVersion();
+	if (Cache.DataVersion != DataVersion || (Cache.bUseAliasTable && Cache.AliasTable.Num() != ItemSet->Items.Num()))
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSetEntrySelector::BuildSelectionCache);
+
+		Cache.DataVersion = DataVersion;
+		Cache.bUseAliasTable = CanCacheSelection(ItemSet);
+		Cache.AliasTable.Reset();
+
+		if (Cache.bUseAliasTable)
+		{
+			TArray<float> Probabilities;
+			Algo::Transform(ItemSet->Items, Probabilities, [&](const FGameItemDefStack& Entry)
+			{
+				return GetItemProbability(FGameItemDropContext(), ItemSet, Entry);
+			});
+			Cache.AliasTable.Build(Probabilities);
+		}
+	}
+
+	return Cache;
+}
+
 
 // UGameItemSetEntrySelector_All
 // -----------------------------
@@ -86,6 +164,11 @@ void UGameItemSetEntrySelector_All::SelectItems_Implementation(const FGameItemDr
 	OutItems.Append(ItemSet->Items);
 }
 
+bool UGameItemSetEntrySelector_All::PrepareParallelSelection(const UGameItemSet* ItemSet) const
+{
+	return true;
+}
+
 
 // UGameItemSetEntrySelector_Random
 // --------------------------------
@@ -94,19 +177,39 @@ void UGameItemSetEntrySelector_Random::SelectItems_Implementation(const FGameIte
                                                                   TArray<FGameItemDefStack>& OutItems) const
 {
 	check(ItemSet);
-	TArray<FGameItemDefStack> FilteredItems;
-	TArray<float> Probabilities;
-	GetFilteredAndWeightedItems(Context, ItemSet, FilteredItems, Probabilities);
-
-	if (FilteredItems.IsEmpty())
+	if (ItemSet->Items.IsEmpty())
 	{
 		return;
 	}
 
-	const int32 RandIdx = UGameItemStatics::GetWeightedRandomArrayIndex(Probabilities);
-	check(RandIdx != INDEX_NONE);
+	FGameItemDefStack Item;
+	int32 RandIdx;
+
+	const FGameItemSetSelectionCache& SelectionCache = GetSelectionCache(ItemSet);
+	if (SelectionCache.bUseAliasTable)
+	{
+		RandIdx = SelectionCache.AliasTable.Sample(Context.MakeRandomStream(EGameItemDropRoll::Selection));
+		check(RandIdx != INDEX_NONE);
+
+		Item = ItemSet->Items[RandIdx];
+	}
+	else
+	{
+		TArray<FGameItemDefStack> FilteredItems;
+		TArray<float> Probabilities;
+		GetFilteredAndWeightedItems(Context, ItemSet, FilteredItems, Probabilities);
+
+		if (FilteredItems.IsEmpty())
+		{
+			return;
+		}
+
+		RandIdx = UGameItemStatics::GetWeightedRandomArrayIndexFromStream(Probabilities, Context.MakeRandomStream(EGameItemDropRoll::Selection));
+		check(RandIdx != INDEX_NONE);
+
+		Item = FilteredItems[RandIdx];
+	}
 
-	FGameItemDefStack Item = FilteredItems[RandIdx];
 	if (!Item.ItemDef)
 	{
 		UE_LOG(LogGameItems, Error, TEXT("Selected entry with null ItemDef from item set: %s[%d]"), *ItemSet->GetName(), RandIdx);
@@ -120,7 +223,8 @@ void UGameItemSetEntrySelector_Random::SelectItems_Implementation(const FGameIte
 		{
 			if (const FGameItemDropParams_EconValue* EconParams = Context.Params.GetPtr<FGameItemDropParams_EconValue>())
 			{
-				const float Value = FMath::Max(FMath::FRandRange(EconParams->EconValueMin, EconParams->EconValueMax), 0.f);
+				const FRandomStream RandomStream = Context.MakeRandomStream(EGameItemDropRoll::Quantity);
+				const float Value = FMath::Max(RandomStream.FRandRange(EconParams->EconValueMin, EconParams->EconValueMax), 0.f);
 				Item.Count = EconValueFrag->GetCountForValue(Value);
 			}
 		}
@@ -128,3 +232,14 @@ void UGameItemSetEntrySelector_Random::SelectItems_Implementation(const FGameIte
 
 	OutItems.Add(Item);
 }
+
+bool UGameItemSetEntrySelector_Random::PrepareParallelSelection(const UGameItemSet* ItemSet) const
+{
+	// only the cached alias table can be used off the game thread, since conditions may need the world
+	return GetSelectionCache(ItemSet).bUseAliasTable;
+}
+
+bool UGameItemSetEntrySelector_Random::IsSelectionContextFree() const
+{
+	return true;
+}
@@ -6,6 +6,7 @@
 #include "GameItemsModule.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/World.h"
+#include "Equipment/GameEquipmentActorPool.h"
 #include "Equipment/GameEquipmentComponent.h"
 #include "Equipment/GameEquipmentDef.h"
 #include "GameFramework/Actor.h"
@@ -141,6 +142,8 @@ void UGameEquipment::SpawnEquipmentActors()
 	USceneComponent* AttachTarget = GetTargetAttachComponent();
 	check(AttachTarget);
 
+	UGameEquipmentActorPool* ActorPool = UGameEquipmentActorPool::Get(this);
+
 	for (const FGameEquipmentActorSpawnInfo& SpawnInfo : EquipmentCDO->ActorsToSpawn)
 	{
 		if (!SpawnInfo.ActorClass)
@@ -174,10 +177,24 @@ void UGameEquipment::SpawnEquipmentActors()
 			*SpawnInfo.ActorClass->GetName(),
 			*UEnum::GetDisplayValueAsText(SpawnInfo.NetSpawnPolicy).ToString());
 
-		FActorSpawnParameters SpawnParams;
-		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-		SpawnParams.Owner = OwningActor;
-		AActor* NewActor = GetWorld()->SpawnActor<AActor>(SpawnInfo.ActorClass, SpawnInfo.AttachTransform, SpawnParams);
+		AActor* NewActor = nullptr;
+		if (SpawnInfo.bUsePool && ActorPool)
+		{
+			NewActor = ActorPool->AcquireActor(SpawnInfo.ActorClass, SpawnInfo.AttachTransform, OwningActor);
+		}
+		else
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			SpawnParams.Owner = OwningActor;
+			NewActor = GetWorld()->SpawnActor<AActor>(SpawnInfo.ActorClass, SpawnInfo.AttachTransform, SpawnParams);
+		}
+
+		if (!NewActor)
+		{
+			continue;
+		}
+
 		AttachEquipmentActor(NewActor, AttachTarget, SpawnInfo);
 
 		if (bIsReplicatedSpawn)
@@ -215,6 +232,20 @@ void UGameEquipment::AttachEquipmentActor(AActor* NewActor, USceneComponent* Att
 
 void UGameEquipment::DestroyEquipmentActors()
 {
+	// actors spawned by the pool are returned to it, any others are destroyed
+	UGameEquipmentActorPool* ActorPool = UGameEquipmentActorPool::Get(this);
+	auto ReleaseActor = [ActorPool](AActor* Actor)
+	{
+		if (ActorPool)
+		{
+			ActorPool->ReleaseActor(Actor);
+		}
+		else
+		{
+			Actor->Destroy();
+		}
+	};
+
 	const AActor* OwningActor = GetOwningActor();
 	if (OwningActor->HasAuthority())
 	{
@@ -222,7 +253,7 @@ void UGameEquipment::DestroyEquipmentActors()
 		{
 			if (Actor)
 			{
-				Actor->Destroy();
+				ReleaseActor(Actor);
 			}
 		}
 		SpawnedActors.Empty();
@@ -233,7 +264,7 @@ void UGameEquipment::DestroyEquipmentActors()
 	{
 		if (Actor)
 		{
-			Actor->Destroy();
+			ReleaseActor(Actor);
 		}
 	}
 	LocalSpawnedActors.Empty();
@@ -0,0 +1,252 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "Equipment/GameEquipmentActorPool.h"
+
+#include "GameItemSettings.h"
+#include "GameItemsModule.h"
+#include "Engine/Engine.h"
+#include "Components/ActorComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameEquipmentActorPool)
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Equipment Actors Reused"), STAT_GameItems_PooledEquipmentActorsReused, STATGROUP_GameItems);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Equipment Actors Spawned"), STAT_GameItems_PooledEquipmentActorsSpawned, STATGROUP_GameItems);
+
+
+namespace GameItems
+{
+	bool bEnableEquipmentActorPool = true;
+
+	FAutoConsoleVariableRef CVarEnableEquipmentActorPool(
+		TEXT("GameItems.Equipment.ActorPool.Enabled"),
+		bEnableEquipmentActorPool,
+		TEXT("Reuse pooled equipment actors instead of spawning and destroying them. Also requires UGameItemSettings::bEnableEquipmentActorPool."));
+}
+
+
+UGameEquipmentActorPool* UGameEquipmentActorPool::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	return World ? World->GetSubsystem<UGameEquipmentActorPool>() : nullptr;
+}
+
+bool UGameEquipmentActorPool::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGameEquipmentActorPool::Deinitialize()
+{
+	Empty();
+	ManagedActors.Empty();
+
+	Super::Deinitialize();
+}
+
+void UGameEquipmentActorPool::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// clients don't spawn replicated equipment actors, so their pools would go unused
+	if (!IsEnabled() || InWorld.GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	for (const auto& Elem : GetDefault<UGameItemSettings>()->EquipmentActorPoolWarmUp)
+	{
+		// warm up only classes that are already loaded, to avoid hitching when the world starts
+		if (UClass* ActorClass = Elem.Key.Get())
+		{
+			WarmUp(ActorClass, Elem.Value);
+		}
+		else if (!Elem.Key.IsNull())
+		{
+			UE_LOG(LogGameItems, Verbose, TEXT("[%hs] Skipping warm up for %s, the class is not loaded"), __func__, *Elem.Key.ToString());
+		}
+	}
+}
+
+bool UGameEquipmentActorPool::IsEnabled()
+{
+	return GameItems::bEnableEquipmentActorPool && GetDefault<UGameItemSettings>()->bEnableEquipmentActorPool;
+}
+
+AActor* UGameEquipmentActorPool::AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentActorPool::AcquireActor);
+
+	if (!ActorClass)
+	{
+		return nullptr;
+	}
+
+	if (IsEnabled())
+	{
+		if (FGameEquipmentActorPoolEntry* Entry = PooledActors.Find(ActorClass))
+		{
+			while (!Entry->Actors.IsEmpty())
+			{
+				AActor* Actor = Entry->Actors.Pop(EAllowShrinking::No);
+				if (IsValid(Actor))
+				{
+					INC_DWORD_STAT(STAT_GameItems_PooledEquipmentActorsReused);
+					ActivateActor(Actor, Transform, Owner);
+					return Actor;
+				}
+			}
+		}
+	}
+
+	return SpawnActor(ActorClass, Transform, Owner);
+}
+
+void UGameEquipmentActorPool::ReleaseActor(AActor* Actor)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentActorPool::ReleaseActor);
+
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	if (!IsEnabled() || !ManagedActors.Contains(Actor))
+	{
+		ManagedActors.Remove(Actor);
+		Actor->Destroy();
+		return;
+	}
+
+	FGameEquipmentActorPoolEntry& Entry = PooledActors.FindOrAdd(Actor->GetClass());
+	if (Entry.Actors.Num() >= GetDefault<UGameItemSettings>()->MaxPooledEquipmentActorsPerClass)
+	{
+		ManagedActors.Remove(Actor);
+		Actor->Destroy();
+		return;
+	}
+
+	DeactivateActor(Actor);
+	Entry.Actors.Add(Actor);
+}
+
+void UGameEquipmentActorPool::WarmUp(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentActorPool::WarmUp);
+
+	if (!ActorClass || !IsEnabled())
+	{
+		return;
+	}
+
+	Count = FMath::Min(Count, GetDefault<UGameItemSettings>()->MaxPooledEquipmentActorsPerClass);
+
+	FGameEquipmentActorPoolEntry& Entry = PooledActors.FindOrAdd(ActorClass);
+	while (Entry.Actors.Num() < Count)
+	{
+		AActor* Actor = SpawnActor(ActorClass, FTransform::Identity, nullptr);
+		if (!Actor)
+		{
+			break;
+		}
+
+		DeactivateActor(Actor);
+		Entry.Actors.Add(Actor);
+	}
+}
+
+void UGameEquipmentActorPool::Empty()
+{
+	for (const auto& Elem : PooledActors)
+	{
+		for (AActor* Actor : Elem.Value.Actors)
+		{
+			if (IsValid(Actor))
+			{
+				ManagedActors.Remove(Actor);
+				Actor->Destroy();
+			}
+		}
+	}
+	PooledActors.Empty();
+}
+
+int32 UGameEquipmentActorPool::GetNumPooledActors(TSubclassOf<AActor> ActorClass) const
+{
+	const FGameEquipmentActorPoolEntry* Entry = PooledActors.Find(ActorClass);
+	return Entry ? Entry->Actors.Num() : 0;
+}
+
+AActor* UGameEquipmentActorPool::SpawnActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.Owner = Owner;
+	AActor* NewActor = GetWorld()->SpawnActor<AActor>(ActorClass, Transform, SpawnParams);
+	if (NewActor)
+	{
+		INC_DWORD_STAT(STAT_GameItems_PooledEquipmentActorsSpawned);
+		ManagedActors.Add(NewActor);
+		NewActor->OnDestroyed.AddDynamic(this, &ThisClass::OnManagedActorDestroyed);
+	}
+	return NewActor;
+}
+
+void UGameEquipmentActorPool::OnManagedActorDestroyed(AActor* DestroyedActor)
+{
+	// actors in the pool are removed lazily when acquiring
+	ManagedActors.Remove(DestroyedActor);
+}
+
+void UGameEquipmentActorPool::DeactivateActor(AActor* Actor)
+{
+	Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Actor->ForEachComponent(false, [](UActorComponent* Component)
+	{
+		Component->SetComponentTickEnabled(false);
+	});
+
+	// stop replicating, so that clients destroy their copy instead of keeping an ownerless actor around
+	if (Actor->GetIsReplicated() && Actor->HasAuthority())
+	{
+		Actor->SetReplicates(false);
+	}
+	Actor->SetOwner(nullptr);
+
+	if (Actor->Implements<UGameEquipmentPooledActorInterface>())
+	{
+		IGameEquipmentPooledActorInterface::Execute_OnReleasedToPool(Actor);
+	}
+}
+
+void UGameEquipmentActorPool::ActivateActor(AActor* Actor, const FTransform& Transform, AActor* Owner)
+{
+	const AActor* ActorCDO = Actor->GetClass()->GetDefaultObject<AActor>();
+
+	Actor->SetOwner(Owner);
+	Actor->SetActorTransform(Transform);
+	Actor->SetActorHiddenInGame(ActorCDO->IsHidden());
+	Actor->SetActorEnableCollision(ActorCDO->GetActorEnableCollision());
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+	Actor->ForEachComponent(false, [](UActorComponent* Component)
+	{
+		Component->SetComponentTickEnabled(Component->PrimaryComponentTick.bStartWithTickEnabled);
+	});
+
+	if (ActorCDO->GetIsReplicated() && Actor->HasAuthority())
+	{
+		Actor->SetReplicates(true);
+	}
+
+	if (Actor->Implements<UGameEquipmentPooledActorInterface>())
+	{
+		IGameEquipmentPooledActorInterface::Execute_OnAcquiredFromPool(Actor);
+	}
+}
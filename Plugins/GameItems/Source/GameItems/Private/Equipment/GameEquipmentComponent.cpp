@@ -9,11 +9,14 @@
 #include "Engine/World.h"
 #include "Equipment/GameEquipment.h"
 #include "Equipment/GameEquipmentDef.h"
+#include "Equipment/GameEquipmentSubsystem.h"
 #include "GameFramework/Actor.h"
 #include "Net/UnrealNetwork.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GameEquipmentComponent)
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Deferred Equipment Equipped"), STAT_GameItems_DeferredEquipmentEquipped, STATGROUP_GameItems);
+
 
 // used in generic "DoAction" functions to:
 // - call ServerDoAction if we are local owner (but not authority)
@@ -66,6 +69,8 @@ void UGameEquipmentComponent::InitializeComponent()
 
 void UGameEquipmentComponent::UninitializeComponent()
 {
+	PendingEquipment.Empty();
+
 	if (GetOwner() && GetOwner()->HasAuthority())
 	{
 		RemoveAllEquipment();
@@ -99,7 +104,7 @@ void UGameEquipmentComponent::Activate(bool bReset)
 	{
 		for (UGameEquipment* Equipment : GetAllEquipment())
 		{
-			Equipment->Equip();
+			EquipOrQueue(Equipment);
 		}
 	}
 }
@@ -111,7 +116,7 @@ void UGameEquipmentComponent::Deactivate()
 	// don't destroy equipment, just deactivate it
 	for (UGameEquipment* Equipment : GetAllEquipment())
 	{
-		Equipment->Unequip();
+		UnequipAndDequeue(Equipment);
 	}
 }
 
@@ -123,11 +128,11 @@ void UGameEquipmentComponent::OnRep_IsActive()
 	{
 		if (IsActive())
 		{
-			Equipment->Equip();
+			EquipOrQueue(Equipment);
 		}
 		else
 		{
-			Equipment->Unequip();
+			UnequipAndDequeue(Equipment);
 		}
 	}
 }
@@ -139,6 +144,8 @@ void UGameEquipmentComponent::ApplyEquipment(TSubclassOf<UGameEquipmentDef> Equi
 
 void UGameEquipmentComponent::ApplyEquipmentSpec(const FGameEquipmentSpec& EquipmentSpec)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentComponent::ApplyEquipmentSpec);
+
 	if (!EquipmentSpec.EquipmentDef)
 	{
 		return;
@@ -170,6 +177,8 @@ void UGameEquipmentComponent::ServerApplyEquipmentSpec_Implementation(const FGam
 
 void UGameEquipmentComponent::RemoveEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentComponent::RemoveEquipmentByDef);
+
 	if (!EquipmentDef)
 	{
 		return;
@@ -190,7 +199,9 @@ void UGameEquipmentComponent::ServerRemoveEquipmentByDef_Implementation(TSubclas
 
 void UGameEquipmentComponent::RemoveEquipment(UGameEquipment* Equipment)
 {
-	if (!Equipment)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentComponent::RemoveEquipment);
+
+	if (!Equipment || !EquipmentList.Contains(Equipment))
 	{
 		return;
 	}
@@ -213,7 +224,7 @@ void UGameEquipmentComponent::OnEquipmentApplied(UGameEquipment* Equipment)
 
 	if (IsActive())
 	{
-		Equipment->Equip();
+		EquipOrQueue(Equipment);
 	}
 }
 
@@ -227,11 +238,105 @@ void UGameEquipmentComponent::OnEquipmentRemoved(UGameEquipment* Equipment)
 		RemoveReplicatedSubObject(Equipment);
 	}
 
+	UnequipAndDequeue(Equipment);
+}
+
+void UGameEquipmentComponent::EquipOrQueue(UGameEquipment* Equipment)
+{
+	UGameEquipmentSubsystem* EquipmentSubsystem = bDeferEquip ? UGameEquipmentSubsystem::Get(this) : nullptr;
+	if (!EquipmentSubsystem)
+	{
+		Equipment->Equip();
+		return;
+	}
+
+	if (PendingEquipment.Contains(Equipment))
+	{
+		return;
+	}
+
+	// insert after any equipment with the same or higher priority, to keep the order they were applied
+	const UGameEquipmentDef* EquipmentDefCDO = Equipment->GetEquipmentDefCDO();
+	const int32 Priority = EquipmentDefCDO ? EquipmentDefCDO->EquipPriority : 0;
+	int32 InsertIdx = PendingEquipment.Num();
+	for (int32 Idx = 0; Idx < PendingEquipment.Num(); ++Idx)
+	{
+		const UGameEquipmentDef* OtherDefCDO = PendingEquipment[Idx] ? PendingEquipment[Idx]->GetEquipmentDefCDO() : nullptr;
+		if (Priority > (OtherDefCDO ? OtherDefCDO->EquipPriority : 0))
+		{
+			InsertIdx = Idx;
+			break;
+		}
+	}
+	PendingEquipment.Insert(Equipment, InsertIdx);
+
+	EquipmentSubsystem->AddPendingComponent(this);
+}
+
+void UGameEquipmentComponent::UnequipAndDequeue(UGameEquipment* Equipment)
+{
+	if (PendingEquipment.Remove(Equipment) > 0 && PendingEquipment.IsEmpty())
+	{
+		BroadcastPendingEquipmentFinished();
+	}
+
 	Equipment->Unequip();
 }
 
+void UGameEquipmentComponent::EquipNextPendingEquipment()
+{
+	if (PendingEquipment.IsEmpty())
+	{
+		return;
+	}
+
+	UGameEquipment* Equipment = PendingEquipment[0];
+	PendingEquipment.RemoveAt(0, EAllowShrinking::No);
+	if (IsValid(Equipment))
+	{
+		INC_DWORD_STAT(STAT_GameItems_DeferredEquipmentEquipped);
+		Equipment->Equip();
+	}
+
+	if (PendingEquipment.IsEmpty())
+	{
+		BroadcastPendingEquipmentFinished();
+	}
+}
+
+void UGameEquipmentComponent::BroadcastPendingEquipmentFinished()
+{
+	OnPendingEquipmentFinishedEvent.Broadcast();
+	OnPendingEquipmentFinished.Broadcast();
+}
+
+void UGameEquipmentComponent::FlushPendingEquipment()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentComponent::FlushPendingEquipment);
+
+	if (PendingEquipment.IsEmpty())
+	{
+		return;
+	}
+
+	const TArray<TObjectPtr<UGameEquipment>> EquipmentToEquip = MoveTemp(PendingEquipment);
+	PendingEquipment.Reset();
+
+	for (UGameEquipment* Equipment : EquipmentToEquip)
+	{
+		if (IsValid(Equipment))
+		{
+			Equipment->Equip();
+		}
+	}
+
+	BroadcastPendingEquipmentFinished();
+}
+
 void UGameEquipmentComponent::RemoveAllEquipment()
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentComponent::RemoveAllEquipment);
+
 	TArray<UGameEquipment*> AllEquipment = GetAllEquipment();
 	for (UGameEquipment* Equipment : AllEquipment)
 	{
@@ -254,19 +359,25 @@ UGameEquipment* UGameEquipmentComponent::FindEquipment(TSubclassOf<UGameEquipmen
 
 UGameEquipment* UGameEquipmentComponent::FindEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef) const
 {
-	for (const FGameEquipmentListEntry& Entry : EquipmentList.GetEntries())
-	{
-		UGameEquipment* Equipment = Entry.Equipment;
-		if (IsValid(Equipment) && Equipment->GetEquipmentDef() == EquipmentDef)
-		{
-			return Equipment;
-		}
-	}
-	return nullptr;
+	return EquipmentList.FindEquipmentByDef(EquipmentDef);
+}
+
+TArray<UGameEquipment*> UGameEquipmentComponent::FindAllEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef) const
+{
+	TArray<UGameEquipment*> Result;
+	EquipmentList.FindAllEquipmentByDef(EquipmentDef, Result);
+	return Result;
+}
+
+bool UGameEquipmentComponent::HasEquipment(const UGameEquipment* Equipment) const
+{
+	return EquipmentList.Contains(Equipment);
 }
 
 TArray<UGameEquipment*> UGameEquipmentComponent::FindAllEquipment(TSubclassOf<UGameEquipment> EquipmentClass) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentComponent::FindAllEquipment);
+
 	TArray<UGameEquipment*> Result;
 	for (const FGameEquipmentListEntry& Entry : EquipmentList.GetEntries())
 	{
@@ -0,0 +1,98 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "Equipment/GameEquipmentSubsystem.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Equipment/GameEquipmentComponent.h"
+#include "HAL/IConsoleManager.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameEquipmentSubsystem)
+
+
+namespace GameItems
+{
+	float EquipBudgetMs = 2.f;
+
+	FAutoConsoleVariableRef CVarEquipBudgetMs(
+		TEXT("GameItems.Equipment.EquipBudgetMs"),
+		EquipBudgetMs,
+		TEXT("The time in milliseconds that all equipment components with bDeferEquip in a world can spend equipping each frame.")
+		TEXT(" At least one piece of equipment is always equipped per frame."));
+}
+
+
+UGameEquipmentSubsystem* UGameEquipmentSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	return World ? World->GetSubsystem<UGameEquipmentSubsystem>() : nullptr;
+}
+
+bool UGameEquipmentSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UGameEquipmentSubsystem::Deinitialize()
+{
+	PendingComponents.Empty();
+	NextComponentIdx = 0;
+
+	Super::Deinitialize();
+}
+
+bool UGameEquipmentSubsystem::IsTickable() const
+{
+	return !PendingComponents.IsEmpty();
+}
+
+TStatId UGameEquipmentSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameEquipmentSubsystem, STATGROUP_Tickables);
+}
+
+void UGameEquipmentSubsystem::AddPendingComponent(UGameEquipmentComponent* Component)
+{
+	PendingComponents.AddUnique(Component);
+}
+
+void UGameEquipmentSubsystem::Tick(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameEquipmentSubsystem::Tick);
+
+	Super::Tick(DeltaTime);
+
+	const double BudgetSeconds = GameItems::EquipBudgetMs / 1000.0;
+	double SecondsUsed = 0.0;
+	while (!PendingComponents.IsEmpty())
+	{
+		// always allow at least one equip per frame, so that equipping can't stall
+		if (SecondsUsed > 0.0 && SecondsUsed >= BudgetSeconds)
+		{
+			return;
+		}
+
+		if (!PendingComponents.IsValidIndex(NextComponentIdx))
+		{
+			NextComponentIdx = 0;
+		}
+
+		// components are removed here once they're done, since equipping can add or flush pending equipment on any component
+		UGameEquipmentComponent* Component = PendingComponents[NextComponentIdx].Get();
+		if (!Component || !Component->HasPendingEquipment())
+		{
+			PendingComponents.RemoveAt(NextComponentIdx, EAllowShrinking::No);
+			continue;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		Component->EquipNextPendingEquipment();
+		++NextComponentIdx;
+
+		// make sure the budget is always used, even if the clock resolution is too low to measure it
+		SecondsUsed += FMath::Max(FPlatformTime::Seconds() - StartTime, UE_SMALL_NUMBER);
+	}
+}
@@ -4,6 +4,7 @@
 #include "Equipment/GameEquipmentTypes.h"
 
 #include "Equipment/GameEquipment.h"
+#include "Equipment/GameEquipmentDef.h"
 
 
 // FGameEquipmentSpec
@@ -66,10 +67,13 @@ void FGameEquipmentList::PreReplicatedRemove(const TArrayView<int32>& RemovedInd
 	{
 		OnPreReplicatedRemoveEvent.Broadcast(Entries[Idx]);
 	}
+	// dirty after broadcasting, since listeners may rebuild the cache before the entries are removed
+	MarkIndexCacheDirty();
 }
 
 void FGameEquipmentList::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
 {
+	MarkIndexCacheDirty();
 	for (const int32 Idx : AddedIndices)
 	{
 		OnPostReplicatedAddEvent.Broadcast(Entries[Idx]);
@@ -78,6 +82,7 @@ void FGameEquipmentList::PostReplicatedAdd(const TArrayView<int32>& AddedIndices
 
 void FGameEquipmentList::PostReplicatedChange(const TArrayView<int32>& ChangedIndices, int32 FinalSize)
 {
+	MarkIndexCacheDirty();
 	for (const int32 Idx : ChangedIndices)
 	{
 		OnPostReplicatedChangeEvent.Broadcast(Entries[Idx]);
@@ -88,6 +93,12 @@ void FGameEquipmentList::AddEntry(UGameEquipment* Equipment)
 {
 	FGameEquipmentListEntry& NewEntry = Entries.Emplace_GetRef(Equipment);
 	MarkItemDirty(NewEntry);
+
+	if (!bIndexCacheDirty)
+	{
+		// new entries are always last, so the cache can be updated in place
+		AddToIndexCache(Entries.Num() - 1);
+	}
 }
 
 void FGameEquipmentList::RemoveEntry(UGameEquipment* Equipment)
@@ -99,6 +110,94 @@ void FGameEquipmentList::RemoveEntry(UGameEquipment* Equipment)
 		{
 			EntryIt.RemoveCurrent();
 			MarkArrayDirty();
+			MarkIndexCacheDirty();
+		}
+	}
+}
+
+bool FGameEquipmentList::Contains(const UGameEquipment* Equipment) const
+{
+	UpdateIndexCache();
+
+	return IsValid(Equipment) && EntryIndicesByEquipment.Contains(Equipment);
+}
+
+UGameEquipment* FGameEquipmentList::FindEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef) const
+{
+	if (!EquipmentDef)
+	{
+		return nullptr;
+	}
+
+	UpdateIndexCache();
+
+	// the multimap returns the most recently added value first, so find the valid entry with the lowest index
+	int32 FirstIdx = INDEX_NONE;
+	for (auto It = EntryIndicesByDef.CreateConstKeyIterator(EquipmentDef.Get()); It; ++It)
+	{
+		if ((FirstIdx == INDEX_NONE || It.Value() < FirstIdx) && IsValid(Entries[It.Value()].Equipment))
+		{
+			FirstIdx = It.Value();
+		}
+	}
+	return FirstIdx != INDEX_NONE ? Entries[FirstIdx].Equipment.Get() : nullptr;
+}
+
+void FGameEquipmentList::FindAllEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef, TArray<UGameEquipment*>& OutEquipment) const
+{
+	if (!EquipmentDef)
+	{
+		return;
+	}
+
+	UpdateIndexCache();
+
+	TArray<int32, TInlineAllocator<4>> Indices;
+	EntryIndicesByDef.MultiFind(EquipmentDef.Get(), Indices);
+	Indices.Sort();
+
+	OutEquipment.Reserve(OutEquipment.Num() + Indices.Num());
+	for (const int32 Idx : Indices)
+	{
+		if (IsValid(Entries[Idx].Equipment))
+		{
+			OutEquipment.Add(Entries[Idx].Equipment);
 		}
 	}
 }
+
+void FGameEquipmentList::UpdateIndexCache() const
+{
+	if (!bIndexCacheDirty)
+	{
+		return;
+	}
+	bIndexCacheDirty = false;
+
+	EntryIndicesByEquipment.Reset();
+	EntryIndicesByEquipment.Reserve(Entries.Num());
+	EntryIndicesByDef.Reset();
+	EntryIndicesByDef.Reserve(Entries.Num());
+
+	for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+	{
+		AddToIndexCache(Idx);
+	}
+}
+
+void FGameEquipmentList::AddToIndexCache(int32 Idx) const
+{
+	const UGameEquipment* Equipment = Entries[Idx].Equipment;
+	if (!IsValid(Equipment))
+	{
+		return;
+	}
+
+	EntryIndicesByEquipment.Add(Equipment, Idx);
+
+	// entries without a definition can't be found by definition, and aren't indexed again until the list replicates
+	if (const UClass* EquipmentDef = Equipment->GetEquipmentDef())
+	{
+		EntryIndicesByDef.Add(EquipmentDef, Idx);
+	}
+}
@@ -14,7 +14,13 @@
 #include "Equipment/GameEquipment.h"
 #include "Equipment/GameEquipmentDef.h"
 #include "Equipment/GameItemFragment_Equipment.h"
+#include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "TimerManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("ActivateItemEquipmentCondition"), STAT_GameItems_ActivateEquipmentCondition, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("CheckItemEquipmentCondition"), STAT_GameItems_CheckEquipmentCondition, STATGROUP_GameItems);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dirty Equipment Conditions"), STAT_GameItems_DirtyEquipmentConditions, STATGROUP_GameItems);
 
 
 UGameItemEquipmentComponent::UGameItemEquipmentComponent(const FObjectInitializer& ObjectInitializer)
@@ -45,10 +51,18 @@ void UGameItemEquipmentComponent::InitializeComponent()
 
 void UGameItemEquipmentComponent::UninitializeComponent()
 {
+	if (const UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(ReconcileItemEquipmentTimer);
+	}
+	DirtyConditionItems.Empty();
+	PendingRemovedItems.Empty();
+
 	for (auto& Elem : ItemConditionStates)
 	{
 		const UGameItemConditionSchema* DefaultSchema = GetDefault<UGameItemConditionSchema>();
 		FWorldConditionContextData ContextData(*DefaultSchema);
+		SetupConditionContextData(ContextData, Elem.Key);
 
 		FGameItemEquipmentConditionState& ItemCondition = Elem.Value;
 		const FWorldConditionContext Context(ItemCondition.State, ContextData);
@@ -119,6 +133,9 @@ void UGameItemEquipmentComponent::UnregisterItemContainerComponent(UGameItemCont
 
 void UGameItemEquipmentComponent::ActivateItemEquipmentCondition(UGameItem* Item, const UGameItemFragment_Equipment* EquipFrag)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemEquipmentComponent::ActivateItemEquipmentCondition);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_ActivateEquipmentCondition);
+
 	check(Item);
 	check(EquipFrag);
 
@@ -139,7 +156,7 @@ void UGameItemEquipmentComponent::ActivateItemEquipmentCondition(UGameItem* Item
 	Item->OnUnslottedEvent.AddUObject(this, &ThisClass::OnExistingItemUnslotted);
 
 	FGameItemEquipmentConditionState& ItemCondition = ItemConditionStates.Emplace(Item);
-
+	ItemCondition.InputsHash = GetItemConditionInputsHash(Item);
 	// setup condition context
 	const UGameItemConditionSchema* DefaultSchema = GetDefault<UGameItemConditionSchema>();
 	FWorldConditionContextData ContextData(*DefaultSchema);
@@ -165,6 +182,8 @@ void UGameItemEquipmentComponent::ActivateItemEquipmentCondition(UGameItem* Item
 
 void UGameItemEquipmentComponent::DeactivateItemEquipmentCondition(UGameItem* Item, const UGameItemFragment_Equipment* EquipFrag)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemEquipmentComponent::DeactivateItemEquipmentCondition);
+
 	check(Item);
 	check(EquipFrag);
 
@@ -179,6 +198,7 @@ void UGameItemEquipmentComponent::DeactivateItemEquipmentCondition(UGameItem* It
 
 	Item->OnSlottedEvent.RemoveAll(this);
 	Item->OnUnslottedEvent.RemoveAll(this);
+	DirtyConditionItems.Remove(Item);
 
 	FGameItemEquipmentConditionState& ItemCondition = ItemConditionStates.FindChecked(Item);
 
@@ -196,12 +216,16 @@ void UGameItemEquipmentComponent::DeactivateItemEquipmentCondition(UGameItem* It
 
 void UGameItemEquipmentComponent::CheckItemEquipmentCondition(UGameItem* Item, const UGameItemFragment_Equipment* EquipFrag)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemEquipmentComponent::CheckItemEquipmentCondition);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_CheckEquipmentCondition);
+
 	check(Item);
 	check(EquipFrag);
 
 	FGameItemEquipmentConditionState& ItemCondition = ItemConditionStates.FindChecked(Item);
+	ItemCondition.InputsHash = GetItemConditionInputsHash(Item);
 
-	// setup condition context
+	// setup condition context, on the stack since applying equipment may check other items' conditions
 	const UGameItemConditionSchema* DefaultSchema = GetDefault<UGameItemConditionSchema>();
 	FWorldConditionContextData ContextData(*DefaultSchema);
 	SetupConditionContextData(ContextData, Item);
@@ -218,6 +242,105 @@ void UGameItemEquipmentComponent::CheckItemEquipmentCondition(UGameItem* Item, c
 	}
 }
 
+void UGameItemEquipmentComponent::MarkItemConditionDirty(UGameItem* Item)
+{
+	if (!Item || !ItemConditionStates.Contains(Item))
+	{
+		return;
+	}
+
+	DirtyConditionItems.Add(Item);
+	ScheduleReconcileItemEquipment();
+}
+
+void UGameItemEquipmentComponent::ScheduleReconcileItemEquipment()
+{
+	if (!ReconcileItemEquipmentTimer.IsValid())
+	{
+		if (UWorld* World = GetWorld())
+		{
+			ReconcileItemEquipmentTimer = World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::ReconcileItemEquipment);
+		}
+		else
+		{
+			ReconcileItemEquipment();
+		}
+	}
+}
+
+void UGameItemEquipmentComponent::ReconcileItemEquipment()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemEquipmentComponent::ReconcileItemEquipment);
+
+	ReconcileItemEquipmentTimer.Invalidate();
+
+	// remove equipment for items that were removed and not added back
+	const TSet<TObjectPtr<UGameItem>> RemovedItems = MoveTemp(PendingRemovedItems);
+	PendingRemovedItems.Reset();
+
+	for (UGameItem* Item : RemovedItems)
+	{
+		if (const UGameItemFragment_Equipment* EquipFrag = Item ? GetItemEquipmentFragment(Item) : nullptr)
+		{
+			DeactivateItemEquipmentCondition(Item, EquipFrag);
+		}
+	}
+
+	// conditions may change items, which can mark more items dirty for the next tick
+	TSet<TObjectPtr<UGameItem>> ItemsToCheck = MoveTemp(DirtyConditionItems);
+	DirtyConditionItems.Reset();
+
+	INC_DWORD_STAT_BY(STAT_GameItems_DirtyEquipmentConditions, ItemsToCheck.Num());
+
+	for (UGameItem* Item : ItemsToCheck)
+	{
+		const FGameItemEquipmentConditionState* ItemCondition = ItemConditionStates.Find(Item);
+		if (!IsValid(Item) || !ItemCondition)
+		{
+			continue;
+		}
+
+		if (ItemCondition->InputsHash == GetItemConditionInputsHash(Item))
+		{
+			// the item ended up where it was when last checked, e.g. it was moved and moved back,
+			// or only moved within the same containers when ignoring slot changes
+			continue;
+		}
+
+		if (const UGameItemFragment_Equipment* EquipFrag = GetItemEquipmentFragment(Item))
+		{
+			CheckItemEquipmentCondition(Item, EquipFrag);
+		}
+	}
+}
+
+uint32 UGameItemEquipmentComponent::GetItemConditionInputsHash(const UGameItem* Item) const
+{
+	TArray<uint32, TInlineAllocator<8>> ContainerHashes;
+	for (const TWeakObjectPtr<UGameItemContainer>& Container : Item->GetWeakContainers())
+	{
+		if (const UGameItemContainer* ContainerPtr = Container.Get())
+		{
+			uint32 ContainerHash = GetTypeHash(Container);
+			if (!bIgnoreSlotChangesWithinContainer)
+			{
+				ContainerHash = HashCombine(ContainerHash, GetTypeHash(ContainerPtr->GetItemSlot(Item)));
+			}
+			ContainerHashes.Add(ContainerHash);
+		}
+	}
+
+	// sorted, since containers are added and removed in any order
+	ContainerHashes.Sort();
+
+	uint32 Hash = 0;
+	for (const uint32 ContainerHash : ContainerHashes)
+	{
+		Hash = HashCombine(Hash, ContainerHash);
+	}
+	return Hash;
+}
+
 void UGameItemEquipmentComponent::SetupConditionContextData(FWorldConditionContextData& ContextData, const UGameItem* Item) const
 {
 	const UGameItemConditionSchema* DefaultSchema = GetDefault<UGameItemConditionSchema>();
@@ -228,6 +351,8 @@ void UGameItemEquipmentComponent::SetupConditionContextData(FWorldConditionConte
 
 void UGameItemEquipmentComponent::ApplyEquipmentForItem(UGameItem* Item)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemEquipmentComponent::ApplyEquipmentForItem);
+
 	const UGameItemFragment_Equipment* EquipFrag = GetItemEquipmentFragment(Item);
 	if (!EquipFrag->EquipmentDef)
 	{
@@ -248,6 +373,8 @@ void UGameItemEquipmentComponent::ApplyEquipmentForItem(UGameItem* Item)
 
 void UGameItemEquipmentComponent::RemoveEquipmentForItem(UGameItem* Item)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemEquipmentComponent::RemoveEquipmentForItem);
+
 	// items must have unique equipment defs (there's no other association between item and equipment),
 	// this limitation also exists to allow local-only items but server-spawned equipment.
 
@@ -289,6 +416,16 @@ void UGameItemEquipmentComponent::OnItemAdded(UGameItem* Item)
 
 	if (const UGameItemFragment_Equipment* EquipFrag = GetItemEquipmentFragment(Item))
 	{
+		if (PendingRemovedItems.Remove(Item) > 0)
+		{
+			// the item was moved, keep its equipment and conditions and just check them again
+			if (ItemConditionStates.Contains(Item))
+			{
+				MarkItemConditionDirty(Item);
+			}
+			return;
+		}
+
 		ActivateItemEquipmentCondition(Item, EquipFrag);
 	}
 }
@@ -302,28 +439,23 @@ void UGameItemEquipmentComponent::OnItemRemoved(UGameItem* Item)
 
 	if (const UGameItemFragment_Equipment* EquipFrag = GetItemEquipmentFragment(Item))
 	{
+		if (bDeferEquipmentRemoval && GetWorld())
+		{
+			PendingRemovedItems.Add(Item);
+			ScheduleReconcileItemEquipment();
+			return;
+		}
+
 		DeactivateItemEquipmentCondition(Item, EquipFrag);
 	}
 }
 
 void UGameItemEquipmentComponent::OnExistingItemSlotted(UGameItem* Item, const UGameItemContainer* Container, int32 NewSlot, int32 OldSlot)
 {
-	if (Item && ItemConditionStates.Find(Item))
-	{
-		if (const UGameItemFragment_Equipment* EquipFrag = GetItemEquipmentFragment(Item))
-		{
-			CheckItemEquipmentCondition(Item, EquipFrag);
-		}
-	}
+	MarkItemConditionDirty(Item);
 }
 
 void UGameItemEquipmentComponent::OnExistingItemUnslotted(UGameItem* Item, const UGameItemContainer* Container, int32 OldSlot)
 {
-	if (Item && ItemConditionStates.Find(Item))
-	{
-		if (const UGameItemFragment_Equipment* EquipFrag = GetItemEquipmentFragment(Item))
-		{
-			CheckItemEquipmentCondition(Item, EquipFrag);
-		}
-	}
+	MarkItemConditionDirty(Item);
 }
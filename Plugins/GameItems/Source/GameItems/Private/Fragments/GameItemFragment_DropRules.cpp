@@ -4,8 +4,9 @@
 #include "Fragments/GameItemFragment_DropRules.h"
 
 #include "GameItemDef.h"
-#include "GameItemStatics.h"
+#include "GameItemSet.h"
 #include "WorldConditionContext.h"
+#include "Conditions/GameItemConditionCache.h"
 #include "Conditions/GameItemConditionSchema.h"
 
 
@@ -23,10 +24,19 @@ float UGameItemFragment_DropRules::GetProbability(const FGameItemDropContext& Co
 
 bool UGameItemFragment_DropRules::IsConditionMet(const FGameItemDropContext& Context) const
 {
-	// setup condition context
 	const UGameItemConditionSchema* DefaultSchema = GetDefault<UGameItemConditionSchema>();
-	FWorldConditionContextData ContextData(*DefaultSchema);
-	ContextData.SetContextData<UObject>(DefaultSchema->GetTargetActorRef(), Context.TargetActor);
+	return FGameItemConditionCache::Get().Evaluate(*this, Condition, *DefaultSchema, [&](FWorldConditionContextData& ContextData)
+	{
+		ContextData.SetContextData<UObject>(DefaultSchema->GetTargetActorRef(), Context.TargetActor);
+	});
+}
+
+#if WITH_EDITOR
+void UGameItemFragment_DropRules::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
 
-	return UGameItemStatics::EvaluateWorldCondition(this, Condition, ContextData);
+	// item sets cache probabilities and whether conditions are used
+	UGameItemSet::InvalidateAllSelectionCaches();
 }
+#endif
@@ -5,6 +5,8 @@
 
 #include "GameItemContainer.h"
 #include "GameItemDef.h"
+#include "GameItemsModule.h"
+#include "GameItemsTrace.h"
 #include "Net/UnrealNetwork.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GameItem)
@@ -14,6 +16,20 @@ UGameItem::UGameItem(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, Count(0)
 {
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		INC_DWORD_STAT(STAT_GameItems_LiveItems);
+	}
+}
+
+void UGameItem::BeginDestroy()
+{
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		DEC_DWORD_STAT(STAT_GameItems_LiveItems);
+	}
+
+	Super::BeginDestroy();
 }
 
 void UGameItem::OnRep_Count(int32 OldCount)
@@ -61,6 +77,9 @@ void UGameItem::SetCount(int32 NewCount)
 		Count = NewCount;
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Count, this);
 
+		TRACE_GAMEITEMS_OP(EGameItemsTraceOp::ItemCountChanged, this, Containers.IsEmpty() ? nullptr : Containers[0].Get(),
+			INDEX_NONE, NewCount - OldCount, PendingPredictionKey.Id);
+
 		OnCountChangedEvent.Broadcast(this, NewCount, OldCount);
 	}
 }
@@ -172,6 +191,17 @@ void UGameItem::ResetPredictionState()
 	PendingCount.Reset();
 }
 
+void UGameItem::RegisterPendingNetChange()
+{
+	for (const TWeakObjectPtr<UGameItemContainer>& Container : Containers)
+	{
+		if (Container.IsValid())
+		{
+			Container->AddPendingNetChangeItem(PendingPredictionKey, this);
+		}
+	}
+}
+
 void UGameItem::MarkPendingRemove(UGameItemContainer* FromContainer, const FGameItemsPredictionKey PredictionKey)
 {
 	check(FromContainer != nullptr);
@@ -181,6 +211,7 @@ void UGameItem::MarkPendingRemove(UGameItemContainer* FromContainer, const FGame
 	PendingPredictionKey = PredictionKey;
 	bIsPendingRemove = true;
 	PendingRemoveContainer = FromContainer;
+	RegisterPendingNetChange();
 
 	// TODO: broadcast events for UI
 }
@@ -190,6 +221,7 @@ void UGameItem::MarkPendingMove(const FGameItemsPredictionKey PredictionKey)
 	check(!HasPendingNetChange());
 	
 	PendingPredictionKey = PredictionKey;
+	RegisterPendingNetChange();
 
 	// TODO: broadcast events for UI
 }
@@ -200,6 +232,7 @@ void UGameItem::SetPendingCount(int32 NewCount, const FGameItemsPredictionKey Pr
 
 	PendingPredictionKey = PredictionKey;
 	PendingCount = NewCount;
+	RegisterPendingNetChange();
 
 	// TODO: broadcast events for UI
 }
@@ -6,9 +6,12 @@
 #include "GameItem.h"
 #include "GameItemCollectionInterface.h"
 #include "GameItemContainerDef.h"
+#include "GameItemControllerComponent.h"
 #include "GameItemDef.h"
 #include "GameItemSet.h"
 #include "GameItemsModule.h"
+#include "GameItemsNetStats.h"
+#include "GameItemsTrace.h"
 #include "GameItemStatics.h"
 #include "GameItemSubsystem.h"
 #include "Algo/AnyOf.h"
@@ -37,6 +40,13 @@
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GameItemContainer)
 
+DECLARE_CYCLE_STAT(TEXT("GetAddItemPlan"), STAT_GameItems_GetAddItemPlan, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("AddItem"), STAT_GameItems_AddItem, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("RemoveItemAt"), STAT_GameItems_RemoveItemAt, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("BroadcastSlotChanges"), STAT_GameItems_BroadcastSlotChanges, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("CommitSaveData"), STAT_GameItems_CommitSaveData, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("LoadSaveData"), STAT_GameItems_LoadSaveData, STATGROUP_GameItems);
+
 
 // used in generic "DoAction" functions to:
 // - call ServerDoAction if we are local owner (but not authority)
@@ -57,6 +67,24 @@
 		} \
 	}
 
+// same as CONDITIONAL_EXECUTE, but records the operation in the active
+// client transaction (if any) instead of calling ServerDoAction immediately
+#define CONDITIONAL_EXECUTE_OP(FuncName, Op, ...) \
+	{ \
+		bool bExecuteServer; \
+		bool bExecuteLocal; \
+		GetNetExecutionPlan(bExecuteServer, bExecuteLocal); \
+		UE_CLOG(!bExecuteServer && !bExecuteLocal, LogGameItems, Warning, TEXT("%s[%hs] Called without authority or local control"), *GetDebugPrefix(), __func__); \
+		if (bExecuteServer && !UGameItemControllerComponent::RecordTransactionOp(Op)) \
+		{ \
+			Server##FuncName(__VA_ARGS__); \
+		} \
+		if (!bExecuteLocal) \
+		{ \
+			return; \
+		} \
+	}
+
 
 // FGameItemContainerAddPlan
 // -------------------------
@@ -78,6 +106,26 @@ void FGameItemContainerAddPlan::UpdateDerivedValues(int32 ItemCount)
 }
 
 
+// FGameItemContainerAddReservations
+// ---------------------------------
+
+void FGameItemContainerAddReservations::Reserve(const UGameItem* Item, const FGameItemContainerAddPlan& Plan)
+{
+	check(Item);
+	check(Plan.TargetSlots.Num() == Plan.SlotDeltaCounts.Num());
+
+	for (int32 Idx = 0; Idx < Plan.TargetSlots.Num(); ++Idx)
+	{
+		SlotCounts.FindOrAdd(Plan.TargetSlots[Idx]) += Plan.SlotDeltaCounts[Idx];
+		if (!SlotItems.Contains(Plan.TargetSlots[Idx]))
+		{
+			SlotItems.Add(Plan.TargetSlots[Idx], Item);
+		}
+	}
+	ItemDefCounts.FindOrAdd(Item->GetItemDef()) += Plan.DeltaCount;
+}
+
+
 // UGameItemContainer
 // ------------------
 
@@ -86,8 +134,24 @@ UGameItemContainer::UGameItemContainer(const FObjectInitializer& ObjectInitializ
 {
 	if (!HasAnyFlags(RF_ClassDefaultObject))
 	{
+		ItemList.SetOwningContainer(this);
 		ItemList.OnPostReplicateChangesEvent.AddUObject(this, &UGameItemContainer::OnPostReplicatedChanges);
 	}
+
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		INC_DWORD_STAT(STAT_GameItems_LiveContainers);
+	}
+}
+
+void UGameItemContainer::BeginDestroy()
+{
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		DEC_DWORD_STAT(STAT_GameItems_LiveContainers);
+	}
+
+	Super::BeginDestroy();
 }
 
 void UGameItemContainer::SetContainerId(FGameplayTag NewContainerId)
@@ -152,6 +216,7 @@ bool UGameItemContainer::CallRemoteFunction(UFunction* Function, void* Parms, st
 	{
 		return false;
 	}
+	FGameItemsNetStatsRpcScope NetStatsScope(Function, Actor);
 	NetDriver->ProcessRemoteFunction(Actor, Function, Parms, OutParms, Stack, this);
 	return true;
 }
@@ -193,6 +258,9 @@ void UGameItemContainer::SetContainerDef(TSubclassOf<UGameItemContainerDef> NewC
 	// duplicate container rules from the definition so that they can be stateful
 	if (const UGameItemContainerDef* ContainerDefCDO = GetContainerDefCDO())
 	{
+		ReplicationCondition = ContainerDefCDO->ReplicationCondition;
+		NetConditionGroup = ContainerDefCDO->NetConditionGroup;
+
 		for (const UGameItemContainerRule* CDORule : ContainerDefCDO->Rules)
 		{
 			if (!CDORule)
@@ -232,15 +300,59 @@ FGameplayTagContainer UGameItemContainer::GetOwnedTags() const
 	return Result;
 }
 
+bool UGameItemContainer::HasAnyOwnedTags(const FGameplayTagContainer& Tags) const
+{
+	if (ContainerId.MatchesAny(Tags))
+	{
+		return true;
+	}
+	return ContainerDef && GetContainerDefCDO()->OwnedTags.HasAny(Tags);
+}
+
 FGameItemContainerAddPlan UGameItemContainer::CheckAddItem(UGameItem* Item, int32 TargetSlot, UGameItemContainer* OldContainer) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::CheckAddItem);
+
 	// when moving items within a collection, ignore collection limits
 	const bool bIgnoreCollectionLimit = OldContainer && OldContainer->Collection == Collection;
 	return GetAddItemPlan(Item, TargetSlot, bIgnoreCollectionLimit, false);
 }
 
-FGameItemContainerAddPlan UGameItemContainer::GetAddItemPlan(UGameItem* Item, int32 TargetSlot, bool bIgnoreCollectionLimit, bool bWarn) const
+bool UGameItemContainer::CheckAddItems(TConstArrayView<FGameItemMove> Moves, UGameItemContainer* OldContainer, TArray<int32>& OutFailedIndices) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::CheckAddItems);
+
+	// when moving items within a collection, ignore collection limits
+	const bool bIgnoreCollectionLimit = OldContainer && OldContainer->Collection == Collection;
+
+	// plan each item on top of the ones before it
+	FGameItemContainerAddReservations Reservations;
+	for (int32 Idx = 0; Idx < Moves.Num(); ++Idx)
+	{
+		UGameItem* Item = Moves[Idx].Item;
+		const FGameItemContainerAddPlan Plan = GetAddItemPlan(Item, Moves[Idx].TargetSlot, bIgnoreCollectionLimit, false, &Reservations);
+		if (!Plan.bWillAddFullAmount)
+		{
+			OutFailedIndices.Add(Idx);
+			continue;
+		}
+		Reservations.Reserve(Item, Plan);
+	}
+	return OutFailedIndices.IsEmpty();
+}
+
+FGameItemContainerAddPlan UGameItemContainer::CheckAddItemWithReservations(UGameItem* Item, int32 TargetSlot,
+                                                                          const FGameItemContainerAddReservations& Reservations) const
+{
+	return GetAddItemPlan(Item, TargetSlot, false, false, &Reservations);
+}
+
+FGameItemContainerAddPlan UGameItemContainer::GetAddItemPlan(UGameItem* Item, int32 TargetSlot, bool bIgnoreCollectionLimit, bool bWarn,
+                                                             const FGameItemContainerAddReservations* Reservations) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetAddItemPlan);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_GetAddItemPlan);
+
 	FGameItemContainerAddPlan Plan;
 
 	if (!Item || Contains(Item) || !CanContainItem(Item))
@@ -248,15 +360,23 @@ FGameItemContainerAddPlan UGameItemContainer::GetAddItemPlan(UGameItem* Item, in
 		return Plan;
 	}
 
+	// quantities reserved by other planned adds, which aren't in the container yet
+	const int32 ReservedItemCount = Reservations ? Reservations->ItemDefCounts.FindRef(Item->GetItemDef()) : 0;
+	auto GetReservedSlotCount = [Reservations](int32 Slot)
+	{
+		return Reservations ? Reservations->SlotCounts.FindRef(Slot) : 0;
+	};
+
 	// get remaining space in the container
-	int32 MaxDeltaCount = GetRemainingSpaceForItem(Item);
+	int32 MaxDeltaCount = GetRemainingSpaceForItem(Item) - ReservedItemCount;
 
 	// get remaining space in collection
 	if (!bIgnoreCollectionLimit && !IsChild())
 	{
-		const int32 CollectionSpace = GetRemainingCollectionSpaceForItem(Item);
+		const int32 CollectionSpace = GetRemainingCollectionSpaceForItem(Item) - ReservedItemCount;
 		MaxDeltaCount = FMath::Min(MaxDeltaCount, CollectionSpace);
 	}
+	MaxDeltaCount = FMath::Max(MaxDeltaCount, 0);
 
 	// the total desired amount to add based on stock rules.
 	// this doesn't include loss that may happen due from limited slots.
@@ -288,17 +408,33 @@ FGameItemContainerAddPlan UGameItemContainer::GetAddItemPlan(UGameItem* Item, in
 	if (GetContainerDefCDO()->bAutoStack || GetContainerDefCDO()->bLimitSlots)
 	{
 		MatchingItemsWithSpace = GetAllMatchingItems(Item);
-		MatchingItemsWithSpace.RemoveAll([StackMaxCount](const UGameItem* MatchingItem)
+		MatchingItemsWithSpace.RemoveAll([this, StackMaxCount, Reservations, &GetReservedSlotCount](const UGameItem* MatchingItem)
 		{
-			return MatchingItem->GetCount() >= StackMaxCount;
+			const int32 ReservedCount = Reservations ? GetReservedSlotCount(GetItemSlot(MatchingItem)) : 0;
+			return MatchingItem->GetCount() + ReservedCount >= StackMaxCount;
 		});
 	}
 
-	// track future number of empty slots as they are filled
+	// track future number of empty slots as they are filled, and which reserved slots could be stacked with
 	int32 NumEmptySlots = GetNumEmptySlots();
+	TArray<int32> ReservedSlotsWithSpace;
+	if (Reservations)
+	{
+		for (const auto& Elem : Reservations->SlotItems)
+		{
+			if (IsSlotEmpty(Elem.Key))
+			{
+				--NumEmptySlots;
+				if (Item->IsMatching(Elem.Value) && GetReservedSlotCount(Elem.Key) < StackMaxCount)
+				{
+					ReservedSlotsWithSpace.Add(Elem.Key);
+				}
+			}
+		}
+	}
 	while (RemainingCountToAdd > 0)
 	{
-		if (NumEmptySlots == 0 && MatchingItemsWithSpace.IsEmpty())
+		if (NumEmptySlots == 0 && MatchingItemsWithSpace.IsEmpty() && ReservedSlotsWithSpace.IsEmpty())
 		{
 			// out of space
 			UE_CLOG(bWarn, LogGameItems, Warning,
@@ -321,6 +457,10 @@ FGameItemContainerAddPlan UGameItemContainer::GetAddItemPlan(UGameItem* Item, in
 				// start with the first matching item
 				NextTargetSlot = GetItemSlot(MatchingItemsWithSpace[0]);
 			}
+			else if (GetContainerDefCDO()->bAutoStack && !ReservedSlotsWithSpace.IsEmpty())
+			{
+				NextTargetSlot = ReservedSlotsWithSpace[0];
+			}
 			else
 			{
 				NextTargetSlot = 0;
@@ -335,10 +475,12 @@ FGameItemContainerAddPlan UGameItemContainer::GetAddItemPlan(UGameItem* Item, in
 
 		// attempt to add to next target slot
 		UGameItem* ExistingItem = GetItemAt(NextTargetSlot);
-		if (ExistingItem && bCanStackWithExisting && Item->IsMatching(ExistingItem) && ExistingItem->GetCount() < StackMaxCount)
+		const UGameItem* SlotItem = ExistingItem ? ExistingItem : Reservations ? Reservations->SlotItems.FindRef(NextTargetSlot) : nullptr;
+		const int32 ExistingCount = (ExistingItem ? ExistingItem->GetCount() : 0) + GetReservedSlotCount(NextTargetSlot);
+		if (SlotItem && bCanStackWithExisting && Item->IsMatching(SlotItem) && ExistingCount < StackMaxCount)
 		{
 			// found matching item with space, add to it
-			const int32 SlotDeltaCount = FMath::Min(RemainingCountToAdd, StackMaxCount - ExistingItem->GetCount());
+			const int32 SlotDeltaCount = FMath::Min(RemainingCountToAdd, StackMaxCount - ExistingCount);
 
 			Plan.AddCountToSlot(NextTargetSlot, SlotDeltaCount);
 			RemainingCountToAdd -= SlotDeltaCount;
@@ -347,8 +489,9 @@ FGameItemContainerAddPlan UGameItemContainer::GetAddItemPlan(UGameItem* Item, in
 			{
 				MatchingItemsWithSpace.Remove(ExistingItem);
 			}
+			ReservedSlotsWithSpace.Remove(NextTargetSlot);
 		}
-		else if (!ExistingItem)
+		else if (!SlotItem)
 		{
 			// add to empty slot
 			const int32 SlotDeltaCount = FMath::Min(RemainingCountToAdd, StackMaxCount);
@@ -368,7 +511,11 @@ FGameItemContainerAddPlan UGameItemContainer::GetAddItemPlan(UGameItem* Item, in
 
 void UGameItemContainer::AddItem(UGameItem* Item, int32 TargetSlot, bool bWarn)
 {
-	CONDITIONAL_EXECUTE(AddItem, Item, TargetSlot)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::AddItem);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_AddItem);
+	LLM_SCOPE_BYTAG(GameItems);
+
+	CONDITIONAL_EXECUTE_OP(AddItem, FGameItemContainerOp(EGameItemContainerOpType::AddItem, this, Item, TargetSlot), Item, TargetSlot)
 
 	FScopedSlotChanges SlotChangeScope(this);
 
@@ -443,6 +590,8 @@ void UGameItemContainer::AddItem(UGameItem* Item, int32 TargetSlot, bool bWarn)
 
 void UGameItemContainer::AddItems(TArray<UGameItem*> Items, int32 TargetSlot)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::AddItems);
+
 	CONDITIONAL_EXECUTE(AddItems, Items, TargetSlot)
 
 	if (Items.IsEmpty())
@@ -460,7 +609,9 @@ void UGameItemContainer::AddItems(TArray<UGameItem*> Items, int32 TargetSlot)
 
 void UGameItemContainer::RemoveItem(UGameItem* Item)
 {
-	CONDITIONAL_EXECUTE(RemoveItem, Item)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::RemoveItem);
+
+	CONDITIONAL_EXECUTE_OP(RemoveItem, FGameItemContainerOp(EGameItemContainerOpType::RemoveItem, this, Item), Item)
 
 	if (!Item)
 	{
@@ -476,6 +627,8 @@ void UGameItemContainer::RemoveItem(UGameItem* Item)
 
 void UGameItemContainer::RemoveItems(TArray<UGameItem*> Items)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::RemoveItems);
+
 	CONDITIONAL_EXECUTE(RemoveItems, Items)
 
 	if (Items.IsEmpty())
@@ -492,7 +645,10 @@ void UGameItemContainer::RemoveItems(TArray<UGameItem*> Items)
 
 void UGameItemContainer::RemoveItemAt(int32 Slot)
 {
-	CONDITIONAL_EXECUTE(RemoveItemAt, Slot)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::RemoveItemAt);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_RemoveItemAt);
+
+	CONDITIONAL_EXECUTE_OP(RemoveItemAt, FGameItemContainerOp(EGameItemContainerOpType::RemoveItemAt, this, nullptr, Slot), Slot)
 
 	if (!ItemList.HasItemInSlot(Slot))
 	{
@@ -513,6 +669,8 @@ void UGameItemContainer::RemoveItemAt(int32 Slot)
 
 void UGameItemContainer::RemoveItemsByDef(TSubclassOf<UGameItemDef> ItemDef, int32 Count)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::RemoveItemsByDef);
+
 	CONDITIONAL_EXECUTE(RemoveItemsByDef, ItemDef, Count)
 
 	if (!ItemDef)
@@ -549,6 +707,8 @@ void UGameItemContainer::RemoveItemsByDef(TSubclassOf<UGameItemDef> ItemDef, int
 
 void UGameItemContainer::RemoveAllItems()
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::RemoveAllItems);
+
 	CONDITIONAL_EXECUTE(RemoveAllItems)
 
 	// gather items that will be removed, and record which slot they were in
@@ -558,8 +718,9 @@ void UGameItemContainer::RemoveAllItems()
 	{
 		if (UGameItem* Item = Entry.Item)
 		{
-			RemovedItems.Add(Entry.Slot, Item);
-			MaxSlot = FMath::Max(MaxSlot, Entry.Slot);
+			const int32 Slot = ItemList.GetEntrySlot(Entry);
+			RemovedItems.Add(Slot, Item);
+			MaxSlot = FMath::Max(MaxSlot, Slot);
 		}
 	}
 
@@ -586,25 +747,45 @@ void UGameItemContainer::RemoveAllItems()
 
 void UGameItemContainer::SwapItems(int32 SlotA, int32 SlotB)
 {
-	CONDITIONAL_EXECUTE(SwapItems, SlotA, SlotB)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::SwapItems);
+
+	CONDITIONAL_EXECUTE_OP(SwapItems, FGameItemContainerOp(EGameItemContainerOpType::SwapItems, this, nullptr, SlotA, SlotB), SlotA, SlotB)
 
-if (!IsValidSlot(SlotA) || !IsValidSlot(SlotB) || SlotA == SlotB)
+	if (!IsValidSlot(SlotA) || !IsValidSlot(SlotB) || SlotA == SlotB)
 	{
 		return;
 	}
 
 	FScopedSlotChanges SlotChangeScope(this);
 
+	// ordered slots have no gaps, so swapping with an empty slot moves the item to the end,
+	// shifting only the slots from the moved item's old slot to the new last slot
+	const bool bHasItemA = ItemList.HasItemInSlot(SlotA);
+	const bool bHasItemB = ItemList.HasItemInSlot(SlotB);
+	const bool bIsMove = ItemList.UsesOrderedSlots() && (!bHasItemA || !bHasItemB);
+	const int32 MoveFromSlot = bHasItemA ? SlotA : SlotB;
+
 	// nothing will change if both slots are empty
 	if (ItemList.SwapEntries(SlotA, SlotB))
 	{
-		OnSlotsChanged({SlotA, SlotB});
+		TRACE_GAMEITEMS_OP(EGameItemsTraceOp::ItemsSwapped, nullptr, this, SlotA, 0, 0, SlotB);
+		if (bIsMove)
+		{
+			OnSlotRangeChanged(MoveFromSlot, GetNumItems() - 1);
+		}
+		else
+		{
+			OnSlotsChanged({SlotA, SlotB});
+		}
 	}
 }
 
 void UGameItemContainer::StackItems(int32 FromSlot, int32 ToSlot, bool bAllowPartial)
 {
-	CONDITIONAL_EXECUTE(StackItems, FromSlot, ToSlot, bAllowPartial)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::StackItems);
+
+	CONDITIONAL_EXECUTE_OP(StackItems, FGameItemContainerOp(EGameItemContainerOpType::StackItems, this, nullptr, FromSlot, ToSlot, bAllowPartial),
+	                       FromSlot, ToSlot, bAllowPartial)
 
 	UGameItem* FromItem = GetItemAt(FromSlot);
 	UGameItem* ToItem = GetItemAt(ToSlot);
@@ -660,6 +841,8 @@ void UGameItemContainer::StackItems(int32 FromSlot, int32 ToSlot, bool bAllowPar
 
 TMap<int32, UGameItem*> UGameItemContainer::GetAllItems() const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetAllItems);
+
 	TMap<int32, UGameItem*> Result;
 	ItemList.GetAllItems(Result);
 	return Result;
@@ -667,6 +850,8 @@ TMap<int32, UGameItem*> UGameItemContainer::GetAllItems() const
 
 TArray<UGameItem*> UGameItemContainer::GetAllItemsAsSlotArray() const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetAllItemsAsSlotArray);
+
 	TArray<UGameItem*> Result;
 	Result.SetNum(GetNumSlots());
 
@@ -692,6 +877,8 @@ UGameItem* UGameItemContainer::GetFirstItem() const
 
 UGameItem* UGameItemContainer::FindFirstItemByDef(TSubclassOf<UGameItemDef> ItemDef) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::FindFirstItemByDef);
+
 	if (!ItemDef)
 	{
 		return nullptr;
@@ -709,6 +896,8 @@ UGameItem* UGameItemContainer::FindFirstItemByDef(TSubclassOf<UGameItemDef> Item
 
 TArray<UGameItem*> UGameItemContainer::FindItemsByDef(TSubclassOf<UGameItemDef> ItemDef) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::FindItemsByDef);
+
 	TArray<UGameItem*> Result;
 	if (!ItemDef)
 	{
@@ -727,6 +916,8 @@ TArray<UGameItem*> UGameItemContainer::FindItemsByDef(TSubclassOf<UGameItemDef>
 
 UGameItem* UGameItemContainer::FindFirstItemByTag(FGameplayTagContainer RequireTags, FGameplayTagContainer IgnoreTags) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::FindFirstItemByTag);
+
 	if (RequireTags.IsEmpty() && IgnoreTags.IsEmpty())
 	{
 		return nullptr;
@@ -744,6 +935,8 @@ UGameItem* UGameItemContainer::FindFirstItemByTag(FGameplayTagContainer RequireT
 
 TArray<UGameItem*> UGameItemContainer::FindItemsByTag(FGameplayTagContainer RequireTags, FGameplayTagContainer IgnoreTags) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::FindItemsByTag);
+
 	TArray<UGameItem*> Result;
 	if (RequireTags.IsEmpty() && IgnoreTags.IsEmpty())
 	{
@@ -762,6 +955,8 @@ TArray<UGameItem*> UGameItemContainer::FindItemsByTag(FGameplayTagContainer Requ
 
 UGameItem* UGameItemContainer::FindFirstMatchingItem(const UGameItem* Item) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::FindFirstMatchingItem);
+
 	for (const FGameItemListEntry& Entry : ItemList.GetEntries())
 	{
 		UGameItem* EntryItem = Entry.Item;
@@ -775,6 +970,8 @@ UGameItem* UGameItemContainer::FindFirstMatchingItem(const UGameItem* Item) cons
 
 TArray<UGameItem*> UGameItemContainer::GetAllMatchingItems(const UGameItem* Item) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetAllMatchingItems);
+
 	TArray<UGameItem*> Result;
 	for (const FGameItemListEntry& Entry : ItemList.GetEntries())
 	{
@@ -793,7 +990,7 @@ int32 UGameItemContainer::GetItemSlot(const UGameItem* Item) const
 	{
 		if (Entry.Item.Get() == Item)
 		{
-			return Entry.Slot;
+			return ItemList.GetEntrySlot(Entry);
 		}
 	}
 	return INDEX_NONE;
@@ -801,7 +998,9 @@ int32 UGameItemContainer::GetItemSlot(const UGameItem* Item) const
 
 void UGameItemContainer::SetItemAt(UGameItem* Item, int32 Slot)
 {
-	CONDITIONAL_EXECUTE(SetItemAt, Item, Slot)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::SetItemAt);
+
+	CONDITIONAL_EXECUTE_OP(SetItemAt, FGameItemContainerOp(EGameItemContainerOpType::SetItemAt, this, Item, Slot), Item, Slot)
 
 	if (GetItemAt(Slot) != Item)
 	{
@@ -817,6 +1016,8 @@ bool UGameItemContainer::Contains(const UGameItem* Item) const
 
 int32 UGameItemContainer::GetTotalItemCountByDef(TSubclassOf<UGameItemDef> ItemDef) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetTotalItemCountByDef);
+
 	if (!ItemDef)
 	{
 		return 0;
@@ -836,6 +1037,8 @@ int32 UGameItemContainer::GetTotalItemCountByDef(TSubclassOf<UGameItemDef> ItemD
 
 int32 UGameItemContainer::GetTotalMatchingItemCount(const UGameItem* Item) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetTotalMatchingItemCount);
+
 	int32 Total = 0;
 	for (const FGameItemListEntry& Entry : ItemList.GetEntries())
 	{
@@ -850,12 +1053,16 @@ int32 UGameItemContainer::GetTotalMatchingItemCount(const UGameItem* Item) const
 
 int32 UGameItemContainer::GetCollectionMatchingItemCount(const UGameItem* Item) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetCollectionMatchingItemCount);
+
 	const IGameItemCollectionInterface* CollectionInterface = Collection.GetInterface();
 	return CollectionInterface ? CollectionInterface->GetTotalMatchingItemCount(Item) : GetTotalMatchingItemCount(Item);
 }
 
 int32 UGameItemContainer::GetTotalItemCount() const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetTotalItemCount);
+
 	int32 Total = 0;
 	for (const FGameItemListEntry& Entry : ItemList.GetEntries())
 	{
@@ -927,23 +1134,8 @@ int32 UGameItemContainer::GetNextEmptySlot() const
 		return INDEX_NONE;
 	}
 
-	// iterate over existing entries looking for any gaps
-	TArray<int32> FilledSlots;
-	ItemList.GetAllSlots(FilledSlots);
-
-	// filled slots may not be sequential (1, 2, 4, 5),
-	// but we know if we iterate for the same count we will find any gaps,
-	// and if none, return the new highest slot
-	for (int32 Slot = 0; Slot < FilledSlots.Num(); ++Slot)
-	{
-		if (!FilledSlots.Contains(Slot))
-		{
-			return Slot;
-		}
-	}
-	// no gaps, return next index
-	ensure(!FilledSlots.Contains(FilledSlots.Num() + 1));
-	return FilledSlots.Num() + 1;
+	// unlimited slots are ordered and never have gaps, the next slot is always at the end
+	return GetNumItems();
 }
 
 bool UGameItemContainer::IsValidSlot(int32 Slot) const
@@ -992,6 +1184,8 @@ bool UGameItemContainer::CanContainItemByDef(TSubclassOf<UGameItemDef> ItemDef)
 
 int32 UGameItemContainer::GetItemMaxCount(const UGameItem* Item) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetItemMaxCount);
+
 	const UGameItemDef* ItemDefCDO = Item ? Item->GetItemDefCDO() : nullptr;
 	if (!ItemDefCDO)
 	{
@@ -1020,6 +1214,8 @@ int32 UGameItemContainer::GetItemMaxCount(const UGameItem* Item) const
 
 int32 UGameItemContainer::GetItemStackMaxCount(const UGameItem* Item) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetItemStackMaxCount);
+
 	const UGameItemDef* ItemDefCDO = Item ? Item->GetItemDefCDO() : nullptr;
 	if (!ItemDefCDO)
 	{
@@ -1048,6 +1244,8 @@ int32 UGameItemContainer::GetItemStackMaxCount(const UGameItem* Item) const
 
 int32 UGameItemContainer::GetItemCollectionMaxCount(const UGameItem* Item) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetItemCollectionMaxCount);
+
 	const UGameItemDef* ItemDefCDO = Item ? Item->GetItemDefCDO() : nullptr;
 	if (!ItemDefCDO)
 	{
@@ -1069,6 +1267,9 @@ int32 UGameItemContainer::GetRemainingCollectionSpaceForItem(const UGameItem* It
 
 void UGameItemContainer::CreateDefaultItems(bool bForce)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::CreateDefaultItems);
+	LLM_SCOPE_BYTAG(GameItems);
+
 	CONDITIONAL_EXECUTE(CreateDefaultItems, bForce)
 
 	if (bHasDefaultItems && !bForce)
@@ -1130,6 +1331,9 @@ UGameItemContainerRule* UGameItemContainer::GetRule(TSubclassOf<UGameItemContain
 
 UGameItemContainerRule* UGameItemContainer::AddRule(TSubclassOf<UGameItemContainerRule> RuleClass)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::AddRule);
+	LLM_SCOPE_BYTAG(GameItems);
+
 	UGameItemContainerRule* NewRule = NewObject<UGameItemContainerRule>(this, RuleClass);
 	if (NewRule)
 	{
@@ -1145,6 +1349,8 @@ UGameItemContainerRule* UGameItemContainer::AddRule(TSubclassOf<UGameItemContain
 
 int32 UGameItemContainer::RemoveRule(TSubclassOf<UGameItemContainerRule> RuleClass)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::RemoveRule);
+
 	TArray<UGameItemContainerRule*> MatchingRules = Rules.FilterByPredicate([RuleClass](const UGameItemContainerRule* Rule)
 	{
 		return Rule && Rule->GetClass() == RuleClass;
@@ -1242,6 +1448,8 @@ void UGameItemContainer::UnregisterChild(UGameItemContainer* ChildContainer)
 
 int32 UGameItemContainer::GetAutoSlotPriorityForItem(const UGameItem* Item, FGameplayTagContainer ContextTags) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::GetAutoSlotPriorityForItem);
+
 	if (!Item)
 	{
 		return 0;
@@ -1260,6 +1468,8 @@ int32 UGameItemContainer::GetAutoSlotPriorityForItem(const UGameItem* Item, FGam
 
 bool UGameItemContainer::CanAutoSlot(UGameItem* Item, FGameplayTagContainer ContextTags) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::CanAutoSlot);
+
 	for (const UGameItemContainerRule* Rule : Rules)
 	{
 		if (const UGameItemAutoSlotRule* AutoSlotRule = Cast<UGameItemAutoSlotRule>(Rule))
@@ -1276,6 +1486,8 @@ bool UGameItemContainer::CanAutoSlot(UGameItem* Item, FGameplayTagContainer Cont
 
 void UGameItemContainer::TryAutoSlot(UGameItem* Item, FGameplayTagContainer ContextTags)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::TryAutoSlot);
+
 	for (const UGameItemContainerRule* Rule : Rules)
 	{
 		if (const UGameItemAutoSlotRule* AutoSlotRule = Cast<UGameItemAutoSlotRule>(Rule))
@@ -1293,6 +1505,8 @@ void UGameItemContainer::TryAutoSlot(UGameItem* Item, FGameplayTagContainer Cont
 UGameItemContainer* UGameItemContainer::FindAutoSlotChildContainerForItem(const UGameItem* Item, FGameplayTagContainer ContextTags,
                                                                           const FGameplayTagQuery ContainerQuery) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::FindAutoSlotChildContainerForItem);
+
 	UGameItemContainer* BestContainer = nullptr;
 	int32 BestPriority = -1;
 
@@ -1336,56 +1550,109 @@ UWorld* UGameItemContainer::GetWorld() const
 
 void UGameItemContainer::ServerAddItem_Implementation(UGameItem* Item, int32 TargetSlot)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerAddItem")))
+	{
+		return;
+	}
+
 	AddItem(Item, TargetSlot);
 }
 
 void UGameItemContainer::ServerAddItems_Implementation(const TArray<UGameItem*>& Items, int32 TargetSlot)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerAddItems"), Items.Num()))
+	{
+		return;
+	}
+
 	AddItems(Items, TargetSlot);
 }
 
 void UGameItemContainer::ServerRemoveItem_Implementation(UGameItem* Item)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerRemoveItem")))
+	{
+		return;
+	}
+
 	RemoveItem(Item);
 }
 
 void UGameItemContainer::ServerRemoveItems_Implementation(const TArray<UGameItem*>& Items)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerRemoveItems"), Items.Num()))
+	{
+		return;
+	}
+
 	RemoveItems(Items);
 }
 
 void UGameItemContainer::ServerRemoveItemAt_Implementation(int32 Slot)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerRemoveItemAt")))
+	{
+		return;
+	}
+
 	RemoveItemAt(Slot);
 }
 
 void UGameItemContainer::ServerRemoveItemsByDef_Implementation(TSubclassOf<UGameItemDef> ItemDef, int32 Count)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerRemoveItemsByDef")))
+	{
+		return;
+	}
+
 	RemoveItemsByDef(ItemDef, Count);
 }
 
 void UGameItemContainer::ServerRemoveAllItems_Implementation()
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerRemoveAllItems"), GetNumItems()))
+	{
+		return;
+	}
+
 	RemoveAllItems();
 }
 
 void UGameItemContainer::ServerSwapItems_Implementation(int32 SlotA, int32 SlotB)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerSwapItems")))
+	{
+		return;
+	}
+
 	SwapItems(SlotA, SlotB);
 }
 
 void UGameItemContainer::ServerStackItems_Implementation(int32 FromSlot, int32 ToSlot, bool bAllowPartial)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerStackItems")))
+	{
+		return;
+	}
+
 	StackItems(FromSlot, ToSlot, bAllowPartial);
 }
 
 void UGameItemContainer::ServerSetItemAt_Implementation(UGameItem* Item, int32 Slot)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerSetItemAt")))
+	{
+		return;
+	}
+
 	SetItemAt(Item, Slot);
 }
 
 void UGameItemContainer::CommitSaveData(FGameItemContainerSaveData& ContainerData, TMap<UGameItem*, FGuid>& SavedItems)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::CommitSaveData);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_CommitSaveData);
+
 	if (!ensureAlwaysMsgf(HasSaveAndLoadAuthority(),
 		TEXT("Attempted to commit item save data without authority: %s (NetExecutionPolicy: %s)"),
 		*GetReadableName(), *UEnum::GetValueAsString(GetNetExecutionPolicy())))
@@ -1398,7 +1665,7 @@ void UGameItemContainer::CommitSaveData(FGameItemContainerSaveData& ContainerDat
 	ContainerData.ItemList.Reset();
 	for (const FGameItemListEntry& Entry : ItemList.GetEntries())
 	{
-		int32 Slot = Entry.Slot;
+		int32 Slot = ItemList.GetEntrySlot(Entry);
 		UGameItem* Item = Entry.Item;
 
 		ensure(Slot != INDEX_NONE);
@@ -1462,6 +1729,10 @@ void UGameItemContainer::LoadSaveData(
 	bool bPreserveExistingItems,
 	TMap<FGuid, UGameItem*>& LoadedItems)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::LoadSaveData);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_LoadSaveData);
+	LLM_SCOPE_BYTAG(GameItems);
+
 	if (!ensureAlwaysMsgf(HasSaveAndLoadAuthority(),
 		TEXT("Attempted to load item save data without authority: %s (NetExecutionPolicy: %s)"),
 		*GetReadableName(), *UEnum::GetValueAsString(GetNetExecutionPolicy())))
@@ -1485,10 +1756,13 @@ void UGameItemContainer::LoadSaveData(
 
 	// load items
 	bool bIsChild = IsChild();
-	for (const auto& ItemElem : ContainerData.ItemList)
+	// load in slot order, since containers with unlimited slots always add items at the end
+	TArray<int32> SavedSlots;
+	ContainerData.ItemList.GenerateKeyArray(SavedSlots);
+	SavedSlots.Sort();
+	for (const int32 Slot : SavedSlots)
 	{
-		int32 Slot = ItemElem.Key;
-		const FGameItemSaveData& ItemData = ItemElem.Value;
+		const FGameItemSaveData& ItemData = ContainerData.ItemList.FindChecked(Slot);
 
 		if (bIsChild)
 		{
@@ -1586,6 +1860,34 @@ bool UGameItemContainer::ItemsExistOnServer() const
 	return IsReplicated() || (GetNetworkOwner()->GetNetMode() == NM_Client ? !IsLocallyControlled() : IsLocallyControlled());
 }
 
+void UGameItemContainer::SetReplicationCondition(EGameItemContainerReplicationCondition NewCondition, FName NewNetConditionGroup)
+{
+	ReplicationCondition = NewCondition;
+	NetConditionGroup = NewNetConditionGroup;
+
+	UE_CLOG(ReplicationCondition == EGameItemContainerReplicationCondition::Custom && NetConditionGroup.IsNone(), LogGameItems, Warning,
+		TEXT("%s Custom replication condition requires a NetConditionGroup, container will not replicate to any connection"),
+		*GetDebugPrefix());
+}
+
+ELifetimeCondition UGameItemContainer::GetSubObjectNetCondition() const
+{
+	switch (ReplicationCondition)
+	{
+	case EGameItemContainerReplicationCondition::OwnerOnly:
+		return COND_OwnerOnly;
+	case EGameItemContainerReplicationCondition::SkipOwner:
+		return COND_SkipOwner;
+	case EGameItemContainerReplicationCondition::Custom:
+		return NetConditionGroup.IsNone() ? COND_Never : COND_NetGroup;
+	case EGameItemContainerReplicationCondition::Never:
+		return COND_Never;
+	case EGameItemContainerReplicationCondition::Default:
+	default:
+		return COND_None;
+	}
+}
+
 AActor* UGameItemContainer::GetNetworkOwner() const
 {
 	// if owner is a player state, use controller role on clients,
@@ -1600,6 +1902,18 @@ AActor* UGameItemContainer::GetNetworkOwner() const
 	return GetOwner();
 }
 
+bool UGameItemContainer::ConsumeServerRpcBudget(const TCHAR* FuncName, int32 Cost) const
+{
+	UGameItemSubsystem* ItemSubsystem = UGameItemSubsystem::Get(this);
+	const AActor* NetworkOwner = GetNetworkOwner();
+	if (!ItemSubsystem || !NetworkOwner)
+	{
+		return true;
+	}
+
+	return ItemSubsystem->ConsumeRpcBudget(NetworkOwner->GetNetConnection(), Cost, FuncName);
+}
+
 bool UGameItemContainer::IsLocallyControlled() const
 {
 	return IsLocallyControlledActor(GetNetworkOwner());
@@ -1668,16 +1982,19 @@ bool UGameItemContainer::HasSaveAndLoadAuthority() const
 
 void UGameItemContainer::ConfirmPredictionKey(const FGameItemsPredictionKey& PredictionKey, bool bAccepted)
 {
-	// commit or rollback item count / removal
-	TArray<FGameItemListEntry> ItemsPendingNetChange = ItemList.GetEntries().FilterByPredicate([](const FGameItemListEntry& Entry)
-		{
-			return Entry.Item && Entry.Item->HasPendingNetChange();
-		});
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::ConfirmPredictionKey);
+
+	// commit or rollback item count / removal, only items that were marked with this key need to be checked
+	TArray<TWeakObjectPtr<UGameItem>> ItemsPendingNetChange;
+	PendingNetChangeItems.RemoveAndCopyValue(PredictionKey, ItemsPendingNetChange);
 
-	for (const FGameItemListEntry& Entry : ItemsPendingNetChange)
+	TRACE_GAMEITEMS_OP(bAccepted ? EGameItemsTraceOp::PredictionAccepted : EGameItemsTraceOp::PredictionRejected,
+		nullptr, this, INDEX_NONE, ItemsPendingNetChange.Num(), PredictionKey.Id);
+
+	for (const TWeakObjectPtr<UGameItem>& WeakItem : ItemsPendingNetChange)
 	{
-		UGameItem* Item = Entry.Item;
-		if (Item->GetPendingPredictionKey() == PredictionKey)
+		UGameItem* Item = WeakItem.Get();
+		if (Item && Item->Containers.Contains(this) && Item->GetPendingPredictionKey() == PredictionKey)
 		{
 			if (bAccepted)
 			{
@@ -1737,12 +2054,20 @@ void UGameItemContainer::ConfirmPredictionKey(const FGameItemsPredictionKey& Pre
 	}
 }
 
+void UGameItemContainer::AddPendingNetChangeItem(const FGameItemsPredictionKey& PredictionKey, UGameItem* Item)
+{
+	check(Item);
+	PendingNetChangeItems.FindOrAdd(PredictionKey).AddUnique(Item);
+}
+
 void UGameItemContainer::OnItemAdded(UGameItem* Item, int32 Slot)
 {
 	check(Item);
 	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [%hs] [Slot %d] %s"),
 	       *GetDebugPrefix(), __func__, Slot, *Item->GetDebugString());
 
+	TRACE_GAMEITEMS_OP(EGameItemsTraceOp::ItemAdded, Item, this, Slot, Item->GetCount(), Item->GetPendingPredictionKey().Id);
+
 	Item->Containers.AddUnique(this);
 	OnItemAddedEvent.Broadcast(Item);
 	Item->OnSlottedEvent.Broadcast(Item, this, Slot, INDEX_NONE);
@@ -1754,6 +2079,8 @@ void UGameItemContainer::OnItemRemoved(UGameItem* Item, int32 Slot)
 	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [%hs] [Slot %d] %s"),
 	       *GetDebugPrefix(), __func__, Slot, *Item->GetDebugString());
 
+	TRACE_GAMEITEMS_OP(EGameItemsTraceOp::ItemRemoved, Item, this, Slot, -Item->GetCount(), Item->GetPendingPredictionKey().Id);
+
 	Item->Containers.Remove(this);
 	OnItemRemovedEvent.Broadcast(Item);
 	Item->OnUnslottedEvent.Broadcast(Item, this, Slot);
@@ -1763,6 +2090,8 @@ void UGameItemContainer::OnItemRemoved(UGameItem* Item, int32 Slot)
 
 void UGameItemContainer::OnPostReplicatedChanges(const TArray<FGameItemList::FChange>& Changes)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::OnPostReplicatedChanges);
+
 	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [%hs] Received %d changes..."),
 		   *GetDebugPrefix(), __func__, Changes.Num());
 
@@ -1800,8 +2129,16 @@ void UGameItemContainer::OnPostReplicatedChanges(const TArray<FGameItemList::FCh
 			// changed slots
 			if (Change.LastKnownSlot != Change.Slot && Change.LastKnownSlot != INDEX_NONE)
 			{
-				OnSlotChanged(Change.Slot);
-				OnSlotChanged(Change.LastKnownSlot);
+				if (ItemList.UsesOrderedSlots())
+				{
+					// moving an ordered entry shifts the slots between its old and new slot, which are only reported for the moved entry
+					OnSlotRangeChanged(FMath::Min(Change.Slot, Change.LastKnownSlot), FMath::Max(Change.Slot, Change.LastKnownSlot));
+				}
+				else
+				{
+					OnSlotChanged(Change.Slot);
+					OnSlotChanged(Change.LastKnownSlot);
+				}
 			}
 		}
 	}
@@ -1827,8 +2164,32 @@ void UGameItemContainer::EndSlotChanges()
 	}
 }
 
+UGameItemContainer::FItemSlotChangedDelegate& UGameItemContainer::GetSlotChangedEvent(int32 Slot)
+{
+	if (const TSharedRef<FItemSlotChangedDelegate>* SlotEvent = SlotChangedEvents.Find(Slot))
+	{
+		return SlotEvent->Get();
+	}
+	return SlotChangedEvents.Add(Slot, MakeShared<FItemSlotChangedDelegate>()).Get();
+}
+
+void UGameItemContainer::RemoveSlotChangedListener(int32 Slot, const void* UserObject)
+{
+	if (const TSharedRef<FItemSlotChangedDelegate>* SlotEvent = SlotChangedEvents.Find(Slot))
+	{
+		(*SlotEvent)->RemoveAll(UserObject);
+		if (!(*SlotEvent)->IsBound())
+		{
+			SlotChangedEvents.Remove(Slot);
+		}
+	}
+}
+
 void UGameItemContainer::BroadcastSlotChanges()
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemContainer::BroadcastSlotChanges);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_BroadcastSlotChanges);
+
 	struct FSlotRange
 	{
 		FSlotRange()
@@ -1877,6 +2238,21 @@ void UGameItemContainer::BroadcastSlotChanges()
 
 	SlotsArray.Sort();
 
+	TRACE_GAMEITEMS_OP(EGameItemsTraceOp::SlotsChanged, nullptr, this, SlotsArray.IsEmpty() ? INDEX_NONE : SlotsArray[0], SlotsArray.Num(), 0);
+
+	// notify slot listeners directly, instead of every listener checking every change
+	if (!SlotChangedEvents.IsEmpty())
+	{
+		for (const int32 Slot : SlotsArray)
+		{
+			if (const TSharedRef<FItemSlotChangedDelegate>* SlotEvent = SlotChangedEvents.Find(Slot))
+			{
+				const TSharedRef<FItemSlotChangedDelegate> SlotEventRef = *SlotEvent;
+				SlotEventRef->Broadcast(Slot);
+			}
+		}
+	}
+
 	FSlotRange CurrentRange;
 	for (int32 Idx = 0; Idx < SlotsArray.Num(); ++Idx)
 	{
@@ -1917,6 +2293,11 @@ void UGameItemContainer::BroadcastSlotChanges()
 
 void UGameItemContainer::ServerCreateDefaultItems_Implementation(bool bForce)
 {
+	if (!ConsumeServerRpcBudget(TEXT("ServerCreateDefaultItems")))
+	{
+		return;
+	}
+
 	CreateDefaultItems(bForce);
 }
 
@@ -1997,8 +2378,9 @@ void UGameItemContainer::DisplayDebug(UCanvas* Canvas, const FDebugDisplayInfo&
 
 	for (const FGameItemListEntry& Entry : ItemList.GetEntries())
 	{
-		DisplayDebugManager.DrawString(FString::Printf(TEXT("    [%d] %s"), Entry.Slot, *Entry.GetDebugString()));
+		DisplayDebugManager.DrawString(FString::Printf(TEXT("    [%d] %s"), ItemList.GetEntrySlot(Entry), *Entry.GetDebugString()));
 	}
 }
 
 #undef CONDITIONAL_EXECUTE
+#undef CONDITIONAL_EXECUTE_OP
@@ -16,6 +16,7 @@
 #include "GameFramework/SaveGame.h"
 #include "Logging/MessageLog.h"
 #include "Misc/UObjectToken.h"
+#include "Net/NetworkSubsystem.h"
 #include "Net/UnrealNetwork.h"
 #include "Rules/GameItemContainerLink.h"
 
@@ -122,13 +123,13 @@ void UGameItemContainerComponent::ReadyForReplication()
 
 void UGameItemContainerComponent::AddReplicatedContainerSubObjects(UGameItemContainer* Container)
 {
-	AddReplicatedSubObject(Container);
+	AddReplicatedContainerSubObject(Container, Container);
 
 	for (UGameItemContainerRule* Rule : Container->GetRules())
 	{
 		if (IsValid(Rule))
 		{
-			AddReplicatedSubObject(Rule);
+			AddReplicatedContainerSubObject(Container, Rule);
 		}
 	}
 
@@ -138,7 +139,7 @@ void UGameItemContainerComponent::AddReplicatedContainerSubObjects(UGameItemCont
 		{
 			if (UGameItem* Item = Elem.Value)
 			{
-				AddReplicatedSubObject(Item);
+				AddReplicatedContainerSubObject(Container, Item);
 			}
 		}
 	}
@@ -146,13 +147,13 @@ void UGameItemContainerComponent::AddReplicatedContainerSubObjects(UGameItemCont
 
 void UGameItemContainerComponent::RemoveReplicatedContainerSubObjects(UGameItemContainer* Container)
 {
-	RemoveReplicatedSubObject(Container);
+	RemoveReplicatedContainerSubObject(Container, Container);
 
 	for (UGameItemContainerRule* Rule : Container->GetRules())
 	{
 		if (IsValid(Rule))
 		{
-			RemoveReplicatedSubObject(Rule);
+			RemoveReplicatedContainerSubObject(Container, Rule);
 		}
 	}
 
@@ -162,12 +163,43 @@ void UGameItemContainerComponent::RemoveReplicatedContainerSubObjects(UGameItemC
 		{
 			if (UGameItem* Item = Elem.Value)
 			{
-				RemoveReplicatedSubObject(Item);
+				RemoveReplicatedContainerSubObject(Container, Item);
 			}
 		}
 	}
 }
 
+void UGameItemContainerComponent::AddReplicatedContainerSubObject(const UGameItemContainer* Container, UObject* SubObject)
+{
+	check(Container);
+
+	const ELifetimeCondition NetCondition = Container->GetSubObjectNetCondition();
+	if (NetCondition == COND_NetGroup)
+	{
+		if (UNetworkSubsystem* NetworkSubsystem = GetWorld()->GetSubsystem<UNetworkSubsystem>())
+		{
+			NetworkSubsystem->GetNetConditionGroupManager().RegisterSubObjectInGroup(SubObject, Container->GetNetConditionGroup());
+		}
+	}
+
+	AddReplicatedSubObject(SubObject, NetCondition);
+}
+
+void UGameItemContainerComponent::RemoveReplicatedContainerSubObject(const UGameItemContainer* Container, UObject* SubObject)
+{
+	check(Container);
+
+	RemoveReplicatedSubObject(SubObject);
+
+	if (Container->GetSubObjectNetCondition() == COND_NetGroup)
+	{
+		if (UNetworkSubsystem* NetworkSubsystem = GetWorld()->GetSubsystem<UNetworkSubsystem>())
+		{
+			NetworkSubsystem->GetNetConditionGroupManager().UnregisterSubObjectFromGroup(SubObject, Container->GetNetConditionGroup());
+		}
+	}
+}
+
 TArray<UGameItemContainer*> UGameItemContainerComponent::GetAllItemContainers() const
 {
 	return Containers;
@@ -506,6 +538,10 @@ UGameItemContainer* UGameItemContainerComponent::CreateContainer(const FGameItem
 	NewContainer->SetCollection(this);
 	NewContainer->SetContainerDef(ContainerSpec.ContainerDef);
 	NewContainer->DisplayName = ContainerSpec.DisplayName;
+	if (ContainerSpec.bOverrideReplicationCondition)
+	{
+		NewContainer->SetReplicationCondition(ContainerSpec.ReplicationCondition, ContainerSpec.NetConditionGroup);
+	}
 
 	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s Created container: %s (%s)"),
 	       *GetDebugPrefix(), *ContainerSpec.ContainerId.ToString(), *ContainerSpec.ContainerDef->GetName().LeftChop(2));
@@ -698,7 +734,7 @@ void UGameItemContainerComponent::OnItemAddedToContainer(UGameItem* Item, UGameI
 	{
 		if (IsUsingRegisteredSubObjectList() && IsReadyForReplication())
 		{
-			AddReplicatedSubObject(Item);
+			AddReplicatedContainerSubObject(Container, Item);
 		}
 
 		OnItemAddedEvent.Broadcast(Item);
@@ -715,7 +751,7 @@ void UGameItemContainerComponent::OnPostItemRemovedFromContainer(UGameItem* Item
 		{
 			if (IsUsingRegisteredSubObjectList() && IsReadyForReplication())
 			{
-				RemoveReplicatedSubObject(Item);
+				RemoveReplicatedContainerSubObject(Container, Item);
 			}
 
 			OnItemRemovedEvent.Broadcast(Item);
@@ -727,7 +763,7 @@ void UGameItemContainerComponent::OnRuleAdded(UGameItemContainerRule* Rule)
 {
 	if (IsUsingRegisteredSubObjectList() && IsReadyForReplication())
 	{
-		AddReplicatedSubObject(Rule);
+		AddReplicatedContainerSubObject(Rule->GetContainer(), Rule);
 	}
 
 	// TODO: try to resolve container links? but only on rep?
@@ -738,7 +774,7 @@ void UGameItemContainerComponent::OnRuleRemoved(UGameItemContainerRule* Rule)
 {
 	if (IsUsingRegisteredSubObjectList() && IsReadyForReplication())
 	{
-		RemoveReplicatedSubObject(Rule);
+		RemoveReplicatedContainerSubObject(Rule->GetContainer(), Rule);
 	}
 }
 
@@ -4,19 +4,25 @@
 #include "GameItemControllerComponent.h"
 
 #include "GameItemContainer.h"
+#include "GameItemSettings.h"
 #include "GameItemsModule.h"
+#include "GameItemsNetStats.h"
+#include "GameItemsTrace.h"
 #include "GameItemStatics.h"
 #include "GameItemSubsystem.h"
 #include "Engine/World.h"
 #include "GameFramework/Pawn.h"
 #include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
 
 
 UGameItemControllerComponent::UGameItemControllerComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
-	PrimaryComponentTick.bCanEverTick = false;
+	// only ticks to flush queued prediction key confirmations, after all server RPCs have been processed
+	PrimaryComponentTick.bCanEverTick = true;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
 
 	SetIsReplicatedByDefault(true);
 }
@@ -26,8 +32,24 @@ FString UGameItemControllerComponent::GetDebugPrefix() const
 	return FString::Printf(TEXT("%s[%s]"), *UGameItemStatics::GetNetDebugPrefix(this), *GetReadableName());
 }
 
+void UGameItemControllerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	FlushPredictionKeyConfirmations();
+	SetComponentTickEnabled(false);
+}
+
+bool UGameItemControllerComponent::CallRemoteFunction(UFunction* Function, void* Parms, struct FOutParmRec* OutParms, FFrame* Stack)
+{
+	FGameItemsNetStatsRpcScope NetStatsScope(Function, GetOwner());
+	return Super::CallRemoteFunction(Function, Parms, OutParms, Stack);
+}
+
 void UGameItemControllerComponent::MoveSwapOrStackItem(UGameItemContainer* From, UGameItem* Item, UGameItemContainer* To, int32 ToSlot, bool bAllowPartial)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::MoveSwapOrStackItem);
+
 	// early out if moving to same slot
 	if (From && To && From->GetItemSlot(Item) == ToSlot)
 	{
@@ -51,11 +73,15 @@ void UGameItemControllerComponent::MoveSwapOrStackItem(UGameItemContainer* From,
 
 void UGameItemControllerComponent::MoveItem(UGameItemContainer* From, UGameItemContainer* To, UGameItem* Item, bool bAllowPartial)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::MoveItem);
+
 	MoveItems(From, To, {Item}, bAllowPartial);
 }
 
 void UGameItemControllerComponent::MoveItems(UGameItemContainer* From, UGameItemContainer* To, TArray<UGameItem*> Items, bool bAllowPartial)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::MoveItems);
+
 	if (From == To)
 	{
 		return;
@@ -86,6 +112,8 @@ void UGameItemControllerComponent::MoveItems(UGameItemContainer* From, UGameItem
 
 void UGameItemControllerComponent::MoveAllItems(UGameItemContainer* From, UGameItemContainer* To, bool bAllowPartial)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::MoveAllItems);
+
 	if (!From || !To)
 	{
 		return;
@@ -100,6 +128,8 @@ void UGameItemControllerComponent::MoveAllItems(UGameItemContainer* From, UGameI
 
 bool UGameItemControllerComponent::HandleNetMove(const FGameItemMoveSpec& MoveSpec)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::HandleNetMove);
+
 	if (!ensure(MoveSpec.IsValid()))
 	{
 		return false;
@@ -188,8 +218,417 @@ bool UGameItemControllerComponent::HandleNetMove(const FGameItemMoveSpec& MoveSp
 	return false;
 }
 
+void UGameItemControllerComponent::BeginTransaction()
+{
+	if (TransactionDepth++ > 0)
+	{
+		// nested transaction, operations are recorded into the outermost one
+		return;
+	}
+
+	if (UGameItemSubsystem* ItemSubsystem = UGameItemSubsystem::Get(this))
+	{
+		ItemSubsystem->SetControllerRecording(this, true);
+	}
+	ActiveTransaction.Ops.Reset();
+}
+
+void UGameItemControllerComponent::CommitTransaction()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::CommitTransaction);
+
+	if (!ensureMsgf(TransactionDepth > 0, TEXT("CommitTransaction called without BeginTransaction")))
+	{
+		return;
+	}
+
+	if (--TransactionDepth > 0)
+	{
+		// wait for the outermost transaction
+		return;
+	}
+
+	if (UGameItemSubsystem* ItemSubsystem = UGameItemSubsystem::Get(this))
+	{
+		ItemSubsystem->SetControllerRecording(this, false);
+	}
+
+	if (ActiveTransaction.Ops.IsEmpty())
+	{
+		// nothing to send
+		return;
+	}
+
+	const FGameItemsPredictionKey PredictionKey = CreatePredictionKey();
+
+	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [%hs] Sending transaction with %d ops (Key: %s)"),
+		*GetDebugPrefix(), __func__, ActiveTransaction.Ops.Num(), *PredictionKey.ToString());
+
+	TRACE_GAMEITEMS_OP(EGameItemsTraceOp::TransactionSent, nullptr, nullptr, INDEX_NONE, ActiveTransaction.Ops.Num(), PredictionKey.Id);
+
+	// send the operations and await confirmation
+	PendingTransactions.Emplace(PredictionKey, ActiveTransaction);
+	ServerExecuteTransaction(ActiveTransaction, PredictionKey);
+	ActiveTransaction.Ops.Reset();
+}
+
+bool UGameItemControllerComponent::RecordTransactionOp(const FGameItemContainerOp& Op)
+{
+	const UWorld* World = Op.Container ? Op.Container->GetWorld() : nullptr;
+	const UGameItemSubsystem* ItemSubsystem = World ? UGameItemSubsystem::Get(World) : nullptr;
+	if (!ItemSubsystem)
+	{
+		return false;
+	}
+
+	// each local player may be recording their own transaction, record the op in the one that controls the container
+	for (const TWeakObjectPtr<UGameItemControllerComponent>& Controller : ItemSubsystem->GetRecordingControllers())
+	{
+		if (Controller.IsValid() && Controller->CanControlContainer(Op.Container))
+		{
+			Controller->ActiveTransaction.AddOp(Op);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UGameItemControllerComponent::CanExecuteTransaction(const FGameItemContainerTransaction& Transaction) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::CanExecuteTransaction);
+
+	const int32 MaxOps = GetDefault<UGameItemSettings>()->MaxTransactionOps;
+	if (Transaction.Ops.IsEmpty() || Transaction.Ops.Num() > MaxOps)
+	{
+		UE_LOG(LogGameItems, Warning, TEXT("%s [%hs] Invalid number of ops: %d (Max: %d)"),
+			*GetDebugPrefix(), __func__, Transaction.Ops.Num(), MaxOps);
+		return false;
+	}
+
+	// the expected items in each slot of a container after the operations so far
+	struct FDryRunContainer
+	{
+		TArray<const UGameItem*> Slots;
+
+		/** True if slots are derived from the order of items and can't have gaps. */
+		bool bOrderedSlots = false;
+
+		/** Slots and quantities reserved by earlier add operations. */
+		FGameItemContainerAddReservations Reservations;
+
+		bool IsOccupied(int32 Slot) const
+		{
+			return Slots.IsValidIndex(Slot) && Slots[Slot] != nullptr;
+		}
+
+		void SetSlot(int32 Slot, const UGameItem* Item)
+		{
+			if (bOrderedSlots && Slot >= Slots.Num())
+			{
+				Slots.Add(Item);
+				return;
+			}
+			if (Slot >= Slots.Num())
+			{
+				Slots.SetNumZeroed(Slot + 1);
+			}
+			Slots[Slot] = Item;
+		}
+
+		void ClearSlot(int32 Slot)
+		{
+			if (bOrderedSlots)
+			{
+				// later items move down to fill the gap
+				Slots.RemoveAt(Slot);
+			}
+			else
+			{
+				Slots[Slot] = nullptr;
+			}
+		}
+	};
+	TMap<const UGameItemContainer*, FDryRunContainer> DryRunContainers;
+
+	auto GetDryRunContainer = [&DryRunContainers](const UGameItemContainer* Container) -> FDryRunContainer&
+	{
+		if (FDryRunContainer* Existing = DryRunContainers.Find(Container))
+		{
+			return *Existing;
+		}
+
+		FDryRunContainer& NewContainer = DryRunContainers.Add(Container);
+		NewContainer.bOrderedSlots = Container->GetInternalItemList().UsesOrderedSlots();
+		NewContainer.Slots.Append(Container->GetAllItemsAsSlotArray());
+		if (NewContainer.bOrderedSlots)
+		{
+			// ordered slots have no gaps, only track the occupied ones
+			NewContainer.Slots.Remove(nullptr);
+		}
+		return NewContainer;
+	};
+
+	// the expected count of each item after the operations so far, since adding and stacking change counts
+	TMap<const UGameItem*, int32> DryRunCounts;
+
+	auto GetDryRunCount = [&DryRunCounts](const UGameItem* Item) -> int32
+	{
+		const int32* Count = DryRunCounts.Find(Item);
+		return Count ? *Count : Item->GetCount();
+	};
+
+	// items can only be added if the client could also control wherever they currently are
+	auto CanControlItem = [this](const UGameItem* Item)
+	{
+		for (const TWeakObjectPtr<UGameItemContainer>& ItemContainer : Item->GetWeakContainers())
+		{
+			if (ItemContainer.IsValid() && !CanControlContainer(ItemContainer.Get()))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	for (int32 Idx = 0; Idx < Transaction.Ops.Num(); ++Idx)
+	{
+		const FGameItemContainerOp& Op = Transaction.Ops[Idx];
+		const UGameItemContainer* Container = Op.Container;
+
+		bool bIsValid = Container && Container->ItemsExistOnServer() && CanControlContainer(Container);
+		if (bIsValid)
+		{
+			FDryRunContainer& DryRun = GetDryRunContainer(Container);
+			switch (Op.Type)
+			{
+			case EGameItemContainerOpType::AddItem:
+				{
+					bIsValid = Op.Item != nullptr && !DryRun.Slots.Contains(Op.Item) && CanControlItem(Op.Item);
+					if (bIsValid)
+					{
+						// plan on top of earlier adds, which is conservative since slots freed by earlier removals aren't reused
+						const FGameItemContainerAddPlan Plan = Container->CheckAddItemWithReservations(Op.Item, Op.SlotA, DryRun.Reservations);
+						bIsValid = Plan.bWillAddFullAmount;
+						if (bIsValid)
+						{
+							DryRun.Reservations.Reserve(Op.Item, Plan);
+							for (int32 PlanIdx = 0; PlanIdx < Plan.TargetSlots.Num(); ++PlanIdx)
+							{
+								const int32 TargetSlot = Plan.TargetSlots[PlanIdx];
+								const int32 SlotDeltaCount = Plan.SlotDeltaCounts[PlanIdx];
+								if (DryRun.IsOccupied(TargetSlot))
+								{
+									// stacking with an existing item
+									const UGameItem* ExistingItem = DryRun.Slots[TargetSlot];
+									DryRunCounts.Add(ExistingItem, GetDryRunCount(ExistingItem) + SlotDeltaCount);
+								}
+								else
+								{
+									DryRun.SetSlot(TargetSlot, Op.Item);
+									DryRunCounts.Add(Op.Item, SlotDeltaCount);
+								}
+							}
+						}
+					}
+					break;
+				}
+			case EGameItemContainerOpType::SetItemAt:
+				bIsValid = Op.Item != nullptr && Container->IsValidSlot(Op.SlotA) && !DryRun.Slots.Contains(Op.Item) && CanControlItem(Op.Item);
+				if (bIsValid)
+				{
+					DryRun.SetSlot(Op.SlotA, Op.Item);
+				}
+				break;
+			case EGameItemContainerOpType::RemoveItem:
+				{
+					const int32 Slot = Op.Item ? DryRun.Slots.Find(Op.Item) : INDEX_NONE;
+					bIsValid = Slot != INDEX_NONE;
+					if (bIsValid)
+					{
+						DryRun.ClearSlot(Slot);
+					}
+					break;
+				}
+			case EGameItemContainerOpType::RemoveItemAt:
+				bIsValid = Container->IsValidSlot(Op.SlotA) && DryRun.IsOccupied(Op.SlotA);
+				if (bIsValid)
+				{
+					DryRun.ClearSlot(Op.SlotA);
+				}
+				break;
+			case EGameItemContainerOpType::SwapItems:
+				bIsValid = Container->IsValidSlot(Op.SlotA) && Container->IsValidSlot(Op.SlotB)
+					&& (DryRun.IsOccupied(Op.SlotA) || DryRun.IsOccupied(Op.SlotB));
+				if (bIsValid && Op.SlotA != Op.SlotB)
+				{
+					if (DryRun.IsOccupied(Op.SlotA) && DryRun.IsOccupied(Op.SlotB))
+					{
+						Swap(DryRun.Slots[Op.SlotA], DryRun.Slots[Op.SlotB]);
+					}
+					else
+					{
+						// moving to an empty slot, which for ordered slots moves the item to the end
+						const int32 FromSlot = DryRun.IsOccupied(Op.SlotA) ? Op.SlotA : Op.SlotB;
+						const int32 ToSlot = FromSlot == Op.SlotA ? Op.SlotB : Op.SlotA;
+						const UGameItem* Item = DryRun.Slots[FromSlot];
+						DryRun.ClearSlot(FromSlot);
+						DryRun.SetSlot(DryRun.bOrderedSlots ? DryRun.Slots.Num() : ToSlot, Item);
+					}
+				}
+				break;
+			case EGameItemContainerOpType::StackItems:
+				{
+					const UGameItem* FromItem = DryRun.IsOccupied(Op.SlotA) ? DryRun.Slots[Op.SlotA] : nullptr;
+					const UGameItem* ToItem = DryRun.IsOccupied(Op.SlotB) ? DryRun.Slots[Op.SlotB] : nullptr;
+					bIsValid = Container->IsValidSlot(Op.SlotA) && Container->IsValidSlot(Op.SlotB) && Op.SlotA != Op.SlotB
+						&& FromItem && ToItem && FromItem->IsMatching(ToItem);
+					if (bIsValid)
+					{
+						const int32 FromCount = GetDryRunCount(FromItem);
+						const int32 ToCount = GetDryRunCount(ToItem);
+						const int32 DeltaCount = FMath::Min(FromCount, FMath::Max(Container->GetItemStackMaxCount(ToItem) - ToCount, 0));
+						bIsValid = DeltaCount > 0 && (DeltaCount == FromCount || Op.bAllowPartial);
+						if (bIsValid)
+						{
+							DryRunCounts.Add(FromItem, FromCount - DeltaCount);
+							DryRunCounts.Add(ToItem, ToCount + DeltaCount);
+							if (DeltaCount == FromCount)
+							{
+								// the emptied stack is removed, which for ordered slots moves later items down
+								DryRun.ClearSlot(Op.SlotA);
+							}
+						}
+					}
+					break;
+				}
+			default:
+				bIsValid = false;
+				break;
+			}
+		}
+
+		if (!bIsValid)
+		{
+			UE_LOG(LogGameItems, Warning, TEXT("%s [%hs] Invalid op %d: %s (Container: %s, Item: %s, Slots: %d, %d)"),
+				*GetDebugPrefix(), __func__, Idx, *UEnum::GetValueAsString(Op.Type),
+				*GetNameSafe(Container), *GetNameSafe(Op.Item), Op.SlotA, Op.SlotB);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool UGameItemControllerComponent::CanControlContainer(const UGameItemContainer* Container) const
+{
+	if (!Container || Container->GetNetExecutionPolicy() != EGameItemContainerNetExecutionPolicy::LocalPredicted)
+	{
+		return false;
+	}
+
+	// the container must belong to the same client connection as this controller
+	const AActor* ContainerOwner = Container->GetNetworkOwner();
+	const UNetConnection* Connection = GetOwner() ? GetOwner()->GetNetConnection() : nullptr;
+	return ContainerOwner && Connection && ContainerOwner->GetNetConnection() == Connection;
+}
+
+bool UGameItemControllerComponent::ExecuteTransaction(const FGameItemContainerTransaction& Transaction)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::ExecuteTransaction);
+
+	// group slot changes, so each affected container broadcasts once for the whole transaction
+	TArray<UGameItemContainer*> AffectedContainers;
+	TArray<TUniquePtr<UGameItemContainer::FScopedSlotChanges>> SlotChangeScopes;
+
+	for (int32 Idx = 0; Idx < Transaction.Ops.Num(); ++Idx)
+	{
+		const FGameItemContainerOp& Op = Transaction.Ops[Idx];
+		UGameItemContainer* Container = Op.Container;
+		if (!AffectedContainers.Contains(Container))
+		{
+			AffectedContainers.Add(Container);
+			SlotChangeScopes.Emplace(MakeUnique<UGameItemContainer::FScopedSlotChanges>(Container));
+		}
+
+		if (!ExecuteTransactionOp(Op))
+		{
+			// the dry run didn't match the actual result, don't apply anything that depended on this op
+			UE_LOG(LogGameItems, Warning, TEXT("%s [%hs] Failed op %d: %s (Container: %s, Item: %s, Slots: %d, %d), skipping %d remaining ops"),
+				*GetDebugPrefix(), __func__, Idx, *UEnum::GetValueAsString(Op.Type),
+				*GetNameSafe(Container), *GetNameSafe(Op.Item), Op.SlotA, Op.SlotB, Transaction.Ops.Num() - Idx - 1);
+			return false;
+		}
+	}
+
+	// slot changes are broadcast as the scopes are destroyed
+	return true;
+}
+
+bool UGameItemControllerComponent::ExecuteTransactionOp(const FGameItemContainerOp& Op)
+{
+	UGameItemContainer* Container = Op.Container;
+	if (!Container)
+	{
+		return false;
+	}
+
+	switch (Op.Type)
+	{
+	case EGameItemContainerOpType::AddItem:
+		if (!Op.Item || !Container->CheckAddItem(Op.Item, Op.SlotA).bWillAddFullAmount)
+		{
+			return false;
+		}
+		Container->AddItem(Op.Item, Op.SlotA);
+		return true;
+	case EGameItemContainerOpType::RemoveItem:
+		if (!Op.Item || !Container->Contains(Op.Item))
+		{
+			return false;
+		}
+		Container->RemoveItem(Op.Item);
+		return true;
+	case EGameItemContainerOpType::RemoveItemAt:
+		if (!Container->GetItemAt(Op.SlotA))
+		{
+			return false;
+		}
+		Container->RemoveItemAt(Op.SlotA);
+		return true;
+	case EGameItemContainerOpType::SwapItems:
+		if (!Container->IsValidSlot(Op.SlotA) || !Container->IsValidSlot(Op.SlotB)
+			|| (!Container->GetItemAt(Op.SlotA) && !Container->GetItemAt(Op.SlotB)))
+		{
+			return false;
+		}
+		Container->SwapItems(Op.SlotA, Op.SlotB);
+		return true;
+	case EGameItemContainerOpType::StackItems:
+		{
+			// stacking succeeded if anything was added to the target stack
+			const UGameItem* ToItem = Container->GetItemAt(Op.SlotB);
+			if (!ToItem || !Container->GetItemAt(Op.SlotA))
+			{
+				return false;
+			}
+			const int32 OldCount = ToItem->GetCount();
+			Container->StackItems(Op.SlotA, Op.SlotB, Op.bAllowPartial);
+			return ToItem->GetCount() > OldCount;
+		}
+	case EGameItemContainerOpType::SetItemAt:
+		if (!Op.Item || !Container->IsValidSlot(Op.SlotA))
+		{
+			return false;
+		}
+		Container->SetItemAt(Op.Item, Op.SlotA);
+		return Container->Contains(Op.Item);
+	default:
+		return false;
+	}
+}
+
 void UGameItemControllerComponent::MoveClientItemsToServer(const FGameItemMoveSpec& MoveSpec)
 {
+	// - validate all items, and send either all of them or none
 	// - generate a prediction key, and 'remove' the items locally (don't fully remove them or free up slots, to make rollback easy)
 	// - serialize to save data and send items to server, where it recreates the items in ToContainer
 	// - server acks with the prediction...
@@ -202,27 +641,52 @@ void UGameItemControllerComponent::MoveClientItemsToServer(const FGameItemMoveSp
 	}
 
 	UGameItemContainer* From = MoveSpec.Containers.From;
-	UGameItemContainer* To = MoveSpec.Containers.From;
-
-	const FGameItemsPredictionKey PredictionKey = FGameItemsPredictionKey::CreateNewClientPredictionKey(GetOwner());
+	UGameItemContainer* To = MoveSpec.Containers.To;
 
-	TArray<FGameItemSerializedMove> ServerMoves;
-	for (const FGameItemMove& Move : MoveSpec.Moves)
+	// make sure every item is valid before changing anything
+	TArray<int32> FailedMoveIndices;
+	for (int32 Idx = 0; Idx < MoveSpec.Moves.Num(); ++Idx)
 	{
-		UGameItem* Item = Move.Item;
+		const UGameItem* Item = MoveSpec.Moves[Idx].Item;
 		if (!ensure(Item))
 		{
-			continue;
+			FailedMoveIndices.Add(Idx);
 		}
-
-		if (Item->HasPendingNetChange())
+		else if (Item->HasPendingNetChange())
 		{
+			// item already waiting on some predicted action, leave it alone
 			UE_LOG(LogGameItems, Warning, TEXT("Item already pending net changes: %s"),
 				*Item->GetDebugString());
-
-			// item already waiting on some predicted action, leave it alone
-			continue;
+			FailedMoveIndices.Add(Idx);
 		}
+	}
+
+	if (!FailedMoveIndices.IsEmpty())
+	{
+		UE_LOG(LogGameItems, Verbose, TEXT("%s [%hs] %d of %d items invalid or already pending net change"),
+			*GetDebugPrefix(), __func__, FailedMoveIndices.Num(), MoveSpec.Moves.Num());
+
+		OnMoveResultEvent.Broadcast(FGameItemsPredictionKey(), FGameItemMoveResult(EGameItemMoveResultCode::InvalidItems, FailedMoveIndices));
+		return;
+	}
+
+	// check against the replicated state of the target container, to avoid sending a request that will be rejected
+	if (To->IsReplicated() && !To->CheckAddItems(MoveSpec.Moves, From, FailedMoveIndices))
+	{
+		UE_LOG(LogGameItems, Verbose, TEXT("%s [%hs] %d of %d items cant be added to %s"),
+			*GetDebugPrefix(), __func__, FailedMoveIndices.Num(), MoveSpec.Moves.Num(), *To->GetReadableName());
+
+		OnMoveResultEvent.Broadcast(FGameItemsPredictionKey(), FGameItemMoveResult(EGameItemMoveResultCode::CantAddItems, FailedMoveIndices));
+		return;
+	}
+
+	const FGameItemsPredictionKey PredictionKey = CreatePredictionKey();
+
+	TArray<FGameItemSerializedMove> ServerMoves;
+	ServerMoves.Reserve(MoveSpec.Moves.Num());
+	for (const FGameItemMove& Move : MoveSpec.Moves)
+	{
+		UGameItem* Item = Move.Item;
 
 		// mark item as pending-remove from this container
 		UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [%hs] Marking for remove: %s"),
@@ -237,14 +701,6 @@ void UGameItemControllerComponent::MoveClientItemsToServer(const FGameItemMoveSp
 		ServerMoves.Emplace(Item, Move.TargetSlot);
 	}
 
-	if (ServerMoves.IsEmpty())
-	{
-		// nothing to send
-		UE_LOG(LogGameItems, Verbose, TEXT("%s [%hs] All items invalid or already pending net change"),
-			*GetDebugPrefix(), __func__);
-		return;
-	}
-
 	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [%hs] Moving %d items to %s (Key: %s)"),
 		*GetDebugPrefix(), __func__, ServerMoves.Num(), *To->GetReadableName(), *PredictionKey.ToString());
 
@@ -266,7 +722,7 @@ void UGameItemControllerComponent::MoveServerItemsToClient(const FGameItemMoveSp
 		return;
 	}
 
-	const FGameItemsPredictionKey PredictionKey = FGameItemsPredictionKey::CreateNewClientPredictionKey(GetOwner());
+	const FGameItemsPredictionKey PredictionKey = CreatePredictionKey();
 
 	TArray<FGameItemMove> ServerMoves;
 	for (const FGameItemMove& Move : MoveSpec.Moves)
@@ -331,7 +787,7 @@ void UGameItemControllerComponent::MoveServerItems(const FGameItemMoveSpec& Move
 		return;
 	}
 
-	const FGameItemsPredictionKey PredictionKey = FGameItemsPredictionKey::CreateNewClientPredictionKey(GetOwner());
+	const FGameItemsPredictionKey PredictionKey = CreatePredictionKey();
 
 	TArray<FGameItemMove> ServerMoves;
 	for (const FGameItemMove& Move : MoveSpec.Moves)
@@ -373,12 +829,20 @@ void UGameItemControllerComponent::ServerReceiveItems_Implementation(
 	const FGameItemContainerPair& Containers,
 	FGameItemsPredictionKey PredictionKey)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::ServerReceiveItems_Implementation);
+
+	if (!ReceivePredictionKey(PredictionKey) || !ConsumeServerRpcBudget(TEXT("ServerReceiveItems"), Moves.Num()))
+	{
+		QueueConfirmPredictionKey(PredictionKey, false);
+		return;
+	}
+
 	if (!Containers.IsValid())
 	{
 		UE_LOG(LogGameItems, Warning, TEXT("%s [ServerReceiveItems] Cant move items, invalid containers (From: %s, To: %s) (Key: %s)"),
 			*GetDebugPrefix(), *GetNameSafe(Containers.From), *GetNameSafe(Containers.To), *PredictionKey.ToString());
 
-		ClientConfirmPredictionKey(PredictionKey, false);
+		ClientConfirmItemMoves(PredictionKey, FGameItemMoveResult(EGameItemMoveResultCode::InvalidContainers));
 		return;
 	}
 
@@ -387,42 +851,58 @@ void UGameItemControllerComponent::ServerReceiveItems_Implementation(
 
 	UGameItemSubsystem* ItemSubsystem = UGameItemSubsystem::Get(this);
 
-	bool bSuccess = true;
+	FGameItemMoveResult Result;
 
-	// recreate the items in the target container
-	for (const FGameItemSerializedMove& Move : Moves)
+	// recreate all the items first, without adding any
+	TArray<FGameItemMove> NewItemMoves;
+	NewItemMoves.Reserve(Moves.Num());
+	for (int32 Idx = 0; Idx < Moves.Num(); ++Idx)
 	{
-		const FGameItemSaveData& ItemData = Move.ItemData;
-		const int32 TargetSlot = Move.TargetSlot;
-
-		if (UGameItem* NewItem = ItemSubsystem->CreateItemFromSaveData(Containers.To->GetItemOuter(), ItemData))
+		const FGameItemSaveData& ItemData = Moves[Idx].ItemData;
+		UGameItem* NewItem = ItemSubsystem->CreateItemFromSaveData(Containers.To->GetItemOuter(), ItemData);
+		if (!NewItem)
 		{
-			UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerReceiveItems] Recreated item %s (Key: %s)"),
-				*GetDebugPrefix(), *NewItem->GetDebugString(), *PredictionKey.ToString());
-
-			// TODO: test ALL items up front before adding any! or mark added items with a prediction key for rollback
-			// make sure the item will add successfully
-			const FGameItemContainerAddPlan Plan = Containers.To->CheckAddItem(NewItem, TargetSlot, Containers.From);
-			if (!Plan.bWillAddFullAmount)
-			{
-				bSuccess = false;
-				break;
-			}
+			UE_LOG(LogGameItems, Error, TEXT("%s [ServerReceiveItems] Failed to recreate client item: %s (Key: %s)"),
+				*GetDebugPrefix(), *ItemData.ToString(), *PredictionKey.ToString());
 
-			Containers.To->AddItem(NewItem, TargetSlot);
+			Result.Code = EGameItemMoveResultCode::InvalidItems;
+			Result.FailedMoveIndices.Add(Idx);
+			continue;
 		}
-		else
+
+		UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerReceiveItems] Recreated item %s (Key: %s)"),
+			*GetDebugPrefix(), *NewItem->GetDebugString(), *PredictionKey.ToString());
+
+		NewItemMoves.Emplace(NewItem, Moves[Idx].TargetSlot);
+	}
+
+	// make sure all items will add successfully together, before adding any
+	if (Result.WasSuccessful() && !Containers.To->CheckAddItems(NewItemMoves, Containers.From, Result.FailedMoveIndices))
+	{
+		Result.Code = EGameItemMoveResultCode::CantAddItems;
+	}
+
+	if (Result.WasSuccessful())
+	{
+		UGameItemContainer::FScopedSlotChanges SlotChangeScope(Containers.To);
+		for (const FGameItemMove& Move : NewItemMoves)
 		{
-			// this should cancel the operation, but for now allow partial failure
-			UE_LOG(LogGameItems, Error, TEXT("%s [ServerReceiveItems] Failed to recreate client item: %s (Key: %s)"),
-				*GetDebugPrefix(), *ItemData.ToString(), *PredictionKey.ToString());
+			Containers.To->AddItem(Move.Item, Move.TargetSlot);
 		}
 	}
 
-	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerReceiveItems] Calling ClientConfirmPredictionKey %s (Key: %s)"),
-		*GetDebugPrefix(), bSuccess ? TEXT("Accepted") : TEXT("Rejected"), *PredictionKey.ToString());
+	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerReceiveItems] Confirming %s (Key: %s)"),
+		*GetDebugPrefix(), *UEnum::GetValueAsString(Result.Code), *PredictionKey.ToString());
 
-	ClientConfirmPredictionKey(PredictionKey, bSuccess);
+	if (Result.WasSuccessful())
+	{
+		QueueConfirmPredictionKey(PredictionKey, true);
+	}
+	else
+	{
+		// send failure details immediately
+		ClientConfirmItemMoves(PredictionKey, Result);
+	}
 }
 
 void UGameItemControllerComponent::ServerSendItems_Implementation(
@@ -430,12 +910,20 @@ void UGameItemControllerComponent::ServerSendItems_Implementation(
 	const FGameItemContainerPair& Containers,
 	FGameItemsPredictionKey PredictionKey)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::ServerSendItems_Implementation);
+
+	if (!ReceivePredictionKey(PredictionKey) || !ConsumeServerRpcBudget(TEXT("ServerSendItems"), Moves.Num()))
+	{
+		QueueConfirmPredictionKey(PredictionKey, false);
+		return;
+	}
+
 	if (!Containers.IsValid())
 	{
 		UE_LOG(LogGameItems, Warning, TEXT("%s [ServerSendItems] Cant move items, invalid containers (From: %s, To: %s) (Key: %s)"),
 			*GetDebugPrefix(), *GetNameSafe(Containers.From), *GetNameSafe(Containers.To), *PredictionKey.ToString());
 
-		ClientConfirmPredictionKey(PredictionKey, false);
+		QueueConfirmPredictionKey(PredictionKey, false);
 		return;
 	}
 
@@ -457,10 +945,10 @@ void UGameItemControllerComponent::ServerSendItems_Implementation(
 		Containers.From->RemoveItem(Item);
 	}
 
-	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerSendItems] Calling ClientConfirmPredictionKey %s (Key: %s)"),
+	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerSendItems] Confirming %s (Key: %s)"),
 		*GetDebugPrefix(), bSuccess ? TEXT("Accepted") : TEXT("Rejected"), *PredictionKey.ToString());
 
-	ClientConfirmPredictionKey(PredictionKey, bSuccess);
+	QueueConfirmPredictionKey(PredictionKey, bSuccess);
 }
 
 void UGameItemControllerComponent::ServerMoveItems_Implementation(
@@ -468,12 +956,20 @@ void UGameItemControllerComponent::ServerMoveItems_Implementation(
 	const FGameItemContainerPair& Containers,
 	FGameItemsPredictionKey PredictionKey)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::ServerMoveItems_Implementation);
+
+	if (!ReceivePredictionKey(PredictionKey) || !ConsumeServerRpcBudget(TEXT("ServerMoveItems"), Moves.Num()))
+	{
+		QueueConfirmPredictionKey(PredictionKey, false);
+		return;
+	}
+
 	if (!Containers.IsValid())
 	{
 		UE_LOG(LogGameItems, Warning, TEXT("%s [ServerMoveItems] Cant move items, invalid containers (From: %s, To: %s) (Key: %s)"),
 			*GetDebugPrefix(), *GetNameSafe(Containers.From), *GetNameSafe(Containers.To), *PredictionKey.ToString());
 
-		ClientConfirmPredictionKey(PredictionKey, false);
+		QueueConfirmPredictionKey(PredictionKey, false);
 		return;
 	}
 
@@ -500,10 +996,115 @@ void UGameItemControllerComponent::ServerMoveItems_Implementation(
 		}
 	}
 
-	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerMoveItems] Calling ClientConfirmPredictionKey %s (Key: %s)"),
+	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerMoveItems] Confirming %s (Key: %s)"),
 		*GetDebugPrefix(), bSuccess ? TEXT("Accepted") : TEXT("Rejected"), *PredictionKey.ToString());
 
-	ClientConfirmPredictionKey(PredictionKey, bSuccess);
+	QueueConfirmPredictionKey(PredictionKey, bSuccess);
+}
+
+void UGameItemControllerComponent::ServerExecuteTransaction_Implementation(
+	const FGameItemContainerTransaction& ReceivedTransaction,
+	FGameItemsPredictionKey PredictionKey)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::ServerExecuteTransaction_Implementation);
+
+	TRACE_GAMEITEMS_OP(EGameItemsTraceOp::TransactionReceived, nullptr, nullptr, INDEX_NONE, ReceivedTransaction.Ops.Num(), PredictionKey.Id);
+
+	// the budget is consumed for all received ops, even redundant ones
+	if (!ReceivePredictionKey(PredictionKey) || !ConsumeServerRpcBudget(TEXT("ServerExecuteTransaction"), ReceivedTransaction.Ops.Num()))
+	{
+		QueueConfirmPredictionKey(PredictionKey, false);
+		return;
+	}
+
+	// clients coalesce ops while recording, but don't trust that they did
+	const FGameItemContainerTransaction Transaction = ReceivedTransaction.GetCoalesced();
+
+	// validate everything up front, so that an invalid transaction is rejected without applying anything
+	if (!CanExecuteTransaction(Transaction))
+	{
+		UE_LOG(LogGameItems, Verbose, TEXT("%s [ServerExecuteTransaction] Rejecting transaction with %d ops (Key: %s)"),
+			*GetDebugPrefix(), Transaction.Ops.Num(), *PredictionKey.ToString());
+
+		QueueConfirmPredictionKey(PredictionKey, false);
+		return;
+	}
+
+	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ServerExecuteTransaction] Executing %d ops (Key: %s)"),
+		*GetDebugPrefix(), Transaction.Ops.Num(), *PredictionKey.ToString());
+
+	const bool bSuccess = ExecuteTransaction(Transaction);
+
+	QueueConfirmPredictionKey(PredictionKey, bSuccess);
+}
+
+void UGameItemControllerComponent::QueueConfirmPredictionKey(const FGameItemsPredictionKey& PredictionKey, bool bAccepted)
+{
+	if (!PredictionKey.IsLocalClientKey())
+	{
+		// not a key that can be batched, send it as is
+		ClientConfirmPredictionKey(PredictionKey, bAccepted);
+		return;
+	}
+
+	QueuedConfirmations.Add(PredictionKey.Id, bAccepted);
+	SetComponentTickEnabled(true);
+}
+
+void UGameItemControllerComponent::FlushPredictionKeyConfirmations()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::FlushPredictionKeyConfirmations);
+
+	if (QueuedConfirmations.IsEmpty())
+	{
+		return;
+	}
+
+	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [%hs] Confirming %d keys"),
+		*GetDebugPrefix(), __func__, QueuedConfirmations.Num());
+
+	// keys are usually sequential, so they fit in a single set of confirmations,
+	// but start a new one whenever keys are too far apart (e.g. when ids wrap around)
+	QueuedConfirmations.KeySort(TLess<int32>());
+
+	FGameItemsPredictionKeyConfirmations Confirmations;
+	for (const auto& Elem : QueuedConfirmations)
+	{
+		FGameItemsPredictionKey PredictionKey;
+		PredictionKey.Id = Elem.Key;
+		if (!Confirmations.Add(PredictionKey, Elem.Value))
+		{
+			ClientConfirmPredictionKeys(Confirmations);
+			Confirmations.Reset();
+			verify(Confirmations.Add(PredictionKey, Elem.Value));
+		}
+	}
+	ClientConfirmPredictionKeys(Confirmations);
+
+	QueuedConfirmations.Reset();
+}
+
+void UGameItemControllerComponent::ClientConfirmPredictionKeys_Implementation(const FGameItemsPredictionKeyConfirmations& Confirmations)
+{
+	TArray<TPair<FGameItemsPredictionKey, bool>> KeyConfirmations;
+	Confirmations.GetConfirmations(KeyConfirmations);
+
+	for (const TPair<FGameItemsPredictionKey, bool>& KeyConfirmation : KeyConfirmations)
+	{
+		ClientConfirmPredictionKey_Implementation(KeyConfirmation.Key, KeyConfirmation.Value);
+	}
+}
+
+void UGameItemControllerComponent::ClientConfirmItemMoves_Implementation(
+	const FGameItemsPredictionKey& PredictionKey,
+	const FGameItemMoveResult& Result)
+{
+	UE_CLOG(!Result.WasSuccessful(), LogGameItems, Verbose, TEXT("%s [ClientConfirmItemMoves]: %s, %d failed moves (Key: %s)"),
+		*GetDebugPrefix(), *UEnum::GetValueAsString(Result.Code), Result.FailedMoveIndices.Num(), *PredictionKey.ToString());
+
+	ClientConfirmPredictionKey_Implementation(PredictionKey, Result.WasSuccessful());
+
+	OnMoveResultEvent.Broadcast(PredictionKey, Result);
 }
 
 void UGameItemControllerComponent::ClientConfirmPredictionKey_Implementation(
@@ -515,11 +1116,116 @@ void UGameItemControllerComponent::ClientConfirmPredictionKey_Implementation(
 		return;
 	}
 
+	if (!PredictionKeyGenerator.Acknowledge(PredictionKey))
+	{
+		// already expired and rejected locally, the server state will be replicated as usual
+		UE_LOG(LogGameItems, Verbose, TEXT("%s [ClientConfirmPredictionKey]: Ignoring confirmation of expired key (Key: %s)"),
+			*GetDebugPrefix(), *PredictionKey.ToString());
+		return;
+	}
+
 	UE_LOG(LogGameItems, VeryVerbose, TEXT("%s [ClientConfirmPredictionKey]: %s (Key: %s)"),
 		*GetDebugPrefix(), bAccepted ? TEXT("Accepted") : TEXT("Rejected"), *PredictionKey.ToString());
 
+	ApplyPredictionKeyConfirmation(PredictionKey, bAccepted);
+}
+
+FGameItemsPredictionKey UGameItemControllerComponent::CreatePredictionKey()
+{
+	// must be generated on clients, never the authority
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		return FGameItemsPredictionKey();
+	}
+
+	const FGameItemsPredictionKey NewKey = PredictionKeyGenerator.CreateKey(GetWorld()->GetRealTimeSeconds());
+
+	if (PredictionKeyGenerator.NumPendingKeys() > GetDefault<UGameItemSettings>()->PredictionKeyWindowSize)
+	{
+		// make room in the window now, rather than waiting for the timer
+		ExpirePredictionKeys();
+	}
+
+	if (!ExpirePredictionKeysTimer.IsValid())
+	{
+		GetWorld()->GetTimerManager().SetTimer(ExpirePredictionKeysTimer, this, &UGameItemControllerComponent::ExpirePredictionKeys, 1.f, true);
+	}
+
+	return NewKey;
+}
+
+bool UGameItemControllerComponent::ConsumeServerRpcBudget(const TCHAR* FuncName, int32 Cost) const
+{
+	UGameItemSubsystem* ItemSubsystem = UGameItemSubsystem::Get(this);
+	return !ItemSubsystem || ItemSubsystem->ConsumeRpcBudget(GetOwner()->GetNetConnection(), Cost, FuncName);
+}
+
+bool UGameItemControllerComponent::ReceivePredictionKey(const FGameItemsPredictionKey& PredictionKey)
+{
+	// client keys always increase, so anything that falls behind the window
+	// is a key the client can no longer be waiting on
+	const int32 WindowSize = GetDefault<UGameItemSettings>()->PredictionKeyWindowSize;
+	if (!PredictionKey.IsLocalClientKey() || PredictionKey.Id <= HighestReceivedKeyId - WindowSize)
+	{
+		UE_LOG(LogGameItems, Warning, TEXT("%s [%hs] Rejecting prediction key outside of window (Key: %s, Highest: %d)"),
+			*GetDebugPrefix(), __func__, *PredictionKey.ToString(), HighestReceivedKeyId);
+		return false;
+	}
+
+	HighestReceivedKeyId = FMath::Max(HighestReceivedKeyId, PredictionKey.Id);
+	return true;
+}
+
+void UGameItemControllerComponent::ExpirePredictionKeys()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::ExpirePredictionKeys);
+
+	const UGameItemSettings* Settings = GetDefault<UGameItemSettings>();
+
+	TArray<FGameItemsPredictionKey> ExpiredKeys;
+	PredictionKeyGenerator.ExpireKeys(GetWorld()->GetRealTimeSeconds(), Settings->PredictionKeyTimeout, Settings->PredictionKeyWindowSize, ExpiredKeys);
+
+	for (const FGameItemsPredictionKey& PredictionKey : ExpiredKeys)
+	{
+		UE_LOG(LogGameItems, Warning, TEXT("%s [%hs] Prediction key was never confirmed, rejecting (Key: %s)"),
+			*GetDebugPrefix(), __func__, *PredictionKey.ToString());
+
+		TRACE_GAMEITEMS_OP(EGameItemsTraceOp::PredictionExpired, nullptr, nullptr, INDEX_NONE, 0, PredictionKey.Id);
+		ApplyPredictionKeyConfirmation(PredictionKey, false);
+	}
+
+	if (PredictionKeyGenerator.NumPendingKeys() == 0)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(ExpirePredictionKeysTimer);
+	}
+}
+
+void UGameItemControllerComponent::ApplyPredictionKeyConfirmation(const FGameItemsPredictionKey& PredictionKey, bool bAccepted)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemControllerComponent::ApplyPredictionKeyConfirmation);
+
+	if (const FGameItemContainerTransaction* Transaction = PendingTransactions.Find(PredictionKey))
+	{
+		// update every container involved in the transaction
+		TArray<UGameItemContainer*> AffectedContainers;
+		for (const FGameItemContainerOp& Op : Transaction->Ops)
+		{
+			if (Op.Container)
+			{
+				AffectedContainers.AddUnique(Op.Container);
+			}
+		}
+		for (UGameItemContainer* Container : AffectedContainers)
+		{
+			Container->ConfirmPredictionKey(PredictionKey, bAccepted);
+		}
+
+		PendingTransactions.Remove(PredictionKey);
+		return;
+	}
+
 	const FGameItemContainerPair* AffectedPair = PredictionContainerMap.Find(PredictionKey);
-	if (!ensure(AffectedPair))
+	if (!AffectedPair)
 	{
 		return;
 	}
@@ -4,6 +4,7 @@
 #include "GameItemDef.h"
 
 #include "GameItem.h"
+#include "GameItemSet.h"
 
 #if WITH_EDITOR
 #include "Fragments/GameItemFragment_UIData.h"
@@ -42,4 +43,15 @@ TOptional<FSlateBrush> UGameItemDef::GetEditorIcon() const
 	const UGameItemFragment_UIData* UIData = FindFragment<UGameItemFragment_UIData>();
 	return (UIData && UIData->Icon) ? UIData->Icon->Brush : TOptional<FSlateBrush>();
 }
+
+void UGameItemDef::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// drop rules fragments may have been added or removed
+	if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UGameItemDef, Fragments))
+	{
+		UGameItemSet::InvalidateAllSelectionCaches();
+	}
+}
 #endif
@@ -9,6 +9,7 @@
 #include "GameItemDef.h"
 #include "GameItemsModule.h"
 #include "GameItemSubsystem.h"
+#include "DropTable/GameItemSetEntrySelector.h"
 #include "AssetRegistry/AssetData.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "AssetRegistry/IAssetRegistry.h"
@@ -168,12 +169,31 @@ void UGameItemSet::AddToDefaultContainers(TScriptInterface<IGameItemContainerInt
 }
 
 
+std::atomic<uint32> UGameItemSet::SelectionDataVersion = 1;
+
+FGameItemSetSelectionCache& UGameItemSet::GetSelectionCache(const UGameItemSetEntrySelector* Selector) const
+{
+	return SelectionCache.FindOrAdd(Selector);
+}
+
+void UGameItemSet::InvalidateSelectionCache()
+{
+	SelectionCache.Reset();
+}
+
+void UGameItemSet::InvalidateAllSelectionCaches()
+{
+	SelectionDataVersion.fetch_add(1);
+}
+
+
 #if WITH_EDITOR
 void UGameItemSet::PreSave(FObjectPreSaveContext SaveContext)
 {
 	if (AutoFillRule)
 	{
 		AutoFillRule->FillSet(this);
+		InvalidateSelectionCache();
 	}
 
 	Super::PreSave(SaveContext);
@@ -183,6 +203,8 @@ void UGameItemSet::PostEditChangeChainProperty(FPropertyChangedChainEvent& Prope
 {
 	Super::PostEditChangeChainProperty(PropertyChangedEvent);
 
+	InvalidateSelectionCache();
+
 	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UGameItemSet, AutoFillRule))
 	{
 		if (AutoFillRule)
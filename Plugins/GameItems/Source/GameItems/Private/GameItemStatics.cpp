@@ -10,6 +10,7 @@
 #include "UnrealEngine.h"
 #include "WorldConditionContext.h"
 #include "Algo/Accumulate.h"
+#include "Conditions/GameItemConditionCache.h"
 #include "Conditions/GameItemConditionSchema.h"
 #include "DropTable/GameItemDropContent.h"
 #include "Engine/Engine.h"
@@ -74,12 +75,11 @@ bool UGameItemStatics::IsEquipmentConditionMet(UGameItem* Item)
 	const UGameItemDef* ItemDefCDO = Item->GetItemDefCDO();
 	const UGameItemFragment_Equipment* EquipFrag = ItemDefCDO->FindFragment<UGameItemFragment_Equipment>();
 
-	// setup condition context
 	const UGameItemConditionSchema* DefaultSchema = GetDefault<UGameItemConditionSchema>();
-	FWorldConditionContextData ContextData(*DefaultSchema);
-	ContextData.SetContextData(DefaultSchema->GetTargetItemRef(), Item);
-
-	return EvaluateWorldCondition(ItemDefCDO, EquipFrag->Condition, ContextData);
+	return FGameItemConditionCache::Get().Evaluate(*EquipFrag, EquipFrag->Condition, *DefaultSchema, [&](FWorldConditionContextData& ContextData)
+	{
+		ContextData.SetContextData(DefaultSchema->GetTargetItemRef(), Item);
+	});
 }
 
 bool UGameItemStatics::IsDropConditionMet(TSubclassOf<UGameItemDef> ItemDef, AActor* TargetActor)
@@ -92,24 +92,32 @@ bool UGameItemStatics::IsDropConditionMet(TSubclassOf<UGameItemDef> ItemDef, AAc
 	const UGameItemDef* ItemDefCDO = GetDefault<UGameItemDef>(ItemDef);
 	const UGameItemFragment_DropRules* DropRulesFrag = ItemDefCDO->FindFragment<UGameItemFragment_DropRules>();
 
-	// setup condition context
 	const UGameItemConditionSchema* DefaultSchema = GetDefault<UGameItemConditionSchema>();
-	FWorldConditionContextData ContextData(*DefaultSchema);
-	ContextData.SetContextData(DefaultSchema->GetTargetActorRef(), TargetActor);
-
-	return EvaluateWorldCondition(ItemDefCDO, DropRulesFrag->Condition, ContextData);
+	return FGameItemConditionCache::Get().Evaluate(*DropRulesFrag, DropRulesFrag->Condition, *DefaultSchema, [&](FWorldConditionContextData& ContextData)
+	{
+		ContextData.SetContextData(DefaultSchema->GetTargetActorRef(), TargetActor);
+	});
 }
 
 void UGameItemStatics::SelectItemsFromDropTableRow(const FGameItemDropContext& Context, const FGameItemDropTableRow& DropTableRow,
                                                    TArray<FGameItemDefStack>& OutItems)
 {
-	if (const FGameItemDropContent* ContentPtr = DropTableRow.Content.GetPtr<FGameItemDropContent>())
+	if (FGameItemDropProgram::IsEnabled())
+	{
+		DropTableRow.GetProgram()->Execute(Context, OutItems);
+	}
+	else if (const FGameItemDropContent* ContentPtr = DropTableRow.Content.GetPtr<FGameItemDropContent>())
 	{
 		ContentPtr->CheckAndSelectItems(Context, OutItems);
 	}
 }
 
 int32 UGameItemStatics::GetWeightedRandomArrayIndex(const TArray<float>& Probabilities)
+{
+	return GetWeightedRandomArrayIndexFromStream(Probabilities, FRandomStream(FMath::Rand()));
+}
+
+int32 UGameItemStatics::GetWeightedRandomArrayIndexFromStream(const TArray<float>& Probabilities, const FRandomStream& RandomStream)
 {
 	if (Probabilities.IsEmpty())
 	{
@@ -117,7 +125,7 @@ int32 UGameItemStatics::GetWeightedRandomArrayIndex(const TArray<float>& Probabi
 	}
 
 	const float Total = Algo::Accumulate(Probabilities, 0.f);
-	const float Value = FMath::FRand() * Total;
+	const float Value = RandomStream.FRand() * Total;
 
 	float Current = 0.f;
 	for (int32 Idx = 0; Idx < Probabilities.Num(); ++Idx)
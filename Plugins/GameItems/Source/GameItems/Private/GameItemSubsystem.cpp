@@ -9,14 +9,18 @@
 #include "GameItemContainerComponent.h"
 #include "GameItemContainerComponentInterface.h"
 #include "GameItemContainerInterface.h"
+#include "GameItemControllerComponent.h"
 #include "GameItemDef.h"
+#include "GameItemSettings.h"
 #include "GameItemsModule.h"
+#include "GameItemsTrace.h"
 #include "GameItemStatics.h"
 #include "DropTable/GameItemDropTableRow.h"
 #include "Engine/Canvas.h"
 #include "Engine/DataTable.h"
 #include "Engine/Engine.h"
 #include "Engine/GameInstance.h"
+#include "Engine/NetConnection.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/HUD.h"
 #include "Serialization/MemoryReader.h"
@@ -25,6 +29,9 @@
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GameItemSubsystem)
 
+DECLARE_CYCLE_STAT(TEXT("MoveItem"), STAT_GameItems_MoveItem, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("SelectItemsFromDropTable"), STAT_GameItems_SelectItemsFromDropTable, STATGROUP_GameItems);
+
 
 void UGameItemSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
@@ -34,6 +41,15 @@ void UGameItemSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 void UGameItemSubsystem::Deinitialize()
 {
 	AHUD::OnShowDebugInfo.RemoveAll(this);
+
+	for (const auto& Elem : PreloadedDropTables)
+	{
+		if (Elem.Value.IsValid())
+		{
+			Elem.Value->ReleaseHandle();
+		}
+	}
+	PreloadedDropTables.Empty();
 }
 
 bool UGameItemSubsystem::ShouldCreateSubsystem(UObject* Outer) const
@@ -47,6 +63,9 @@ bool UGameItemSubsystem::ShouldCreateSubsystem(UObject* Outer) const
 
 UGameItem* UGameItemSubsystem::CreateItem(UObject* Outer, TSubclassOf<UGameItemDef> ItemDef, int32 Count)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::CreateItem);
+	LLM_SCOPE_BYTAG(GameItems);
+
 	if (!ItemDef)
 	{
 		return nullptr;
@@ -72,11 +91,16 @@ UGameItem* UGameItemSubsystem::CreateItem(UObject* Outer, TSubclassOf<UGameItemD
 		}
 	}
 
+	TRACE_GAMEITEMS_OP(EGameItemsTraceOp::ItemCreated, NewItem, nullptr, INDEX_NONE, Count, 0);
+
 	return NewItem;
 }
 
 UGameItem* UGameItemSubsystem::CreateItemFromSaveData(UObject* Outer, const FGameItemSaveData& ItemSaveData)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::CreateItemFromSaveData);
+	LLM_SCOPE_BYTAG(GameItems);
+
 	const TSubclassOf<UGameItemDef> ItemDef = ItemSaveData.ItemDef.LoadSynchronous();
 	if (!ItemDef)
 	{
@@ -99,6 +123,8 @@ UGameItem* UGameItemSubsystem::CreateItemFromSaveData(UObject* Outer, const FGam
 
 void UGameItemSubsystem::CreateItemInContainer(UGameItemContainer* Container, TSubclassOf<UGameItemDef> ItemDef, int32 Count, bool bWarn)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::CreateItemInContainer);
+
 	if (!Container || !Container->GetItemOuter())
 	{
 		return;
@@ -119,6 +145,8 @@ void UGameItemSubsystem::CreateItemInContainer(UGameItemContainer* Container, TS
 
 bool UGameItemSubsystem::HasItemStacks(UGameItemContainer* Container, TArray<FGameItemDefStack> ItemStacks) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::HasItemStacks);
+
 	for (const FGameItemDefStack& ItemStack : ItemStacks)
 	{
 		if (Container->GetTotalItemCountByDef(ItemStack.ItemDef) < ItemStack.Count)
@@ -131,6 +159,8 @@ bool UGameItemSubsystem::HasItemStacks(UGameItemContainer* Container, TArray<FGa
 
 bool UGameItemSubsystem::RemoveItemStacks(UGameItemContainer* Container, TArray<FGameItemDefStack> ItemStacks, bool bAllowPartial) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::RemoveItemStacks);
+
 	if (!bAllowPartial)
 	{
 		if (!HasItemStacks(Container, ItemStacks))
@@ -149,6 +179,9 @@ bool UGameItemSubsystem::RemoveItemStacks(UGameItemContainer* Container, TArray<
 
 UGameItem* UGameItemSubsystem::DuplicateItem(UObject* Outer, UGameItem* Item)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::DuplicateItem);
+	LLM_SCOPE_BYTAG(GameItems);
+
 	if (!Item)
 	{
 		return nullptr;
@@ -166,6 +199,9 @@ UGameItem* UGameItemSubsystem::DuplicateItem(UObject* Outer, UGameItem* Item)
 
 UGameItem* UGameItemSubsystem::SplitItem(UObject* Outer, UGameItem* Item, int32 Count)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::SplitItem);
+	LLM_SCOPE_BYTAG(GameItems);
+
 	if (!Item || Item->GetCount() <= Count)
 	{
 		return nullptr;
@@ -179,6 +215,9 @@ UGameItem* UGameItemSubsystem::SplitItem(UObject* Outer, UGameItem* Item, int32
 
 void UGameItemSubsystem::MoveItem(UGameItemContainer* FromContainer, UGameItemContainer* ToContainer, UGameItem* Item, int32 TargetSlot, bool bAllowPartial)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::MoveItem);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_MoveItem);
+
 	if (!FromContainer || !ToContainer || !FromContainer->Contains(Item))
 	{
 		return;
@@ -203,6 +242,8 @@ void UGameItemSubsystem::MoveItem(UGameItemContainer* FromContainer, UGameItemCo
 		return;
 	}
 
+	TRACE_GAMEITEMS_OP(EGameItemsTraceOp::ItemMoved, Item, ToContainer, TargetSlot, Plan.DeltaCount, 0);
+
 	// split the item if needed
 	UGameItem* ItemToAdd = Item;
 	if (Plan.RemainderCount > 0)
@@ -227,6 +268,8 @@ void UGameItemSubsystem::MoveItems(
 	TArray<UGameItem*> Items,
 	bool bAllowPartial)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::MoveItems);
+
 	for (UGameItem* Item : Items)
 	{
 		MoveItem(FromContainer, ToContainer, Item, -1, bAllowPartial);
@@ -235,6 +278,8 @@ void UGameItemSubsystem::MoveItems(
 
 void UGameItemSubsystem::MoveAllItems(UGameItemContainer* FromContainer, UGameItemContainer* ToContainer, bool bAllowPartial)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::MoveAllItems);
+
 	if (!FromContainer)
 	{
 		return;
@@ -249,6 +294,8 @@ void UGameItemSubsystem::MoveAllItems(UGameItemContainer* FromContainer, UGameIt
 
 bool UGameItemSubsystem::MoveSwapOrStackItem(UGameItemContainer* From, UGameItem* Item, UGameItemContainer* To, int32 ToSlot, bool bAllowPartial)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::MoveSwapOrStackItem);
+
 	if (!From || !To)
 	{
 		UE_LOG(LogGameItems, Warning, TEXT("[%hs] Invalid container. From: %s, To: %s"),
@@ -326,6 +373,9 @@ bool UGameItemSubsystem::MoveSwapOrStackItem(UGameItemContainer* From, UGameItem
 
 TArray<FGameItemDefStack> UGameItemSubsystem::SelectItemsFromDropTable(const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::SelectItemsFromDropTable);
+	SCOPE_CYCLE_COUNTER(STAT_GameItems_SelectItemsFromDropTable);
+
 	static FString ContextString(TEXT("UGameItemSubsystem::SelectItemsFromDropTable"));
 	const FGameItemDropTableRow* Row = DropTableEntry.GetRow<FGameItemDropTableRow>(ContextString);
 	if (!Row)
@@ -340,6 +390,8 @@ TArray<FGameItemDefStack> UGameItemSubsystem::SelectItemsFromDropTable(const FGa
 
 TArray<UGameItem*> UGameItemSubsystem::CreateItemsFromDropTable(UObject* Outer, const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::CreateItemsFromDropTable);
+
 	TArray<FGameItemDefStack> Stacks = SelectItemsFromDropTable(Context, DropTableEntry);
 
 	TArray<UGameItem*> Result;
@@ -353,6 +405,133 @@ TArray<UGameItem*> UGameItemSubsystem::CreateItemsFromDropTable(UObject* Outer,
 	return Result;
 }
 
+TSharedPtr<FStreamableHandle> UGameItemSubsystem::SelectItemsFromDropTableAsync(const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry,
+                                                                              FGameItemDropItemsSelectedDelegate OnComplete)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::SelectItemsFromDropTableAsync);
+
+	static FString ContextString(TEXT("UGameItemSubsystem::SelectItemsFromDropTableAsync"));
+	const FGameItemDropTableRow* Row = DropTableEntry.GetRow<FGameItemDropTableRow>(ContextString);
+	if (!Row)
+	{
+		OnComplete.ExecuteIfBound(TArray<FGameItemDefStack>());
+		return nullptr;
+	}
+
+	TArray<FSoftObjectPath> Paths;
+	GetUnloadedDropTableReferences(*Row, Paths);
+	if (Paths.IsEmpty())
+	{
+		OnComplete.ExecuteIfBound(SelectItemsFromDropTable(Context, DropTableEntry));
+		return nullptr;
+	}
+
+	// the target actor and drop table may be destroyed while loading
+	TWeakObjectPtr<AActor> WeakTargetActor = Context.TargetActor;
+	TWeakObjectPtr<const UDataTable> WeakDropTable = DropTableEntry.DataTable;
+	FGameItemDropContext ContextCopy = Context;
+	ContextCopy.TargetActor = nullptr;
+
+	return StreamableManager.RequestAsyncLoad(MoveTemp(Paths), FStreamableDelegate::CreateWeakLambda(this,
+		[this, ContextCopy = MoveTemp(ContextCopy), WeakTargetActor, WeakDropTable, RowName = DropTableEntry.RowName, OnComplete]() mutable
+		{
+			FDataTableRowHandle LoadedDropTableEntry;
+			LoadedDropTableEntry.DataTable = WeakDropTable.Get();
+			LoadedDropTableEntry.RowName = RowName;
+			if (LoadedDropTableEntry.IsNull())
+			{
+				OnComplete.ExecuteIfBound(TArray<FGameItemDefStack>());
+				return;
+			}
+
+			ContextCopy.TargetActor = WeakTargetActor.Get();
+			OnComplete.ExecuteIfBound(SelectItemsFromDropTable(ContextCopy, LoadedDropTableEntry));
+		}), FStreamableManager::AsyncLoadHighPriority);
+}
+
+TSharedPtr<FStreamableHandle> UGameItemSubsystem::CreateItemsFromDropTableAsync(UObject* Outer, const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry,
+                                                                              FGameItemDropItemsCreatedDelegate OnComplete)
+{
+	TWeakObjectPtr<UObject> WeakOuter = Outer;
+	return SelectItemsFromDropTableAsync(Context, DropTableEntry, FGameItemDropItemsSelectedDelegate::CreateWeakLambda(this,
+		[this, WeakOuter, OnComplete](const TArray<FGameItemDefStack>& Stacks)
+		{
+			TArray<UGameItem*> Result;
+			if (UObject* Outer = WeakOuter.Get())
+			{
+				for (const FGameItemDefStack& Stack : Stacks)
+				{
+					if (UGameItem* NewItem = CreateItem(Outer, Stack.ItemDef, Stack.Count))
+					{
+						Result.Add(NewItem);
+					}
+				}
+			}
+			OnComplete.ExecuteIfBound(Result);
+		}));
+}
+
+void UGameItemSubsystem::PreloadDropTable(const UDataTable* DropTable)
+{
+	if (!DropTable || !DropTable->GetRowStruct() || !DropTable->GetRowStruct()->IsChildOf(FGameItemDropTableRow::StaticStruct()))
+	{
+		return;
+	}
+
+	if (PreloadedDropTables.Contains(DropTable))
+	{
+		return;
+	}
+
+	// gather from all rows at once, so that rows included by other rows are only visited once
+	TArray<FSoftObjectPath> Paths;
+	TSet<const FGameItemDropTableRow*> VisitedRows;
+	DropTable->ForeachRow<FGameItemDropTableRow>(TEXT("UGameItemSubsystem::PreloadDropTable"), [&](const FName& Key, const FGameItemDropTableRow& Row)
+	{
+		Row.GatherSoftReferences(Paths, VisitedRows);
+	});
+
+	// already loaded references are included too, so that they stay loaded
+	TSharedPtr<FStreamableHandle> Handle;
+	if (!Paths.IsEmpty())
+	{
+		Handle = StreamableManager.RequestAsyncLoad(MoveTemp(Paths), FStreamableDelegate(), FStreamableManager::DefaultAsyncLoadPriority);
+	}
+	PreloadedDropTables.Add(DropTable, Handle);
+}
+
+void UGameItemSubsystem::ReleasePreloadedDropTable(const UDataTable* DropTable)
+{
+	TSharedPtr<FStreamableHandle> Handle;
+	if (PreloadedDropTables.RemoveAndCopyValue(DropTable, Handle) && Handle.IsValid())
+	{
+		Handle->ReleaseHandle();
+	}
+}
+
+bool UGameItemSubsystem::IsDropTableLoaded(FDataTableRowHandle DropTableEntry) const
+{
+	static FString ContextString(TEXT("UGameItemSubsystem::IsDropTableLoaded"));
+	const FGameItemDropTableRow* Row = DropTableEntry.GetRow<FGameItemDropTableRow>(ContextString);
+	if (!Row)
+	{
+		return false;
+	}
+
+	TArray<FSoftObjectPath> Paths;
+	GetUnloadedDropTableReferences(*Row, Paths);
+	return Paths.IsEmpty();
+}
+
+void UGameItemSubsystem::GetUnloadedDropTableReferences(const FGameItemDropTableRow& Row, TArray<FSoftObjectPath>& OutPaths)
+{
+	Row.GatherSoftReferences(OutPaths);
+	OutPaths.RemoveAll([](const FSoftObjectPath& Path)
+	{
+		return Path.ResolveObject() != nullptr;
+	});
+}
+
 const UGameItemFragment* UGameItemSubsystem::FindFragment(TSubclassOf<UGameItemDef> ItemDef, TSubclassOf<UGameItemFragment> FragmentClass) const
 {
 	return UGameItemStatics::FindFragment(ItemDef, FragmentClass);
@@ -374,6 +553,8 @@ UGameItemContainerComponent* UGameItemSubsystem::GetContainerComponentForActor(c
 
 TArray<UGameItemContainer*> UGameItemSubsystem::GetAllContainersForActor(const AActor* Actor) const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UGameItemSubsystem::GetAllContainersForActor);
+
 	if (const IGameItemContainerInterface* ContainerInterface = GetContainerInterfaceForActor(Actor))
 	{
 		return ContainerInterface->GetAllItemContainers();
@@ -411,6 +592,58 @@ const IGameItemContainerInterface* UGameItemSubsystem::GetContainerInterfaceForA
 	return GetContainerComponentForActor(Actor);
 }
 
+bool UGameItemSubsystem::ConsumeRpcBudget(const UNetConnection* Connection, int32 Cost, const TCHAR* FuncName)
+{
+	const UGameItemSettings* Settings = GetDefault<UGameItemSettings>();
+	if (!Connection || !Settings->bEnableRpcBudget)
+	{
+		return true;
+	}
+
+	const double CurrentTime = FPlatformTime::Seconds();
+
+	// periodically forget about closed connections
+	if (CurrentTime - LastRpcBudgetCleanupTime > 60.0)
+	{
+		LastRpcBudgetCleanupTime = CurrentTime;
+		for (auto It = RpcBudgets.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().ResolveObjectPtr())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	FGameItemsRpcBudget& Budget = RpcBudgets.FindOrAdd(Connection);
+	if (!Budget.TryConsume(FMath::Max(Cost, 1), CurrentTime, Settings->RpcBudgetOpsPerSecond, Settings->RpcBudgetMaxOps))
+	{
+		++NumThrottledRpcs;
+		UE_LOG(LogGameItems, Verbose, TEXT("[%s] Throttled %d ops from %s (Throttled: %d, Allowed: %d)"),
+			FuncName, Cost, *GetNameSafe(Connection), Budget.NumThrottled, Budget.NumAllowed);
+		return false;
+	}
+	return true;
+}
+
+const FGameItemsRpcBudget* UGameItemSubsystem::GetRpcBudget(const UNetConnection* Connection) const
+{
+	return RpcBudgets.Find(Connection);
+}
+
+void UGameItemSubsystem::SetControllerRecording(UGameItemControllerComponent* Controller, bool bIsRecording)
+{
+	RecordingControllers.RemoveAll([Controller](const TWeakObjectPtr<UGameItemControllerComponent>& Other)
+	{
+		return !Other.IsValid() || Other.Get() == Controller;
+	});
+
+	if (bIsRecording && Controller)
+	{
+		RecordingControllers.Add(Controller);
+	}
+}
+
 void UGameItemSubsystem::OnShowDebugInfo(AHUD* HUD, UCanvas* Canvas, const FDebugDisplayInfo& DisplayInfo, float& YL, float& YPos)
 {
 	// showdebug GameItems
@@ -438,6 +671,11 @@ void UGameItemSubsystem::OnShowDebugInfo(AHUD* HUD, UCanvas* Canvas, const FDebu
 
 	DisplayDebugManager.DrawString(FString::Printf(TEXT("GAME ITEMS %s"), *NetSuffix));
 
+	if (NumThrottledRpcs > 0)
+	{
+		DisplayDebugManager.DrawString(FString::Printf(TEXT("Throttled RPCs: %d"), NumThrottledRpcs));
+	}
+
 	// display debug info for all containers of the target actor
 	TArray<UGameItemContainer*> Containers = GetAllContainersForActor(HUD->GetCurrentDebugTargetActor());
 	for (const UGameItemContainer* Container : Containers)
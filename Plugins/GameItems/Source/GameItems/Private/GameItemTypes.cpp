@@ -3,6 +3,7 @@
 #include "GameItemTypes.h"
 
 #include "GameItem.h"
+#include "GameItemContainer.h"
 #include "GameItemContainerDef.h"
 #include "GameItemDef.h"
 #include "GameItemsModule.h"
@@ -148,39 +149,95 @@ FString FGameItemList::FChange::GetDebugString() const
 
 void FGameItemList::PreReplicatedRemove(const TArrayView<int32>& RemovedIndices, int32 FinalSize)
 {
+	const bool bUseOrderedSlots = UsesOrderedSlots();
+
 	// called when any item is removed from a slot,
 	// (even if replaced by another item, since that will be a new entry)
 	for (const int32 Idx : RemovedIndices)
 	{
-		PendingChanges.Emplace(Entries[Idx], true);
-		Entries[Idx].LastKnownSlot = Entries[Idx].Slot;
+		FChange& Change = PendingChanges.Emplace_GetRef(Entries[Idx], true);
+		if (bUseOrderedSlots)
+		{
+			// the order of remaining entries may have already changed, use the slot from the last update
+			Change.Slot = Entries[Idx].LastKnownSlot;
+		}
+		Entries[Idx].LastKnownSlot = Change.Slot;
 	}
+	MarkSlotCacheDirty();
 }
 
 void FGameItemList::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
 {
+	// ordered slots are resolved in PostReplicatedReceive, once all changes are applied
+	const bool bUseOrderedSlots = UsesOrderedSlots();
+
 	for (const int32 Idx : AddedIndices)
 	{
 		// Entry.Item is often null here (before UpdateUnmappedObjects is called),
 		// let the caller ignore it if so
 		PendingChanges.Emplace(Entries[Idx], false);
-		Entries[Idx].LastKnownSlot = Entries[Idx].Slot;
+		if (!bUseOrderedSlots)
+		{
+			Entries[Idx].LastKnownSlot = Entries[Idx].Slot;
+		}
+	}
+	MarkSlotCacheDirty();
+
+	if (FGameItemsNetStats::IsEnabled())
+	{
+		FGameItemsNetStats::Get().RecordItemsReplicated(AddedIndices.Num());
 	}
 }
 
 void FGameItemList::PostReplicatedChange(const TArrayView<int32>& ChangedIndices, int32 FinalSize)
 {
+	const bool bUseOrderedSlots = UsesOrderedSlots();
+
 	for (const int32 Idx : ChangedIndices)
 	{
 		PendingChanges.Emplace(Entries[Idx], false);
-		Entries[Idx].LastKnownSlot = Entries[Idx].Slot;
+		if (!bUseOrderedSlots)
+		{
+			Entries[Idx].LastKnownSlot = Entries[Idx].Slot;
+		}
+	}
+	MarkSlotCacheDirty();
+
+	if (FGameItemsNetStats::IsEnabled())
+	{
+		FGameItemsNetStats::Get().RecordItemsReplicated(ChangedIndices.Num());
 	}
 }
 
 void FGameItemList::PostReplicatedReceive(const FPostReplicatedReceiveParameters& Parameters)
 {
+	MarkSlotCacheDirty();
+
 	if (!PendingChanges.IsEmpty())
 	{
+		if (UsesOrderedSlots())
+		{
+			UpdateSlotCache();
+
+			// resolve the slots of added and changed entries now that removed entries are gone
+			TMap<int32, int32> EntryIndicesByReplicationID;
+			EntryIndicesByReplicationID.Reserve(Entries.Num());
+			for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+			{
+				EntryIndicesByReplicationID.Add(Entries[Idx].ReplicationID, Idx);
+				Entries[Idx].LastKnownSlot = EntrySlots[Idx];
+			}
+
+			for (FChange& Change : PendingChanges)
+			{
+				if (!Change.bIsRemoved)
+				{
+					const int32* EntryIdx = EntryIndicesByReplicationID.Find(Change.ReplicationID);
+					Change.Slot = EntryIdx ? EntrySlots[*EntryIdx] : INDEX_NONE;
+				}
+			}
+		}
+
 		OnPostReplicateChangesEvent.Broadcast(PendingChanges);
 		PendingChanges.Empty();
 	}
@@ -190,10 +247,93 @@ void FGameItemList::PostSerialize(const FArchive& Ar)
 {
 	if (Ar.IsLoading())
 	{
-		// TODO: cache slot -> entry lookup map for fast access
+		MarkSlotCacheDirty();
+	}
+}
+
+void FGameItemList::SetOwningContainer(UGameItemContainer* InContainer)
+{
+	OwningContainer = InContainer;
+	MarkSlotCacheDirty();
+}
+
+bool FGameItemList::UsesOrderedSlots() const
+{
+	// containers with unlimited slots are always collapsed, so slots never have gaps
+	const UGameItemContainerDef* ContainerDefCDO = OwningContainer ? OwningContainer->GetContainerDefCDO() : nullptr;
+	return ContainerDefCDO && !ContainerDefCDO->bLimitSlots;
+}
+
+void FGameItemList::UpdateSlotCache() const
+{
+	if (!bSlotCacheDirty)
+	{
+		return;
+	}
+	bSlotCacheDirty = false;
+	bSlotCacheOrdered = UsesOrderedSlots();
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FGameItemList::UpdateSlotCache);
+
+	EntrySlots.SetNumUninitialized(Entries.Num());
+	EntryIndicesByOrder.Reset();
+	EntryIndicesBySlot.Reset();
+
+	if (bSlotCacheOrdered)
+	{
+		// the slot of each entry is its index when sorted by key
+		EntryIndicesByOrder.SetNumUninitialized(Entries.Num());
+		for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+		{
+			EntryIndicesByOrder[Idx] = Idx;
+		}
+		EntryIndicesByOrder.Sort([this](int32 IdxA, int32 IdxB)
+		{
+			return Entries[IdxA].Slot < Entries[IdxB].Slot;
+		});
+
+		for (int32 Slot = 0; Slot < EntryIndicesByOrder.Num(); ++Slot)
+		{
+			EntrySlots[EntryIndicesByOrder[Slot]] = Slot;
+		}
+	}
+	else
+	{
+		EntryIndicesBySlot.Reserve(Entries.Num());
+		for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+		{
+			EntrySlots[Idx] = Entries[Idx].Slot;
+			ensureAlways(!EntryIndicesBySlot.Contains(Entries[Idx].Slot));
+			EntryIndicesBySlot.Add(Entries[Idx].Slot, Idx);
+		}
 	}
 }
 
+int32 FGameItemList::GetNextOrderKey()
+{
+	UpdateSlotCache();
+
+	if (Entries.IsEmpty())
+	{
+		return 0;
+	}
+
+	const int32 LastKey = Entries[EntryIndicesByOrder.Last()].Slot;
+	if (LastKey < MAX_int32)
+	{
+		return LastKey + 1;
+	}
+
+	// out of keys, reassign them all (this dirties every entry, but should practically never happen)
+	for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+	{
+		Entries[Idx].Slot = EntrySlots[Idx];
+		MarkItemDirty(Entries[Idx]);
+	}
+	MarkSlotCacheDirty();
+	return Entries.Num();
+}
+
 void FGameItemList::AddEntryForSlot(UGameItem* Item, int32 Slot)
 {
 	check(Item != nullptr);
@@ -207,43 +347,89 @@ void FGameItemList::AddEntryForSlot(UGameItem* Item, int32 Slot)
 	}
 #endif
 
-	FGameItemListEntry& NewEntry = Entries.Emplace_GetRef(Item, Slot);
+	const int32 Key = UsesOrderedSlots() ? GetNextOrderKey() : Slot;
+	FGameItemListEntry& NewEntry = Entries.Emplace_GetRef(Item, Key);
 	MarkItemDirty(NewEntry);
+
+	if (!bSlotCacheDirty)
+	{
+		// new entries are always last, and ordered entries have the highest key, so the cache can be updated in place
+		const int32 NewIdx = Entries.Num() - 1;
+		if (bSlotCacheOrdered)
+		{
+			EntrySlots.Add(EntryIndicesByOrder.Num());
+			EntryIndicesByOrder.Add(NewIdx);
+		}
+		else
+		{
+			EntrySlots.Add(Slot);
+			EntryIndicesBySlot.Add(Slot, NewIdx);
+		}
+	}
 }
 
 void FGameItemList::RemoveEntry(UGameItem* Item)
 {
 	check(Item != nullptr);
 
-	for (auto EntryIt = Entries.CreateIterator(); EntryIt; ++EntryIt)
+	for (int32 Idx = Entries.Num() - 1; Idx >= 0; --Idx)
 	{
-		FGameItemListEntry& Entry = *EntryIt;
-		if (Entry.Item == Item)
+		if (Entries[Idx].Item == Item)
 		{
-			// TODO: try RemoveCurrentSwap, see if it's better/works
-			EntryIt.RemoveCurrent();
-			MarkArrayDirty();
+			RemoveEntryAt(Idx);
 		}
 	}
 }
 
-UGameItem* FGameItemList::RemoveEntryForSlot(int32 Slot, bool bCollapseSlots)
+void FGameItemList::RemoveEntryAt(int32 EntryIdx)
 {
-	UGameItem* RemovedItem = nullptr;
-	for (auto EntryIt = Entries.CreateIterator(); EntryIt; ++EntryIt)
+	Entries.RemoveAt(EntryIdx);
+	MarkArrayDirty();
+
+	if (bSlotCacheDirty)
+	{
+		return;
+	}
+
+	// later entries move down one index
+	const int32 RemovedSlot = EntrySlots[EntryIdx];
+	EntrySlots.RemoveAt(EntryIdx);
+	if (bSlotCacheOrdered)
+	{
+		// and ordered entries after the removed one move down one slot
+		EntryIndicesByOrder.RemoveAt(RemovedSlot);
+		for (int32& EntrySlot : EntrySlots)
+		{
+			EntrySlot -= EntrySlot > RemovedSlot ? 1 : 0;
+		}
+		for (int32& Idx : EntryIndicesByOrder)
+		{
+			Idx -= Idx > EntryIdx ? 1 : 0;
+		}
+	}
+	else
 	{
-		FGameItemListEntry& Entry = *EntryIt;
-		if (Entry.Slot == Slot)
+		EntryIndicesBySlot.Remove(RemovedSlot);
+		for (auto& Elem : EntryIndicesBySlot)
 		{
-			RemovedItem = Entry.Item;
-			EntryIt.RemoveCurrent();
-			MarkArrayDirty();
-			break;
+			Elem.Value -= Elem.Value > EntryIdx ? 1 : 0;
 		}
 	}
+}
 
-	// remove gaps if desired, done in a second pass to avoid false positives
-	if (bCollapseSlots)
+UGameItem* FGameItemList::RemoveEntryForSlot(int32 Slot, bool bCollapseSlots)
+{
+	const int32 EntryIdx = FindEntryIndexForSlot(Slot);
+	if (EntryIdx == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	UGameItem* RemovedItem = Entries[EntryIdx].Item;
+	RemoveEntryAt(EntryIdx);
+
+	// remove gaps if desired, ordered slots don't need this since the remaining entries keep their order
+	if (bCollapseSlots && !UsesOrderedSlots())
 	{
 		for (auto EntryIt = Entries.CreateIterator(); EntryIt; ++EntryIt)
 		{
@@ -253,42 +439,52 @@ UGameItem* FGameItemList::RemoveEntryForSlot(int32 Slot, bool bCollapseSlots)
 				// if higher slot, drop down by 1
 				Entry.Slot -= 1;
 				MarkItemDirty(Entry);
+				MarkSlotCacheDirty();
 			}
 		}
 	}
 	return RemovedItem;
 }
 
-UGameItem* FGameItemList::GetItemInSlot(int32 Slot) const
+int32 FGameItemList::FindEntryIndexForSlot(int32 Slot) const
 {
-	// TODO: cache
-	for (const FGameItemListEntry& Entry : Entries)
+	UpdateSlotCache();
+
+	if (bSlotCacheOrdered)
 	{
-		if (Entry.Slot == Slot)
-		{
-			return Entry.Item;
-		}
+		return EntryIndicesByOrder.IsValidIndex(Slot) ? EntryIndicesByOrder[Slot] : INDEX_NONE;
 	}
-	return nullptr;
+
+	const int32* EntryIdx = EntryIndicesBySlot.Find(Slot);
+	return EntryIdx ? *EntryIdx : INDEX_NONE;
+}
+
+UGameItem* FGameItemList::GetItemInSlot(int32 Slot) const
+{
+	const int32 EntryIdx = FindEntryIndexForSlot(Slot);
+	return EntryIdx != INDEX_NONE ? Entries[EntryIdx].Item : nullptr;
 }
 
 bool FGameItemList::HasItemInSlot(int32 Slot) const
 {
-	// TODO: cache
-	for (const FGameItemListEntry& Entry : Entries)
-	{
-		if (Entry.Slot == Slot && ensureAlways(Entry.Item))
-		{
-			return true;
-		}
-	}
-	return false;
+	const int32 EntryIdx = FindEntryIndexForSlot(Slot);
+	return EntryIdx != INDEX_NONE && ensureAlways(Entries[EntryIdx].Item);
+}
+
+int32 FGameItemList::GetEntrySlot(const FGameItemListEntry& Entry) const
+{
+	const int32 EntryIdx = UE_PTRDIFF_TO_INT32(&Entry - Entries.GetData());
+	check(Entries.IsValidIndex(EntryIdx));
+
+	UpdateSlotCache();
+	return EntrySlots[EntryIdx];
 }
 
 void FGameItemList::Reset()
 {
 	Entries.Reset();
 	MarkArrayDirty();
+	MarkSlotCacheDirty();
 }
 
 bool FGameItemList::SwapEntries(int32 SlotA, int32 SlotB)
@@ -296,46 +492,88 @@ bool FGameItemList::SwapEntries(int32 SlotA, int32 SlotB)
 	check(SlotA >= 0);
 	check(SlotB >= 0);
 
-	bool bDidChange = false;
-	for (auto EntryIt = Entries.CreateIterator(); EntryIt; ++EntryIt)
+	const int32 EntryIdxA = FindEntryIndexForSlot(SlotA);
+	const int32 EntryIdxB = FindEntryIndexForSlot(SlotB);
+	if (EntryIdxA == INDEX_NONE && EntryIdxB == INDEX_NONE)
+	{
+		return false;
+	}
+
+	if (bSlotCacheOrdered)
 	{
-		FGameItemListEntry& Entry = *EntryIt;
-		if (Entry.Slot == SlotA)
+		if (EntryIdxA != INDEX_NONE && EntryIdxB != INDEX_NONE)
 		{
-			Entry.Slot = SlotB;
-			MarkItemDirty(Entry);
-			bDidChange = true;
+			Swap(Entries[EntryIdxA].Slot, Entries[EntryIdxB].Slot);
+			MarkItemDirty(Entries[EntryIdxA]);
+			MarkItemDirty(Entries[EntryIdxB]);
+
+			Swap(EntryIndicesByOrder[SlotA], EntryIndicesByOrder[SlotB]);
+			EntrySlots[EntryIdxA] = SlotB;
+			EntrySlots[EntryIdxB] = SlotA;
+			return true;
 		}
-		else if (Entry.Slot == SlotB)
+
+		// ordered slots have no gaps, so moving to an empty slot moves the entry to the end
+		const int32 EntryIdx = EntryIdxA != INDEX_NONE ? EntryIdxA : EntryIdxB;
+		const int32 FromSlot = EntrySlots[EntryIdx];
+		if (FromSlot == Entries.Num() - 1)
 		{
-			Entry.Slot = SlotA;
-			MarkItemDirty(Entry);
-			bDidChange = true;
+			return false;
+		}
+
+		const int32 Key = GetNextOrderKey();
+		Entries[EntryIdx].Slot = Key;
+		MarkItemDirty(Entries[EntryIdx]);
+
+		if (!bSlotCacheDirty)
+		{
+			// only the entries after the moved one shift down
+			EntryIndicesByOrder.RemoveAt(FromSlot);
+			EntryIndicesByOrder.Add(EntryIdx);
+			for (int32 Slot = FromSlot; Slot < EntryIndicesByOrder.Num(); ++Slot)
+			{
+				EntrySlots[EntryIndicesByOrder[Slot]] = Slot;
+			}
 		}
+		return true;
 	}
-	return bDidChange;
+
+	EntryIndicesBySlot.Remove(SlotA);
+	EntryIndicesBySlot.Remove(SlotB);
+	if (EntryIdxA != INDEX_NONE)
+	{
+		Entries[EntryIdxA].Slot = SlotB;
+		MarkItemDirty(Entries[EntryIdxA]);
+		EntrySlots[EntryIdxA] = SlotB;
+		EntryIndicesBySlot.Add(SlotB, EntryIdxA);
+	}
+	if (EntryIdxB != INDEX_NONE)
+	{
+		Entries[EntryIdxB].Slot = SlotA;
+		MarkItemDirty(Entries[EntryIdxB]);
+		EntrySlots[EntryIdxB] = SlotA;
+		EntryIndicesBySlot.Add(SlotA, EntryIdxB);
+	}
+	return true;
 }
 
 void FGameItemList::GetAllItems(TMap<int32, UGameItem*>& OutItems) const
 {
+	UpdateSlotCache();
+
 	OutItems.Reset();
 	OutItems.Reserve(Entries.Num());
-	for (const FGameItemListEntry& Entry : Entries)
+	for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
 	{
-		ensureAlways(!OutItems.Contains(Entry.Slot));
-		OutItems.Add(Entry.Slot, Entry.Item);
+		OutItems.Add(EntrySlots[Idx], Entries[Idx].Item);
 	}
 }
 
 void FGameItemList::GetAllSlots(TArray<int32>& OutSlots) const
 {
-	OutSlots.Reset();
-	OutSlots.Reserve(Entries.Num());
-	for (const FGameItemListEntry& Entry : Entries)
-	{
-		ensureAlways(!OutSlots.Contains(Entry.Slot));
-		OutSlots.Add(Entry.Slot);
-	}
+	UpdateSlotCache();
+
+	OutSlots = EntrySlots;
 	OutSlots.Sort();
 }
 
@@ -403,7 +641,7 @@ FString FGameItemSaveData::ToString() const
 
 void FGameItemsPredictionKey::GenerateNewPredictionKey()
 {
-	static int16 GKey = 1;
+	static int32 GKey = 1;
 	Id = GKey++;
 	if (GKey <= 0)
 	{
@@ -412,6 +650,261 @@ void FGameItemsPredictionKey::GenerateNewPredictionKey()
 }
 
 
+// FGameItemsPredictionKeyConfirmations
+// ------------------------------------
+
+bool FGameItemsPredictionKeyConfirmations::Add(const FGameItemsPredictionKey& PredictionKey, bool bAccepted)
+{
+	check(PredictionKey.IsLocalClientKey());
+
+	if (IsEmpty())
+	{
+		BaseId = PredictionKey.Id;
+	}
+
+	const int32 Offset = PredictionKey.Id - BaseId;
+	if (!ensure(Offset >= 0) || Offset >= MaxKeySpan)
+	{
+		return false;
+	}
+
+	const int32 NumBytes = Offset / 8 + 1;
+	if (ConfirmedBits.Num() < NumBytes)
+	{
+		ConfirmedBits.SetNumZeroed(NumBytes);
+		AcceptedBits.SetNumZeroed(NumBytes);
+	}
+
+	const uint8 Mask = 1 << (Offset % 8);
+	ConfirmedBits[Offset / 8] |= Mask;
+	if (bAccepted)
+	{
+		AcceptedBits[Offset / 8] |= Mask;
+	}
+	return true;
+}
+
+void FGameItemsPredictionKeyConfirmations::GetConfirmations(TArray<TPair<FGameItemsPredictionKey, bool>>& OutConfirmations) const
+{
+	OutConfirmations.Reset();
+	for (int32 Offset = 0; Offset < ConfirmedBits.Num() * 8; ++Offset)
+	{
+		const uint8 Mask = 1 << (Offset % 8);
+		if (ConfirmedBits[Offset / 8] & Mask)
+		{
+			FGameItemsPredictionKey PredictionKey;
+			PredictionKey.Id = BaseId + Offset;
+			const bool bAccepted = AcceptedBits.IsValidIndex(Offset / 8) && (AcceptedBits[Offset / 8] & Mask);
+			OutConfirmations.Emplace(PredictionKey, bAccepted);
+		}
+	}
+}
+
+void FGameItemsPredictionKeyConfirmations::Reset()
+{
+	BaseId = 0;
+	ConfirmedBits.Reset();
+	AcceptedBits.Reset();
+}
+
+
+// FGameItemsPredictionKeyGenerator
+// --------------------------------
+
+FGameItemsPredictionKeyGenerator::~FGameItemsPredictionKeyGenerator()
+{
+	DEC_DWORD_STAT_BY(STAT_GameItems_PendingPredictions, PendingKeyIds.Num());
+}
+
+FGameItemsPredictionKey FGameItemsPredictionKeyGenerator::CreateKey(double CurrentTime)
+{
+	FGameItemsPredictionKey NewKey;
+	NewKey.Id = NextId++;
+	if (NextId <= 0)
+	{
+		NextId = 1;
+	}
+
+	PendingKeyIds.Add(NewKey.Id);
+	KeyHistory.EmplaceLast(NewKey.Id, CurrentTime);
+	INC_DWORD_STAT(STAT_GameItems_PendingPredictions);
+	return NewKey;
+}
+
+bool FGameItemsPredictionKeyGenerator::Acknowledge(const FGameItemsPredictionKey& PredictionKey)
+{
+	if (PendingKeyIds.Remove(PredictionKey.Id) > 0)
+	{
+		DEC_DWORD_STAT(STAT_GameItems_PendingPredictions);
+		return true;
+	}
+	return false;
+}
+
+void FGameItemsPredictionKeyGenerator::ExpireKeys(double CurrentTime, double Timeout, int32 WindowSize, TArray<FGameItemsPredictionKey>& OutExpiredKeys)
+{
+	// keys are created in order, so only the oldest ones need to be checked
+	while (!KeyHistory.IsEmpty())
+	{
+		const TPair<int32, double>& OldestKey = KeyHistory.First();
+		if (PendingKeyIds.Contains(OldestKey.Key))
+		{
+			const bool bTimedOut = CurrentTime - OldestKey.Value > Timeout;
+			const bool bOutsideWindow = PendingKeyIds.Num() > WindowSize;
+			if (!bTimedOut && !bOutsideWindow)
+			{
+				break;
+			}
+
+			FGameItemsPredictionKey& ExpiredKey = OutExpiredKeys.AddDefaulted_GetRef();
+			ExpiredKey.Id = OldestKey.Key;
+			PendingKeyIds.Remove(OldestKey.Key);
+			DEC_DWORD_STAT(STAT_GameItems_PendingPredictions);
+		}
+		KeyHistory.PopFirst();
+	}
+}
+
+
+// FGameItemsRpcBudget
+// -------------------
+
+bool FGameItemsRpcBudget::TryConsume(double Cost, double CurrentTime, double TokensPerSecond, double MaxTokens)
+{
+	if (!bInitialized)
+	{
+		// first use, start with a full bucket
+		bInitialized = true;
+		Tokens = MaxTokens;
+	}
+	else
+	{
+		Tokens = FMath::Min(Tokens + (CurrentTime - LastRefillTime) * TokensPerSecond, MaxTokens);
+	}
+	LastRefillTime = CurrentTime;
+
+	// batches larger than the bucket only need a full bucket, and go into debt for the rest,
+	// so that they're still allowed but the client must wait longer before the next one
+	if (Tokens < FMath::Min(Cost, MaxTokens))
+	{
+		++NumThrottled;
+		return false;
+	}
+
+	Tokens -= Cost;
+	++NumAllowed;
+	return true;
+}
+
+
+// FGameItemAliasTable
+// -------------------
+
+void FGameItemAliasTable::Build(TConstArrayView<float> Weights)
+{
+	const int32 Num = Weights.Num();
+	Probabilities.SetNumUninitialized(Num);
+	Aliases.SetNumUninitialized(Num);
+
+	double Total = 0.0;
+	for (const float Weight : Weights)
+	{
+		Total += FMath::Max(Weight, 0.f);
+	}
+
+	if (Total <= 0.0)
+	{
+		// always select the first index
+		for (int32 Idx = 0; Idx < Num; ++Idx)
+		{
+			Probabilities[Idx] = 0.f;
+			Aliases[Idx] = 0;
+		}
+		return;
+	}
+
+	// scale weights so that the average is 1, then pair each below-average index with an above-average one
+	TArray<double> Scaled;
+	Scaled.SetNumUninitialized(Num);
+	TArray<int32> Small;
+	TArray<int32> Large;
+	Small.Reserve(Num);
+	Large.Reserve(Num);
+
+	for (int32 Idx = 0; Idx < Num; ++Idx)
+	{
+		Scaled[Idx] = FMath::Max(Weights[Idx], 0.f) * Num / Total;
+		if (Scaled[Idx] < 1.0)
+		{
+			Small.Add(Idx);
+		}
+		else
+		{
+			Large.Add(Idx);
+		}
+	}
+
+	while (!Small.IsEmpty() && !Large.IsEmpty())
+	{
+		const int32 SmallIdx = Small.Pop(EAllowShrinking::No);
+		const int32 LargeIdx = Large.Pop(EAllowShrinking::No);
+
+		Probabilities[SmallIdx] = static_cast<float>(Scaled[SmallIdx]);
+		Aliases[SmallIdx] = LargeIdx;
+
+		Scaled[LargeIdx] = Scaled[LargeIdx] + Scaled[SmallIdx] - 1.0;
+		if (Scaled[LargeIdx] < 1.0)
+		{
+			Small.Add(LargeIdx);
+		}
+		else
+		{
+			Large.Add(LargeIdx);
+		}
+	}
+
+	// anything remaining is within rounding error of 1
+	for (const int32 Idx : Large)
+	{
+		Probabilities[Idx] = 1.f;
+		Aliases[Idx] = Idx;
+	}
+	for (const int32 Idx : Small)
+	{
+		Probabilities[Idx] = 1.f;
+		Aliases[Idx] = Idx;
+	}
+}
+
+void FGameItemAliasTable::Reset()
+{
+	Probabilities.Reset();
+	Aliases.Reset();
+}
+
+int32 FGameItemAliasTable::Sample() const
+{
+	if (Probabilities.IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Idx = FMath::RandHelper(Probabilities.Num());
+	return FMath::FRand() < Probabilities[Idx] ? Idx : Aliases[Idx];
+}
+
+int32 FGameItemAliasTable::Sample(const FRandomStream& RandomStream) const
+{
+	if (Probabilities.IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Idx = RandomStream.RandHelper(Probabilities.Num());
+	return RandomStream.FRand() < Probabilities[Idx] ? Idx : Aliases[Idx];
+}
+
+
 // FGameItemContainerPair
 // ----------------------
 
@@ -445,7 +938,7 @@ FGameItemsPredictionKey FGameItemsPredictionKey::CreateNewServerInitiatedKey(con
 	if (Owner->GetLocalRole() == ROLE_Authority)
 	{
 		// don't use same generation as client
-		static int16 GServerKey = 1;
+		static int32 GServerKey = 1;
 		NewKey.bIsServerInitiated = true;
 		NewKey.Id = GServerKey++;
 
@@ -456,3 +949,49 @@ FGameItemsPredictionKey FGameItemsPredictionKey::CreateNewServerInitiatedKey(con
 	}
 	return NewKey;
 }
+
+
+// FGameItemContainerTransaction
+// -----------------------------
+
+void FGameItemContainerTransaction::AddOp(const FGameItemContainerOp& Op)
+{
+	if (Op.Type == EGameItemContainerOpType::SwapItems && !Ops.IsEmpty())
+	{
+		// swapping the same slots again undoes the previous swap, but only when both slots are occupied,
+		// otherwise it's a move, which in ordered containers also shifts the other items
+		const FGameItemContainerOp& PrevOp = Ops.Last();
+		if (PrevOp.Type == EGameItemContainerOpType::SwapItems && PrevOp.Container == Op.Container &&
+			((PrevOp.SlotA == Op.SlotA && PrevOp.SlotB == Op.SlotB) || (PrevOp.SlotA == Op.SlotB && PrevOp.SlotB == Op.SlotA)) &&
+			Op.Container && !Op.Container->GetInternalItemList().UsesOrderedSlots() &&
+			!Op.Container->IsSlotEmpty(Op.SlotA) && !Op.Container->IsSlotEmpty(Op.SlotB))
+		{
+			Ops.Pop();
+			return;
+		}
+	}
+
+	if (Op.Type == EGameItemContainerOpType::SetItemAt && !Ops.IsEmpty())
+	{
+		// setting the same item in the same slot again does nothing
+		const FGameItemContainerOp& PrevOp = Ops.Last();
+		if (PrevOp.Type == EGameItemContainerOpType::SetItemAt && PrevOp.Container == Op.Container &&
+			PrevOp.Item == Op.Item && PrevOp.SlotA == Op.SlotA)
+		{
+			return;
+		}
+	}
+
+	Ops.Add(Op);
+}
+
+FGameItemContainerTransaction FGameItemContainerTransaction::GetCoalesced() const
+{
+	FGameItemContainerTransaction Result;
+	Result.Ops.Reserve(Ops.Num());
+	for (const FGameItemContainerOp& Op : Ops)
+	{
+		Result.AddOp(Op);
+	}
+	return Result;
+}
@@ -7,12 +7,21 @@
 #include "GameplayDebuggerCategory_GameItems.h"
 #endif
 
+#include "GameItemsTrace.h"
+#include "Conditions/GameItemConditionCache.h"
 #include "Engine/Console.h"
 
 #define LOCTEXT_NAMESPACE "FGameItemsModule"
 
 DEFINE_LOG_CATEGORY(LogGameItems);
 
+DEFINE_STAT(STAT_GameItems_LiveItems);
+DEFINE_STAT(STAT_GameItems_LiveContainers);
+DEFINE_STAT(STAT_GameItems_PendingPredictions);
+DEFINE_STAT(STAT_GameItems_CachedConditionStates);
+
+LLM_DEFINE_TAG(GameItems);
+
 const FName ShowDebugNames::GameItems(TEXT("GameItems"));
 
 
@@ -30,10 +39,16 @@ void FGameItemsModule::StartupModule()
 #if ALLOW_CONSOLE
 	UConsole::RegisterConsoleAutoCompleteEntries.AddStatic(&FGameItemsModule::PopulateAutoCompleteEntries);
 #endif
+
+	FGameItemConditionCache::Get().Initialize();
+	FGameItemsTrace::Initialize();
 }
 
 void FGameItemsModule::ShutdownModule()
 {
+	FGameItemsTrace::Shutdown();
+	FGameItemConditionCache::Get().Shutdown();
+
 #if WITH_GAMEPLAY_DEBUGGER
 	if (IGameplayDebugger::IsAvailable())
 	{
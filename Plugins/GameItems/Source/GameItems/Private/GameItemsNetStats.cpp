@@ -0,0 +1,371 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "GameItemsNetStats.h"
+
+#include "Engine/NetConnection.h"
+#include "Engine/NetSerialization.h"
+#include "Engine/PackageMapClient.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+CSV_DEFINE_CATEGORY(GameItemsNet, true);
+
+
+namespace GameItems::NetStats
+{
+	bool bEnabled = false;
+
+	FAutoConsoleVariableRef CVarEnabled(
+		TEXT("GameItems.NetStats.Enabled"),
+		bEnabled,
+		TEXT("Record the bandwidth used by replicated game items, containers and equipment."));
+
+	FAutoConsoleCommandWithArgsAndOutputDevice DumpCommand(
+		TEXT("GameItems.NetStats.Dump"),
+		TEXT("Print the bandwidth used by replicated game items. Usage: GameItems.NetStats.Dump [MaxEntries]"),
+		FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+		{
+			const int32 MaxEntries = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20;
+			FGameItemsNetStats::Get().Dump(Ar, MaxEntries);
+		}));
+
+	FAutoConsoleCommand ResetCommand(
+		TEXT("GameItems.NetStats.Reset"),
+		TEXT("Reset all recorded game item net stats."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FGameItemsNetStats::Get().Reset();
+		}));
+
+	const TCHAR* GetCategoryName(EGameItemsNetStatCategory Category)
+	{
+		switch (Category)
+		{
+		case EGameItemsNetStatCategory::ItemList:
+			return TEXT("ItemList");
+		case EGameItemsNetStatCategory::TagStacks:
+			return TEXT("TagStacks");
+		case EGameItemsNetStatCategory::EquipmentList:
+			return TEXT("EquipmentList");
+		default:
+			return TEXT("Unknown");
+		}
+	}
+
+	template <typename KeyType>
+	void DumpCounters(FOutputDevice& Ar, const TCHAR* Title, const TMap<KeyType, FGameItemsNetStats::FNamedCounter>& Counters, int32 MaxEntries)
+	{
+		TArray<const FGameItemsNetStats::FNamedCounter*> SortedCounters;
+		SortedCounters.Reserve(Counters.Num());
+		for (const auto& Elem : Counters)
+		{
+			SortedCounters.Add(&Elem.Value);
+		}
+		SortedCounters.Sort([](const FGameItemsNetStats::FNamedCounter& A, const FGameItemsNetStats::FNamedCounter& B)
+		{
+			return A.NumBytes > B.NumBytes;
+		});
+
+		Ar.Logf(TEXT("%s (%d):"), Title, Counters.Num());
+		for (int32 Idx = 0; Idx < SortedCounters.Num() && Idx < MaxEntries; ++Idx)
+		{
+			const FGameItemsNetStats::FNamedCounter& Counter = *SortedCounters[Idx];
+			Ar.Logf(TEXT("  %10lld bytes %8d times  %s"), Counter.NumBytes, Counter.Count, *Counter.Name);
+		}
+	}
+}
+
+
+// FGameItemsNetStats
+// ------------------
+
+FGameItemsNetStats& FGameItemsNetStats::Get()
+{
+	static FGameItemsNetStats Instance;
+	return Instance;
+}
+
+bool FGameItemsNetStats::IsEnabled()
+{
+#if CSV_PROFILER
+	if (FCsvProfiler::Get()->IsCapturing())
+	{
+		return true;
+	}
+#endif
+	return GameItems::NetStats::bEnabled;
+}
+
+FGameItemsNetStats::FConnectionStats* FGameItemsNetStats::FindOrAddConnectionStats(const UNetConnection* Connection)
+{
+	if (!Connection)
+	{
+		return nullptr;
+	}
+
+	FConnectionStats& Stats = StatsByConnection.FindOrAdd(Connection);
+	if (!Stats.bHasPlayerControllerName)
+	{
+		// the player controller is assigned after the connection starts replicating
+		if (Connection->PlayerController)
+		{
+			Stats.Name = Connection->PlayerController->GetName();
+			Stats.bHasPlayerControllerName = true;
+		}
+		else if (Stats.Name.IsEmpty())
+		{
+			Stats.Name = Connection->GetName();
+		}
+	}
+	return &Stats;
+}
+
+const FGameItemsNetStats::FConnectionStats* FGameItemsNetStats::FindConnectionStats(const UNetConnection* Connection) const
+{
+	return Connection ? StatsByConnection.Find(Connection) : nullptr;
+}
+
+void FGameItemsNetStats::RecordSerialize(EGameItemsNetStatCategory Category, const UObject* Object, const UNetConnection* Connection,
+                                         int64 NumBits, bool bIsWriting)
+{
+	if (NumBits <= 0)
+	{
+		return;
+	}
+
+	FConnectionStats* ConnectionStats = FindOrAddConnectionStats(Connection);
+
+	if (!bIsWriting)
+	{
+		ReceivedByCategory[static_cast<int32>(Category)].Add(NumBits);
+		if (ConnectionStats)
+		{
+			ConnectionStats->Received.Add(NumBits);
+		}
+		CSV_CUSTOM_STAT(GameItemsNet, BytesReceived, static_cast<int32>((NumBits + 7) / 8), ECsvCustomStatOp::Accumulate);
+		return;
+	}
+
+	SentByCategory[static_cast<int32>(Category)].Add(NumBits);
+	if (ConnectionStats)
+	{
+		ConnectionStats->Sent.Add(NumBits);
+	}
+
+	if (Object)
+	{
+		FNamedCounter& ObjectCounter = SentByObject.FindOrAdd(Object);
+		if (ObjectCounter.Name.IsEmpty())
+		{
+			ObjectCounter.Name = FString::Printf(TEXT("[%s] %s"), GameItems::NetStats::GetCategoryName(Category), *Object->GetPathName());
+		}
+		ObjectCounter.Add(NumBits);
+
+		const AActor* Actor = Cast<AActor>(Object);
+		if (!Actor)
+		{
+			Actor = Object->GetTypedOuter<AActor>();
+		}
+		if (Actor)
+		{
+			FNamedCounter& ActorCounter = SentByActor.FindOrAdd(Actor);
+			if (ActorCounter.Name.IsEmpty())
+			{
+				ActorCounter.Name = Actor->GetPathName();
+			}
+			ActorCounter.Add(NumBits);
+		}
+	}
+
+	const int32 NumBytes = static_cast<int32>((NumBits + 7) / 8);
+	switch (Category)
+	{
+	case EGameItemsNetStatCategory::ItemList:
+		CSV_CUSTOM_STAT(GameItemsNet, ItemListBytesSent, NumBytes, ECsvCustomStatOp::Accumulate);
+		break;
+	case EGameItemsNetStatCategory::TagStacks:
+		CSV_CUSTOM_STAT(GameItemsNet, TagStackBytesSent, NumBytes, ECsvCustomStatOp::Accumulate);
+		break;
+	case EGameItemsNetStatCategory::EquipmentList:
+		CSV_CUSTOM_STAT(GameItemsNet, EquipmentListBytesSent, NumBytes, ECsvCustomStatOp::Accumulate);
+		break;
+	default: ;
+	}
+}
+
+void FGameItemsNetStats::RecordRpc(const UFunction* Function, const UNetConnection* Connection, int64 NumBits)
+{
+	if (!Function)
+	{
+		return;
+	}
+
+	FNamedCounter& Counter = RpcsByFunction.FindOrAdd(Function);
+	if (Counter.Name.IsEmpty())
+	{
+		Counter.Name = Function->GetPathName();
+	}
+	Counter.Add(NumBits);
+
+	if (FConnectionStats* ConnectionStats = FindOrAddConnectionStats(Connection))
+	{
+		ConnectionStats->Rpcs.Add(NumBits);
+	}
+
+	CSV_CUSTOM_STAT(GameItemsNet, RpcCount, 1, ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(GameItemsNet, RpcBytesSent, static_cast<int32>((NumBits + 7) / 8), ECsvCustomStatOp::Accumulate);
+}
+
+void FGameItemsNetStats::RecordItemsReplicated(int32 NumItems)
+{
+	if (NumItems <= 0)
+	{
+		return;
+	}
+
+	NumItemsReplicated += NumItems;
+	NumSampleItemsReplicated += NumItems;
+
+	const double CurrentTime = FPlatformTime::Seconds();
+	if (CurrentTime - SampleStartTime >= 1.0)
+	{
+		ItemsPerSecond = SampleStartTime > 0.0 ? NumSampleItemsReplicated / (CurrentTime - SampleStartTime) : 0.f;
+		NumSampleItemsReplicated = 0;
+		SampleStartTime = CurrentTime;
+	}
+
+	CSV_CUSTOM_STAT(GameItemsNet, ItemsReplicated, NumItems, ECsvCustomStatOp::Accumulate);
+}
+
+void FGameItemsNetStats::Dump(FOutputDevice& Ar, int32 MaxEntries) const
+{
+	using namespace GameItems::NetStats;
+
+	Ar.Logf(TEXT("Game Items Net Stats%s"), IsEnabled() ? TEXT("") : TEXT(" (disabled, enable with GameItems.NetStats.Enabled 1)"));
+
+	Ar.Logf(TEXT("Categories:"));
+	for (int32 Idx = 0; Idx < static_cast<int32>(EGameItemsNetStatCategory::MAX); ++Idx)
+	{
+		Ar.Logf(TEXT("  %-14s sent: %10lld bytes %8d times, received: %10lld bytes %8d times"),
+			GetCategoryName(static_cast<EGameItemsNetStatCategory>(Idx)),
+			SentByCategory[Idx].NumBytes, SentByCategory[Idx].Count,
+			ReceivedByCategory[Idx].NumBytes, ReceivedByCategory[Idx].Count);
+	}
+
+	Ar.Logf(TEXT("Items replicated: %lld (%.1f/s)"), NumItemsReplicated, ItemsPerSecond);
+
+	TArray<const FConnectionStats*> SortedConnections;
+	SortedConnections.Reserve(StatsByConnection.Num());
+	for (const auto& Elem : StatsByConnection)
+	{
+		SortedConnections.Add(&Elem.Value);
+	}
+	SortedConnections.Sort([](const FConnectionStats& A, const FConnectionStats& B)
+	{
+		return A.Sent.NumBytes > B.Sent.NumBytes;
+	});
+
+	Ar.Logf(TEXT("Connections (%d):"), StatsByConnection.Num());
+	for (int32 Idx = 0; Idx < SortedConnections.Num() && Idx < MaxEntries; ++Idx)
+	{
+		const FConnectionStats& Stats = *SortedConnections[Idx];
+		Ar.Logf(TEXT("  sent: %10lld bytes %8d times, received: %10lld bytes %8d times, RPCs: %10lld bytes %8d times  %s"),
+			Stats.Sent.NumBytes, Stats.Sent.Count, Stats.Received.NumBytes, Stats.Received.Count,
+			Stats.Rpcs.NumBytes, Stats.Rpcs.Count, *Stats.Name);
+	}
+
+	DumpCounters(Ar, TEXT("Sent by object"), SentByObject, MaxEntries);
+	DumpCounters(Ar, TEXT("Sent by actor"), SentByActor, MaxEntries);
+	DumpCounters(Ar, TEXT("RPCs"), RpcsByFunction, MaxEntries);
+}
+
+void FGameItemsNetStats::Reset()
+{
+	*this = FGameItemsNetStats();
+}
+
+
+// FGameItemsNetStatsSerializeScope
+// --------------------------------
+
+FGameItemsNetStatsSerializeScope::FGameItemsNetStatsSerializeScope(EGameItemsNetStatCategory InCategory, const FNetDeltaSerializeInfo& InDeltaParms)
+	: Category(InCategory)
+	, DeltaParms(InDeltaParms)
+{
+	if (!FGameItemsNetStats::IsEnabled())
+	{
+		return;
+	}
+
+	if (DeltaParms.Writer)
+	{
+		StartBits = DeltaParms.Writer->GetNumBits();
+	}
+	else if (DeltaParms.Reader)
+	{
+		StartBits = DeltaParms.Reader->GetPosBits();
+	}
+}
+
+FGameItemsNetStatsSerializeScope::~FGameItemsNetStatsSerializeScope()
+{
+	if (StartBits == INDEX_NONE)
+	{
+		return;
+	}
+
+	UPackageMapClient* PackageMap = Cast<UPackageMapClient>(DeltaParms.Map);
+	const UNetConnection* Connection = PackageMap ? PackageMap->GetConnection() : nullptr;
+
+	if (DeltaParms.Writer)
+	{
+		FGameItemsNetStats::Get().RecordSerialize(Category, DeltaParms.Object, Connection, DeltaParms.Writer->GetNumBits() - StartBits, true);
+	}
+	else if (DeltaParms.Reader)
+	{
+		FGameItemsNetStats::Get().RecordSerialize(Category, DeltaParms.Object, Connection, DeltaParms.Reader->GetPosBits() - StartBits, false);
+	}
+}
+
+
+// FGameItemsNetStatsRpcScope
+// --------------------------
+
+FGameItemsNetStatsRpcScope::FGameItemsNetStatsRpcScope(const UFunction* InFunction, const AActor* Actor)
+{
+	if (!FGameItemsNetStats::IsEnabled())
+	{
+		return;
+	}
+
+	Function = InFunction;
+	Connection = Actor ? Actor->GetNetConnection() : nullptr;
+	StartBits = GetConnectionBitsWritten(Connection);
+}
+
+FGameItemsNetStatsRpcScope::~FGameItemsNetStatsRpcScope()
+{
+	if (!Function)
+	{
+		return;
+	}
+
+	// a packet may have been flushed while sending, which is included in the total bytes,
+	// but RPCs that are queued to be sent later (e.g. with Iris) will be recorded as empty
+	const int64 NumBits = FMath::Max<int64>(GetConnectionBitsWritten(Connection) - StartBits, 0);
+	FGameItemsNetStats::Get().RecordRpc(Function, Connection, NumBits);
+}
+
+int64 FGameItemsNetStatsRpcScope::GetConnectionBitsWritten(const UNetConnection* InConnection)
+{
+	if (!InConnection)
+	{
+		return 0;
+	}
+	return static_cast<int64>(InConnection->OutTotalBytes) * 8 + InConnection->SendBuffer.GetNumBits();
+}
@@ -0,0 +1,187 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "GameItemsTrace.h"
+
+#include "GameItem.h"
+#include "GameItemContainer.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/TraceAuxiliary.h"
+#include "Trace/Trace.inl"
+#include "UObject/UObjectArray.h"
+
+#if GAMEITEMS_TRACE_ENABLED
+
+UE_TRACE_CHANNEL_DEFINE(GameItemsChannel)
+
+UE_TRACE_EVENT_BEGIN(GameItems, ItemOp)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, ItemId)
+	UE_TRACE_EVENT_FIELD(uint64, ItemDefId)
+	UE_TRACE_EVENT_FIELD(uint64, ContainerId)
+	UE_TRACE_EVENT_FIELD(uint32, FrameNumber)
+	UE_TRACE_EVENT_FIELD(int32, Slot)
+	UE_TRACE_EVENT_FIELD(int32, OtherSlot)
+	UE_TRACE_EVENT_FIELD(int32, Delta)
+	UE_TRACE_EVENT_FIELD(int32, PredictionKey)
+	UE_TRACE_EVENT_FIELD(uint8, Op)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(GameItems, ObjectName)
+	UE_TRACE_EVENT_FIELD(uint64, ObjectId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Name)
+UE_TRACE_EVENT_END()
+
+
+namespace GameItems
+{
+	int32 MaxTraceNamedObjects = 65536;
+
+	FAutoConsoleVariableRef CVarMaxTraceNamedObjects(
+		TEXT("GameItems.Trace.MaxNamedObjects"),
+		MaxTraceNamedObjects,
+		TEXT("The number of object ids to remember having written names for, after which they're forgotten")
+		TEXT(" and names are written again as needed. Bounds memory use during long traces."));
+}
+
+namespace GameItems::Trace
+{
+	/** Object ids whose names have been written to the current trace. */
+	TSet<uint64> NamedObjectIds;
+
+	/** Guards NamedObjectIds, since items can be traced from any thread, e.g. by async loading. */
+	FCriticalSection NamedObjectIdsLock;
+
+	FDelegateHandle TraceStartedHandle;
+	FDelegateHandle TraceStoppedHandle;
+
+	void ResetNamedObjectIds()
+	{
+		FScopeLock Lock(&NamedObjectIdsLock);
+		NamedObjectIds.Empty();
+	}
+}
+
+
+void FGameItemsTrace::OutputItemOp(EGameItemsTraceOp Op, const UGameItem* Item, const UGameItemContainer* Container,
+                                   int32 Slot, int32 Delta, int32 PredictionKeyId, int32 OtherSlot)
+{
+	const uint64 ItemId = GetObjectId(Item);
+	const uint64 ItemDefId = Item ? GetObjectId(Item->GetItemDef()) : 0;
+	const uint64 ContainerId = GetObjectId(Container);
+
+	UE_TRACE_LOG(GameItems, ItemOp, GameItemsChannel)
+		<< ItemOp.Cycle(FPlatformTime::Cycles64())
+		<< ItemOp.ItemId(ItemId)
+		<< ItemOp.ItemDefId(ItemDefId)
+		<< ItemOp.ContainerId(ContainerId)
+		<< ItemOp.FrameNumber(static_cast<uint32>(GFrameCounter))
+		<< ItemOp.Slot(Slot)
+		<< ItemOp.OtherSlot(OtherSlot)
+		<< ItemOp.Delta(Delta)
+		<< ItemOp.PredictionKey(PredictionKeyId)
+		<< ItemOp.Op(static_cast<uint8>(Op));
+}
+
+uint64 FGameItemsTrace::GetObjectId(const UObject* Object)
+{
+	if (!Object)
+	{
+		return 0;
+	}
+
+	// combine the object index with its serial number, so that ids aren't reused when objects are destroyed.
+	// serial numbers are only read, not allocated, so tracing doesn't change object state. objects without one,
+	// i.e. that were never weakly referenced, use a hash of their name instead, with the high bit set to keep them apart
+	const int32 Index = GUObjectArray.ObjectToIndex(Object);
+	const int32 SerialNumber = GUObjectArray.GetSerialNumber(Index);
+	const uint32 IdHigh = SerialNumber != 0 ? static_cast<uint32>(SerialNumber) : (GetTypeHash(Object->GetFName()) | 0x80000000u);
+	const uint64 ObjectId = (static_cast<uint64>(IdHigh) << 32) | static_cast<uint32>(Index);
+
+	bool bAlreadyNamed = false;
+	{
+		FScopeLock Lock(&GameItems::Trace::NamedObjectIdsLock);
+		if (GameItems::Trace::NamedObjectIds.Num() >= GameItems::MaxTraceNamedObjects)
+		{
+			// forget everything rather than track object lifetimes, writing names again is harmless
+			GameItems::Trace::NamedObjectIds.Reset();
+		}
+		GameItems::Trace::NamedObjectIds.Add(ObjectId, &bAlreadyNamed);
+	}
+
+	if (!bAlreadyNamed)
+	{
+		const FString Name = Object->GetPathName();
+		UE_TRACE_LOG(GameItems, ObjectName, GameItemsChannel, Name.Len() * sizeof(TCHAR))
+			<< ObjectName.ObjectId(ObjectId)
+			<< ObjectName.Name(*Name, Name.Len());
+	}
+
+	return ObjectId;
+}
+
+void FGameItemsTrace::Initialize()
+{
+	GameItems::Trace::TraceStartedHandle = FTraceAuxiliary::OnTraceStarted.AddLambda(
+		[](FTraceAuxiliary::EConnectionType, const FString&)
+		{
+			OnTraceStarted();
+		});
+	GameItems::Trace::TraceStoppedHandle = FTraceAuxiliary::OnTraceStopped.AddLambda(
+		[](FTraceAuxiliary::EConnectionType, const FString&)
+		{
+			OnTraceStopped();
+		});
+}
+
+void FGameItemsTrace::Shutdown()
+{
+	FTraceAuxiliary::OnTraceStarted.Remove(GameItems::Trace::TraceStartedHandle);
+	FTraceAuxiliary::OnTraceStopped.Remove(GameItems::Trace::TraceStoppedHandle);
+	GameItems::Trace::TraceStartedHandle.Reset();
+	GameItems::Trace::TraceStoppedHandle.Reset();
+	GameItems::Trace::ResetNamedObjectIds();
+}
+
+void FGameItemsTrace::OnTraceStarted()
+{
+	// names written to a previous trace aren't in the new one
+	GameItems::Trace::ResetNamedObjectIds();
+}
+
+void FGameItemsTrace::OnTraceStopped()
+{
+	// free the ids while not tracing
+	GameItems::Trace::ResetNamedObjectIds();
+}
+
+#else
+
+void FGameItemsTrace::OutputItemOp(EGameItemsTraceOp Op, const UGameItem* Item, const UGameItemContainer* Container,
+                                   int32 Slot, int32 Delta, int32 PredictionKeyId, int32 OtherSlot)
+{
+}
+
+uint64 FGameItemsTrace::GetObjectId(const UObject* Object)
+{
+	return 0;
+}
+
+void FGameItemsTrace::Initialize()
+{
+}
+
+void FGameItemsTrace::Shutdown()
+{
+}
+
+void FGameItemsTrace::OnTraceStarted()
+{
+}
+
+void FGameItemsTrace::OnTraceStopped()
+{
+}
+
+#endif
@@ -158,13 +158,14 @@ TArray<FGameplayDebuggerCategory_GameItems::FRepData::FContainerDebug> FGameplay
 			const UGameItem* Item = Entry.Item;
 			ItemData.ReplicationID = Entry.ReplicationID;
 			ItemData.NetworkStatus = NetworkStatus;
+			const int32 Slot = ItemList.GetEntrySlot(Entry);
 			if (Item)
 			{
-				ItemData.Item = FString::Printf(TEXT("[%d] %s%s"), Entry.Slot, *ItemPrefix, *Item->GetDebugString());
+				ItemData.Item = FString::Printf(TEXT("[%d] %s%s"), Slot, *ItemPrefix, *Item->GetDebugString());
 			}
 			else
 			{
-				ItemData.Item = FString::Printf(TEXT("[%d] (null)"), Entry.Slot);
+				ItemData.Item = FString::Printf(TEXT("[%d] (null)"), Slot);
 			}
 		}
 	}
@@ -5,6 +5,7 @@
 
 #include "GameItem.h"
 #include "GameItemContainer.h"
+#include "GameItemsNetStats.h"
 #include "Engine/Engine.h"
 #include "Engine/NetDriver.h"
 
@@ -35,6 +36,7 @@ bool UGameItemContainerRule::CallRemoteFunction(UFunction* Function, void* Parms
 	{
 		return false;
 	}
+	FGameItemsNetStatsRpcScope NetStatsScope(Function, Actor);
 	NetDriver->ProcessRemoteFunction(Actor, Function, Parms, OutParms, Stack, this);
 	return true;
 }
@@ -0,0 +1,100 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "DropTable/GameItemDropContext.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GameItems::DropTable::Tests
+{
+	constexpr int32 NumSeeds = 100000;
+	constexpr int32 NumBuckets = 16;
+
+	/** The chi-squared value for NumBuckets - 1 degrees of freedom at p = 0.001, above which rolls are not uniform. */
+	constexpr double MaxChiSquared = 37.7;
+
+	/** Return the chi-squared statistic of a histogram of rolls against a uniform distribution. */
+	double GetChiSquared(const TArray<int32>& Buckets, int32 NumRolls)
+	{
+		const double Expected = static_cast<double>(NumRolls) / Buckets.Num();
+		double ChiSquared = 0.0;
+		for (const int32 Count : Buckets)
+		{
+			ChiSquared += FMath::Square(Count - Expected) / Expected;
+		}
+		return ChiSquared;
+	}
+
+	/** Roll once for each of NumSeeds consecutive seeds, and return the chi-squared value of the first roll of each. */
+	double GetFirstRollChiSquared(TFunctionRef<FRandomStream(int32 Seed)> MakeStream)
+	{
+		TArray<int32> Buckets;
+		Buckets.SetNumZeroed(NumBuckets);
+		for (int32 Seed = 0; Seed < NumSeeds; ++Seed)
+		{
+			const int32 Bucket = FMath::Min(FMath::FloorToInt32(MakeStream(Seed).FRand() * NumBuckets), NumBuckets - 1);
+			++Buckets[Bucket];
+		}
+		return GetChiSquared(Buckets, NumSeeds);
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameItemDropContextSeedDistributionTest, "GameItems.DropTable.SeedDistribution",
+                                 EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FGameItemDropContextSeedDistributionTest::RunTest(const FString& Parameters)
+{
+	using namespace GameItems::DropTable::Tests;
+
+	// drops are commonly seeded with consecutive values, e.g. an index or a counter,
+	// so the first roll of each stream must be uniform across consecutive seeds
+	const double ChanceChiSquared = GetFirstRollChiSquared([](int32 Seed)
+	{
+		return FGameItemDropContext::MakeRandomStream(true, Seed, EGameItemDropRoll::Chance);
+	});
+	TestTrue(FString::Printf(TEXT("Chance rolls for consecutive seeds are uniform (Chi-squared: %.1f)"), ChanceChiSquared),
+	         ChanceChiSquared < MaxChiSquared);
+
+	const double SelectionChiSquared = GetFirstRollChiSquared([](int32 Seed)
+	{
+		return FGameItemDropContext::MakeRandomStream(true, Seed, EGameItemDropRoll::Selection);
+	});
+	TestTrue(FString::Printf(TEXT("Selection rolls for consecutive seeds are uniform (Chi-squared: %.1f)"), SelectionChiSquared),
+	         SelectionChiSquared < MaxChiSquared);
+
+	// sibling content is seeded with consecutive child indices
+	const double ChildChiSquared = GetFirstRollChiSquared([](int32 ChildIndex)
+	{
+		return FGameItemDropContext::MakeRandomStream(true, FGameItemDropContext::DeriveSeed(0, ChildIndex), EGameItemDropRoll::Chance);
+	});
+	TestTrue(FString::Printf(TEXT("Chance rolls for consecutive child indices are uniform (Chi-squared: %.1f)"), ChildChiSquared),
+	         ChildChiSquared < MaxChiSquared);
+
+	// the rolls of one seed must be independent of each other, e.g. so that passing
+	// a low chance doesn't also favor the first entries of a selection
+	TArray<int32> JointBuckets;
+	JointBuckets.SetNumZeroed(NumBuckets);
+	constexpr int32 NumSideBuckets = 4;
+	for (int32 Seed = 0; Seed < NumSeeds; ++Seed)
+	{
+		const float ChanceValue = FGameItemDropContext::MakeRandomStream(true, Seed, EGameItemDropRoll::Chance).FRand();
+		const float SelectionValue = FGameItemDropContext::MakeRandomStream(true, Seed, EGameItemDropRoll::Selection).FRand();
+		const int32 ChanceBucket = FMath::Min(FMath::FloorToInt32(ChanceValue * NumSideBuckets), NumSideBuckets - 1);
+		const int32 SelectionBucket = FMath::Min(FMath::FloorToInt32(SelectionValue * NumSideBuckets), NumSideBuckets - 1);
+		++JointBuckets[ChanceBucket * NumSideBuckets + SelectionBucket];
+	}
+	const double JointChiSquared = GetChiSquared(JointBuckets, NumSeeds);
+	TestTrue(FString::Printf(TEXT("Chance and selection rolls are independent (Chi-squared: %.1f)"), JointChiSquared),
+	         JointChiSquared < MaxChiSquared);
+
+	// seeded rolls must be deterministic
+	TestEqual(TEXT("Seeded rolls are repeatable"),
+	          FGameItemDropContext::MakeRandomStream(true, 1234, EGameItemDropRoll::Quantity).GetUnsignedInt(),
+	          FGameItemDropContext::MakeRandomStream(true, 1234, EGameItemDropRoll::Quantity).GetUnsignedInt());
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,58 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameItemTypes.h"
+#include "DropTable/GameItemDropContext.h"
+#include "Engine/DataTable.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "AsyncAction_SelectItemsFromDropTable.generated.h"
+
+class UGameItem;
+
+
+/**
+ * Selects items from a drop table after asynchronously loading all item definitions and sets that it may select,
+ * and optionally creates the items.
+ */
+UCLASS()
+class GAMEITEMS_API UAsyncAction_SelectItemsFromDropTable : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Select items from a drop table, after loading everything it may select. */
+	UFUNCTION(BlueprintCallable, Meta = (WorldContext = "WorldContextObject", BlueprintInternalUseOnly = true), Category = "GameItems")
+	static UAsyncAction_SelectItemsFromDropTable* SelectItemsFromDropTableAsync(UObject* WorldContextObject, const FGameItemDropContext& Context,
+	                                                                           FDataTableRowHandle DropTableEntry);
+
+	/** Select and create new game items from a drop table, after loading everything it may select. */
+	UFUNCTION(BlueprintCallable, Meta = (WorldContext = "WorldContextObject", BlueprintInternalUseOnly = true), Category = "GameItems")
+	static UAsyncAction_SelectItemsFromDropTable* CreateItemsFromDropTableAsync(UObject* WorldContextObject, UObject* Outer, const FGameItemDropContext& Context,
+	                                                                           FDataTableRowHandle DropTableEntry);
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCompleteDynDelegate, const TArray<FGameItemDefStack>&, ItemStacks, const TArray<UGameItem*>&, Items);
+
+	/** Called when items have been selected, and created if requested. */
+	UPROPERTY(BlueprintAssignable)
+	FOnCompleteDynDelegate OnComplete;
+
+	virtual void Activate() override;
+
+protected:
+	void OnItemsSelected(const TArray<FGameItemDefStack>& Stacks);
+
+protected:
+	TWeakObjectPtr<UObject> WorldContextObject;
+
+	TWeakObjectPtr<UObject> Outer;
+
+	UPROPERTY()
+	FGameItemDropContext Context;
+
+	UPROPERTY()
+	FDataTableRowHandle DropTableEntry;
+
+	bool bCreateItems = false;
+};
@@ -0,0 +1,93 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldConditionContext.h"
+#include "WorldConditionQuery.h"
+#include "UObject/GCObject.h"
+#include "UObject/ObjectKey.h"
+
+class UWorld;
+class UWorldConditionSchema;
+struct FPropertyChangedEvent;
+
+
+/**
+ * Caches initialized world condition query states and context data for conditions that are evaluated once
+ * and discarded, such as drop rules and equipment conditions, so that repeated checks don't allocate.
+ * States are keyed by the object that owns the condition, including its serial number so that keys aren't reused
+ * by new objects, the offset of the condition within the owner, and the schema.
+ *
+ * Entries for destroyed owners are removed after garbage collection, and all entries are removed when a world
+ * is cleaned up, or when any object is edited in the editor. Conditions evaluated off the game thread,
+ * or that aren't stored directly in their owner, are not cached.
+ */
+class GAMEITEMS_API FGameItemConditionCache : public FGCObject, public FNoncopyable
+{
+public:
+	static FGameItemConditionCache& Get();
+
+	/** Register for garbage collection, world cleanup and editor notifications. Called by the module. */
+	void Initialize();
+
+	/** Unregister notifications and remove all entries. Called by the module. */
+	void Shutdown();
+
+	/**
+	 * Evaluate a condition using a cached query state.
+	 * @param Owner The object that owns the condition.
+	 * @param Condition The condition to evaluate, which is only cached if it's a member of the owner.
+	 * @param Schema The schema to use for context data.
+	 * @param SetContextData Called to set context data values before evaluating, which should set the same values every time.
+	 * @return True if the condition passed, or is empty.
+	 */
+	bool Evaluate(const UObject& Owner, const FWorldConditionQueryDefinition& Condition, const UWorldConditionSchema& Schema,
+	              TFunctionRef<void(FWorldConditionContextData& ContextData)> SetContextData);
+
+	/** Remove all entries. */
+	void Reset();
+
+	/** Return the number of cached query states. */
+	int32 Num() const { return Entries.Num(); }
+
+	// FGCObject
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+
+private:
+	struct FEntry
+	{
+		FWorldConditionQueryState State;
+
+		TOptional<FWorldConditionContextData> ContextData;
+
+		/** True while the entry is being evaluated, in case a condition evaluates itself recursively. */
+		bool bInUse = false;
+	};
+
+	/** The owner, the offset of the condition within the owner, and the schema. */
+	using FKey = TTuple<TObjectKey<UObject>, uint32, TObjectKey<UWorldConditionSchema>>;
+
+	/** Entries are allocated separately, so that they stay in place if the map changes while evaluating. */
+	TMap<FKey, TUniquePtr<FEntry>> Entries;
+
+	FDelegateHandle PostGarbageCollectHandle;
+	FDelegateHandle WorldCleanupHandle;
+
+#if WITH_EDITOR
+	FDelegateHandle ObjectPropertyChangedHandle;
+#endif
+
+	/** Evaluate a condition using a temporary query state. */
+	static bool EvaluateUncached(const UObject& Owner, const FWorldConditionQueryDefinition& Condition, const UWorldConditionSchema& Schema,
+	                             TFunctionRef<void(FWorldConditionContextData& ContextData)> SetContextData);
+
+	void OnPostGarbageCollect();
+
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+#if WITH_EDITOR
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+#endif
+};
@@ -16,6 +16,7 @@ class UGameItemDef;
 class UGameItemSet;
 class UGameItemSetEntrySelector;
 class UGameItemSetEntrySelector_Random;
+struct FGameItemDropTableRow;
 
 
 /**
@@ -33,17 +34,30 @@ struct FGameItemDropContent
 
 	virtual ~FGameItemDropContent() = default;
 
+	/** Perform a random check to see if any content should be given, using the context's Chance roll. */
+	virtual bool ShouldGiveContent(const FGameItemDropContext& Context) const;
+
 	/** Perform a random check to see if any content should be given. */
+	UE_DEPRECATED(5.7, "Use ShouldGiveContent with a drop context instead, so that seeded contexts are respected")
 	virtual bool ShouldGiveContent() const;
 
 	/** Perform a random probability test, then select and return items for this content if passed. */
 	virtual void CheckAndSelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const;
 
-	/** Select and return items for this content. */
+	/**
+	 * Select and return items for this content.
+	 * Nested content should be given a sub context for its index, see FGameItemDropContext::MakeSubContext.
+	 */
 	virtual void SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const;
 
 	/** Called when the owning data table row has changed. */
 	virtual void OnDataChanged();
+
+	/**
+	 * Gather the soft references that may be loaded when selecting items from this content, including nested content.
+	 * @param VisitedRows The drop table rows already gathered, to avoid visiting included rows more than once.
+	 */
+	virtual void GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const;
 };
 
 
@@ -57,6 +71,9 @@ struct FGameItemDropChancedContent : public FGameItemDropContent
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = "0", ClampMax = "1", DisplayPriority = -1))
 	float Chance = 1.f;
 
+	virtual bool ShouldGiveContent(const FGameItemDropContext& Context) const override;
+
+	UE_DEPRECATED(5.7, "Use ShouldGiveContent with a drop context instead, so that seeded contexts are respected")
 	virtual bool ShouldGiveContent() const override;
 };
 
@@ -72,6 +89,8 @@ struct FGameItemDropContent_Combine : public FGameItemDropChancedContent
 	TArray<TInstancedStruct<FGameItemDropContent>> Contents;
 
 	virtual void SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const override;
+	virtual void OnDataChanged() override;
+	virtual void GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const override;
 };
 
 
@@ -102,6 +121,12 @@ struct FGameItemDropContent_Select : public FGameItemDropChancedContent
 	TArray<FWeightedGameItemDropContent> WeightedContents;
 
 	virtual void SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const override;
+	virtual void OnDataChanged() override;
+	virtual void GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const override;
+
+protected:
+	/** Alias table built from the content probabilities on first use, and reset when the data changes. */
+	mutable FGameItemAliasTable AliasTable;
 };
 
 
@@ -118,6 +143,7 @@ struct FGameItemDropContent_Item : public FGameItemDropChancedContent
 	TSoftClassPtr<UGameItemDef> ItemDef = nullptr;
 
 	virtual void SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const override;
+	virtual void GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const override;
 };
 
 
@@ -142,6 +168,7 @@ struct FGameItemDropContent_ItemSet : public FGameItemDropChancedContent
 	TInstancedStruct<FGameItemDropParams> Params;
 
 	virtual void SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const override;
+	virtual void GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const override;
 };
 
 
@@ -163,4 +190,5 @@ struct FGameItemDropContent_DropTableEntry : public FGameItemDropChancedContent
 	FDataTableRowHandle DropTableRow;
 
 	virtual void SelectItems(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const override;
+	virtual void GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const override;
 };
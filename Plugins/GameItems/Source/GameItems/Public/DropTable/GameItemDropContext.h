@@ -8,6 +8,20 @@
 #include "GameItemDropContext.generated.h"
 
 
+/**
+ * The independent random rolls that drop content and item set selectors can make,
+ * each of which uses its own random stream. See FGameItemDropContext::MakeRandomStream.
+ */
+enum class EGameItemDropRoll : uint8
+{
+	/** The roll to decide whether chanced content gives anything. */
+	Chance,
+	/** The roll to select a weighted entry. */
+	Selection,
+	/** The roll to decide an item quantity, e.g. from an econ value range. */
+	Quantity,
+};
+
 /**
  * Contextual info that is passed around when selecting items from a drop table.
  * Contains the params and other info.
@@ -22,4 +36,38 @@ struct GAMEITEMS_API FGameItemDropContext
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TInstancedStruct<FGameItemDropParams> Params;
+
+	/**
+	 * Use Seed for all random rolls, so that the selected items only depend on the drop table, context and seed.
+	 * Otherwise, rolls are made using random seeds.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseSeed = false;
+
+	/**
+	 * The seed for random rolls made by the content using this context.
+	 * Nested content uses seeds derived from this one, see MakeSubContext.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (EditCondition = "bUseSeed"))
+	int32 Seed = 0;
+
+	/** Return a random stream to use for a roll, which is independent of the streams for other rolls and nested content. */
+	FRandomStream MakeRandomStream(EGameItemDropRoll Roll) const
+	{
+		return MakeRandomStream(bUseSeed, Seed, Roll);
+	}
+
+	/** Return a copy of this context to use for nested content, e.g. the child content at an index. */
+	FGameItemDropContext MakeSubContext(int32 ChildIndex) const
+	{
+		FGameItemDropContext SubContext = *this;
+		SubContext.Seed = DeriveSeed(Seed, ChildIndex);
+		return SubContext;
+	}
+
+	/** Return a random stream for a roll, using a seed if bInUseSeed is true, or a random seed otherwise. */
+	static FRandomStream MakeRandomStream(bool bInUseSeed, int32 InSeed, EGameItemDropRoll Roll);
+
+	/** Return the seed to use for the nested content at an index. */
+	static int32 DeriveSeed(int32 InSeed, int32 ChildIndex);
 };
@@ -0,0 +1,146 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameItemTypes.h"
+#include "StructUtils/InstancedStruct.h"
+#include <atomic>
+
+class UGameItemDef;
+class UGameItemSet;
+class UGameItemSetEntrySelector;
+struct FGameItemDropContent;
+struct FGameItemDropContext;
+struct FGameItemDropParams;
+struct FGameItemDropTableRow;
+
+
+/**
+ * The types of nodes in a compiled drop program.
+ */
+enum class EGameItemDropNodeType : uint8
+{
+	/** Gives nothing, e.g. for missing content or drop table rows. */
+	None,
+	/** Runs all child nodes. */
+	Combine,
+	/** Runs one child node, selected using an alias table. */
+	Select,
+	/** Gives an item. */
+	Item,
+	/** Gives items selected from an item set. */
+	ItemSet,
+	/** Runs a single child node with overridden drop params, e.g. the content of another drop table row. */
+	Params,
+	/** Calls SelectItems on content of a type that can't be compiled. */
+	Content,
+};
+
+
+/**
+ * A drop table row compiled into a flat array of nodes, with drop table rows, item definitions and
+ * item sets resolved ahead of time, and alias tables for all weighted selections.
+ * Running the program produces the same results as selecting items from the row's content directly,
+ * including the rolls made for a seeded context.
+ *
+ * Programs are compiled on first use and cached by each FGameItemDropTableRow.
+ * All programs are recompiled after any drop table row changes, since rows may include each other.
+ */
+struct GAMEITEMS_API FGameItemDropProgram
+{
+	struct FNode
+	{
+		EGameItemDropNodeType Type = EGameItemDropNodeType::None;
+
+		/** Roll against Chance before running the node. */
+		bool bRollChance = false;
+
+		float Chance = 1.f;
+
+		/** The range of this node's children in the Children array. */
+		int32 FirstChild = 0;
+		int32 NumChildren = 0;
+
+		/** The index of the alias table for a Select node. */
+		int32 AliasTable = INDEX_NONE;
+
+		/** The count of an Item node. */
+		int32 Count = 0;
+
+		/** The item definition of an Item node, resolved when compiling if it was already loaded. */
+		TWeakObjectPtr<UClass> ItemDef;
+
+		/** The item set of an ItemSet node, resolved when compiling if it was already loaded. */
+		TWeakObjectPtr<const UGameItemSet> ItemSet;
+
+		TWeakObjectPtr<const UGameItemSetEntrySelector> Selector;
+
+		/** The params to override for an ItemSet or Params node, pointing into the drop table row. */
+		const TInstancedStruct<FGameItemDropParams>* Params = nullptr;
+
+		/**
+		 * The content this node was compiled from, pointing into the drop table row.
+		 * Used to run Content nodes, and to load item definitions and sets that weren't loaded when compiling.
+		 */
+		const FGameItemDropContent* Content = nullptr;
+	};
+
+	/** Compile a drop table row into a new program. */
+	static TSharedRef<FGameItemDropProgram> Compile(const FGameItemDropTableRow& Row);
+
+	/** Invalidate all compiled programs, so that they are recompiled on next use. */
+	static void InvalidateAll();
+
+	/** Return true if compiled programs should be used when selecting items from drop tables. */
+	static bool IsEnabled();
+
+	/** Return true if this program was compiled from a row, and is still valid. */
+	bool IsValidFor(const FGameItemDropTableRow& Row) const;
+
+	/** Select items by running this program. */
+	void Execute(const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const;
+
+	/**
+	 * Prepare to run this program on worker threads. Called on the game thread.
+	 * Return false if the program must run on the game thread, e.g. because it uses
+	 * custom content, blueprint selectors, or item sets with conditions.
+	 */
+	bool PrepareParallelExecution() const;
+
+	int32 NumNodes() const { return Nodes.Num(); }
+
+private:
+	TArray<FNode> Nodes;
+
+	/** The child node indices of all nodes. */
+	TArray<int32> Children;
+
+	TArray<FGameItemAliasTable> AliasTables;
+
+	/** The row this program was compiled from. */
+	const FGameItemDropTableRow* SourceRow = nullptr;
+
+	/** The global data version when this program was compiled. */
+	uint32 DataVersion = 0;
+
+	/** Incremented whenever any drop table data changes. */
+	static std::atomic<uint32> GlobalDataVersion;
+
+	/** Compile content and its children, returning the index of its node. */
+	int32 CompileContent(const TInstancedStruct<FGameItemDropContent>& Content, TArray<const FGameItemDropTableRow*>& RowStack);
+
+	/** Set the children of a node, after they have all been compiled. */
+	void SetChildren(int32 NodeIdx, TConstArrayView<int32> ChildNodes);
+
+	int32 AddNode(EGameItemDropNodeType Type);
+
+	/**
+	 * Run a node. Seed is the node's own seed, which is only stored in a context when the context must be
+	 * passed on, e.g. to an item set selector, so that nested content doesn't need to copy the context.
+	 */
+	void ExecuteNode(int32 NodeIdx, const FGameItemDropContext& Context, int32 Seed, TArray<FGameItemDefStack>& OutItems) const;
+
+	/** Run an ItemSet or Content node, which passes the context on. */
+	void ExecuteNodeWithContext(const FNode& Node, const FGameItemDropContext& Context, TArray<FGameItemDefStack>& OutItems) const;
+};
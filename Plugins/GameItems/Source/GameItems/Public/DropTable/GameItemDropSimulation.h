@@ -0,0 +1,99 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameItemDropContext.h"
+#include "Templates/SubclassOf.h"
+
+class UGameItemDef;
+struct FGameItemDropTableRow;
+
+
+/**
+ * The results for one item definition in a drop simulation.
+ */
+struct GAMEITEMS_API FGameItemDropSimulationItemStats
+{
+	TSubclassOf<UGameItemDef> ItemDef;
+
+	/** The number of rolls that gave this item. */
+	int64 NumRollsDropped = 0;
+
+	/** The total count given across all rolls. */
+	int64 TotalCount = 0;
+
+	/** The number of rolls that gave each total count of this item. */
+	TMap<int32, int64> CountHistogram;
+
+	/** The econ value of one of this item, or 0 if it has no econ value. */
+	float EconValue = 0.f;
+};
+
+
+/**
+ * The results of rolling a drop table row many times.
+ */
+struct GAMEITEMS_API FGameItemDropSimulationResult
+{
+	FString Name;
+
+	int32 NumRolls = 0;
+
+	/** The number of tasks the rolls were split across, or 1 if they ran on the game thread. */
+	int32 NumTasks = 1;
+
+	double Seconds = 0.0;
+
+	/** The stats for each item definition that dropped, sorted by drop rate. */
+	TArray<FGameItemDropSimulationItemStats> Items;
+
+	/** The number of rolls that gave each number of item stacks. */
+	TMap<int32, int64> NumStacksHistogram;
+
+	/** The total econ value of all items given. */
+	double TotalEconValue = 0.0;
+
+	double GetRollsPerSecond() const
+	{
+		return Seconds > 0.0 ? NumRolls / Seconds : 0.0;
+	}
+
+	double GetExpectedEconValue() const
+	{
+		return NumRolls > 0 ? TotalEconValue / NumRolls : 0.0;
+	}
+
+	/** Print a summary of the results. */
+	void Dump(FOutputDevice& Ar) const;
+
+	FString ToJson() const;
+
+	/** Return the results for each item as csv. */
+	FString ToCsv() const;
+};
+
+
+/**
+ * Rolls drop table rows many times without creating any items, for balancing loot and measuring drop performance.
+ * Each roll uses a seed derived from the simulation seed and the roll index, so results are repeatable
+ * regardless of how many threads are used.
+ *
+ * Rolls run on worker threads when the row's compiled drop program allows it, see FGameItemDropProgram::PrepareParallelExecution.
+ * Otherwise, they run on the game thread. See also the GameItemDropSimulation commandlet in GameItemsEditor.
+ */
+struct GAMEITEMS_API FGameItemDropSimulation
+{
+	struct FParams
+	{
+		int32 NumRolls = 10000;
+
+		/** The maximum number of tasks to split rolls across, or 0 to use all worker threads. */
+		int32 MaxTasks = 0;
+
+		int32 Seed = 0;
+	};
+
+	/** Roll a drop table row many times and return the results. Must be called on the game thread. */
+	static FGameItemDropSimulationResult Run(const FGameItemDropTableRow& Row, const FGameItemDropContext& Context, const FParams& Params);
+};
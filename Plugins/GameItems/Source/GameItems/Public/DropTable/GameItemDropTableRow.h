@@ -4,7 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameItemDropContent.h"
-#include "InstancedStruct.h"
+#include "GameItemDropProgram.h"
+#include "StructUtils/InstancedStruct.h"
 #include "Engine/DataTable.h"
 #include "GameItemDropTableRow.generated.h"
 
@@ -21,5 +22,21 @@ struct GAMEITEMS_API FGameItemDropTableRow : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ExcludeBaseStruct, ShowTreeView))
 	TInstancedStruct<FGameItemDropContent> Content = TInstancedStruct<FGameItemDropContent>::Make<FGameItemDropContent_Item>();
 
+	/** Gather the soft references that may be loaded when selecting items from this row, including from other rows. */
+	void GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/** Gather soft references, skipping this row if it has already been visited. */
+	void GatherSoftReferences(TArray<FSoftObjectPath>& OutPaths, TSet<const FGameItemDropTableRow*>& VisitedRows) const;
+
+	/** Return the compiled program for this row, compiling it first if needed. Safe to call from any thread. */
+	TSharedRef<const FGameItemDropProgram> GetProgram() const;
+
 	virtual void OnDataTableChanged(const UDataTable* InDataTable, const FName InRowName) override;
+
+protected:
+	/**
+	 * The compiled program, created on first use and invalidated when any drop table changes.
+	 * Guarded by a lock shared by all rows, since rows are copyable and may be used from worker threads.
+	 */
+	mutable TSharedPtr<const FGameItemDropProgram> Program;
 };
@@ -9,6 +9,7 @@
 #include "GameItemSetEntrySelector.generated.h"
 
 class UGameItemSet;
+struct FGameItemSetSelectionCache;
 
 
 /**
@@ -24,10 +25,16 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	bool bUseDropRules = true;
 
-	/** Select one or more items from a game item set. */
+	/**
+	 * Select one or more items from a game item set.
+	 * Random rolls should use Context.MakeRandomStream, so that selection is repeatable for seeded contexts.
+	 */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "GameItems")
 	void SelectItems(const FGameItemDropContext& Context, const UGameItemSet* ItemSet, TArray<FGameItemDefStack>& OutItems) const;
 
+	/** Called directly instead of SelectItems when selecting on worker threads, where blueprint events can't be called. */
+	virtual void SelectItems_Implementation(const FGameItemDropContext& Context, const UGameItemSet* ItemSet, TArray<FGameItemDefStack>& OutItems) const;
+
 	/** Return true if an item passes all conditions and can be selected. */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "GameItems")
 	bool CanSelectItem(const FGameItemDropContext& Context, const UGameItemSet* ItemSet, const FGameItemDefStack& Entry) const;
@@ -36,9 +43,28 @@ public:
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "GameItems")
 	float GetItemProbability(const FGameItemDropContext& Context, const UGameItemSet* ItemSet, const FGameItemDefStack& Entry) const;
 
+	/**
+	 * Prepare to select items from a set on worker threads, e.g. by building cached data.
+	 * Called on the game thread. Return false if selection must happen on the game thread.
+	 * Only native selectors can select on worker threads, and SelectItems_Implementation must not call any blueprint events.
+	 */
+	virtual bool PrepareParallelSelection(const UGameItemSet* ItemSet) const;
+
 protected:
 	virtual void GetFilteredAndWeightedItems(const FGameItemDropContext& Context, const UGameItemSet* ItemSet,
 	                                         TArray<FGameItemDefStack>& OutFilteredItems, TArray<float>& OutProbabilities) const;
+
+	/**
+	 * Return true if this selector's CanSelectItem and GetItemProbability don't depend on the drop context,
+	 * so that item weights can be cached for each set. False by default, selectors must opt in by overriding this.
+	 */
+	virtual bool IsSelectionContextFree() const;
+
+	/** Return true if the item weights of a set can be cached, since neither this selector nor any item drop rules use the context. */
+	bool CanCacheSelection(const UGameItemSet* ItemSet) const;
+
+	/** Return the cached selection data for an item set, building it if needed. */
+	const FGameItemSetSelectionCache& GetSelectionCache(const UGameItemSet* ItemSet) const;
 };
 
 
@@ -53,6 +79,7 @@ class UGameItemSetEntrySelector_All : public UGameItemSetEntrySelector
 public:
 	virtual void SelectItems_Implementation(const FGameItemDropContext& Context, const UGameItemSet* ItemSet,
 	                                        TArray<FGameItemDefStack>& OutItems) const override;
+	virtual bool PrepareParallelSelection(const UGameItemSet* ItemSet) const override;
 };
 
 
@@ -71,4 +98,9 @@ public:
 
 	virtual void SelectItems_Implementation(const FGameItemDropContext& Context, const UGameItemSet* ItemSet,
 	                                        TArray<FGameItemDefStack>& OutItems) const override;
+	virtual bool PrepareParallelSelection(const UGameItemSet* ItemSet) const override;
+
+protected:
+	/** Uses the default item filtering and probabilities. Subclasses that override either must override this again. */
+	virtual bool IsSelectionContextFree() const override;
 };
@@ -0,0 +1,114 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Templates/SubclassOf.h"
+#include "UObject/Interface.h"
+#include "UObject/ObjectKey.h"
+#include "GameEquipmentActorPool.generated.h"
+
+
+UINTERFACE(BlueprintType)
+class UGameEquipmentPooledActorInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+
+/**
+ * Interface for equipment actors that are reused by UGameEquipmentActorPool,
+ * allowing them to reset their state when taken from or returned to the pool.
+ */
+class GAMEITEMS_API IGameEquipmentPooledActorInterface
+{
+	GENERATED_BODY()
+
+public:
+	/** Called when the actor is taken from the pool, before it is attached to its new owner. */
+	UFUNCTION(BlueprintNativeEvent, Category = "Equipment")
+	void OnAcquiredFromPool();
+	virtual void OnAcquiredFromPool_Implementation() {}
+
+	/** Called when the actor is returned to the pool, after it has been detached and hidden. */
+	UFUNCTION(BlueprintNativeEvent, Category = "Equipment")
+	void OnReleasedToPool();
+	virtual void OnReleasedToPool_Implementation() {}
+};
+
+
+/** The inactive actors of one class in a UGameEquipmentActorPool. */
+USTRUCT()
+struct FGameEquipmentActorPoolEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AActor>> Actors;
+};
+
+
+/**
+ * Keeps inactive equipment actors by class so they can be reused instead of being spawned
+ * and destroyed every time equipment is equipped or unequipped.
+ *
+ * Pooled actors are hidden, detached, stop replicating, and have collision and actor and component ticking disabled.
+ * Reused actors have these restored from their class defaults, and pools are only warmed up on the server or standalone.
+ * Actors can implement IGameEquipmentPooledActorInterface to reset any other state.
+ * Only equipment actors with FGameEquipmentActorSpawnInfo::bUsePool are pooled,
+ * see UGameItemSettings for the pool size and warm up settings.
+ */
+UCLASS()
+class GAMEITEMS_API UGameEquipmentActorPool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Return the equipment actor pool given a world context object. */
+	static UGameEquipmentActorPool* Get(const UObject* WorldContextObject);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Return an inactive actor of a class from the pool, or spawn a new one if the pool is empty. */
+	AActor* AcquireActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner);
+
+	/** Return an actor to the pool. Actors that weren't spawned by the pool, or don't fit in it, are destroyed. */
+	void ReleaseActor(AActor* Actor);
+
+	/** Spawn inactive actors of a class until the pool contains at least Count of them. */
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	void WarmUp(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	/** Destroy all inactive actors in the pool. */
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	void Empty();
+
+	/** Return the number of inactive actors of a class in the pool. */
+	UFUNCTION(BlueprintPure, Category = "Equipment")
+	int32 GetNumPooledActors(TSubclassOf<AActor> ActorClass) const;
+
+	/** Return true if pooling is enabled. */
+	static bool IsEnabled();
+
+protected:
+	/** Inactive actors by class. */
+	UPROPERTY(Transient)
+	TMap<TSubclassOf<AActor>, FGameEquipmentActorPoolEntry> PooledActors;
+
+	/** All actors spawned by the pool that haven't been destroyed, whether active or not. */
+	TSet<TObjectKey<AActor>> ManagedActors;
+
+	AActor* SpawnActor(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner);
+
+	UFUNCTION()
+	void OnManagedActorDestroyed(AActor* DestroyedActor);
+
+	/** Hide and disable an actor while it's in the pool. */
+	virtual void DeactivateActor(AActor* Actor);
+
+	/** Show and enable an actor that was in the pool, restoring the state of its class defaults. */
+	virtual void ActivateActor(AActor* Actor, const FTransform& Transform, AActor* Owner);
+};
@@ -10,6 +10,8 @@
 class UGameEquipment;
 class UGameEquipmentDef;
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FPendingEquipmentFinishedDynDelegate);
+
 
 /**
  * Handles adding and removing game equipment on the owning actor.
@@ -64,6 +66,14 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Equipment")
 	UGameEquipment* FindEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef) const;
 
+	/** Find all applied equipment by definition. */
+	UFUNCTION(BlueprintPure, Category = "Equipment")
+	TArray<UGameEquipment*> FindAllEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef) const;
+
+	/** Return true if an equipment instance is currently applied. */
+	UFUNCTION(BlueprintPure, Category = "Equipment")
+	bool HasEquipment(const UGameEquipment* Equipment) const;
+
 	/** Return all instances of applied equipment by class. */
 	UFUNCTION(BlueprintPure, Meta = (DeterminesOutputType = EquipmentClass), Category = "Equipment")
 	TArray<UGameEquipment*> FindAllEquipment(TSubclassOf<UGameEquipment> EquipmentClass) const;
@@ -72,8 +82,35 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "Equipment")
 	TArray<UGameEquipment*> GetAllEquipment() const;
 
+	/** Return true if any equipment is waiting to be equipped. */
+	UFUNCTION(BlueprintPure, Category = "Equipment")
+	bool HasPendingEquipment() const { return !PendingEquipment.IsEmpty(); }
+
+	/** Immediately equip all equipment that is waiting to be equipped. */
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	void FlushPendingEquipment();
+
+	/** Equip the next pending equipment, called by UGameEquipmentSubsystem while within the frame budget. */
+	void EquipNextPendingEquipment();
+
 	FString GetDebugPrefix() const;
 
+	DECLARE_MULTICAST_DELEGATE(FPendingEquipmentFinishedDelegate);
+
+	/** Called when all deferred equipment has been equipped. */
+	FPendingEquipmentFinishedDelegate OnPendingEquipmentFinishedEvent;
+
+	/** Called when all deferred equipment has been equipped. */
+	UPROPERTY(BlueprintAssignable, Category = "Equipment")
+	FPendingEquipmentFinishedDynDelegate OnPendingEquipmentFinished;
+
+	/**
+	 * Equip applied equipment over multiple frames instead of immediately, in order of EquipPriority.
+	 * The time spent equipping each frame is shared by all components in the world, see UGameEquipmentSubsystem.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Equipment")
+	bool bDeferEquip = false;
+
 protected:
 	UFUNCTION(Server, Reliable)
 	void ServerApplyEquipmentSpec(const FGameEquipmentSpec& EquipmentSpec);
@@ -92,7 +129,19 @@ protected:
 	void OnPostReplicatedAdd(FGameEquipmentListEntry& Entry);
 	void OnPostReplicatedChange(FGameEquipmentListEntry& Entry);
 
+	/** Equip equipment now, or queue it to be equipped later if bDeferEquip is enabled. */
+	void EquipOrQueue(UGameEquipment* Equipment);
+
+	/** Remove equipment from the pending queue and unequip it. */
+	void UnequipAndDequeue(UGameEquipment* Equipment);
+
+	void BroadcastPendingEquipmentFinished();
+
 protected:
 	UPROPERTY(Transient, Replicated)
 	FGameEquipmentList EquipmentList;
+
+	/** Equipment waiting to be equipped, sorted by descending EquipPriority. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UGameEquipment>> PendingEquipment;
 };
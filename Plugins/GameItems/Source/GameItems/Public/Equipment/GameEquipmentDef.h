@@ -30,4 +30,11 @@ public:
 	/** Actors to spawn when equipped. */
 	UPROPERTY(EditDefaultsOnly, Category = "Equipment")
 	TArray<FGameEquipmentActorSpawnInfo> ActorsToSpawn;
+
+	/**
+	 * When equipment is deferred and equipped over multiple frames, equipment with higher priority is equipped first.
+	 * E.g. weapons should be higher than cosmetics.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Equipment")
+	int32 EquipPriority = 0;
 };
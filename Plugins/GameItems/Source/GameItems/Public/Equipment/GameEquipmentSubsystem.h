@@ -0,0 +1,42 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameEquipmentSubsystem.generated.h"
+
+class UGameEquipmentComponent;
+
+
+/**
+ * Equips deferred equipment for all UGameEquipmentComponents in a world, within a shared time budget each frame.
+ * Components take turns equipping one piece of equipment at a time, continuing from where the previous frame
+ * stopped, so that components with a lot of pending equipment can't starve the others.
+ * See GameItems.Equipment.EquipBudgetMs.
+ */
+UCLASS()
+class GAMEITEMS_API UGameEquipmentSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Return the equipment subsystem given a world context object. */
+	static UGameEquipmentSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Register a component that has equipment waiting to be equipped. */
+	void AddPendingComponent(UGameEquipmentComponent* Component);
+
+protected:
+	/** Components that may have pending equipment, in the order they take turns. */
+	TArray<TWeakObjectPtr<UGameEquipmentComponent>> PendingComponents;
+
+	/** The index of the component that equips next. */
+	int32 NextComponentIdx = 0;
+};
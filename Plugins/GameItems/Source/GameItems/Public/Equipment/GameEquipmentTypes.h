@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameItemTypes.h"
+#include "GameItemsNetStats.h"
 #include "Net/Serialization/FastArraySerializer.h"
 #include "Templates/SubclassOf.h"
 #include "GameEquipmentTypes.generated.h"
@@ -106,6 +107,13 @@ struct FGameEquipmentActorSpawnInfo
 	/** How the equipment actor should be spawned in networked games. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	EGameEquipmentActorSpawnPolicy NetSpawnPolicy = EGameEquipmentActorSpawnPolicy::ServerInitiated;
+
+	/**
+	 * Reuse actors from the world's UGameEquipmentActorPool instead of spawning and destroying them.
+	 * The actor must be able to be hidden and reused, see IGameEquipmentPooledActorInterface.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUsePool = false;
 };
 
 
@@ -154,6 +162,7 @@ struct FGameEquipmentList : public FFastArraySerializer
 
 	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
 	{
+		FGameItemsNetStatsSerializeScope NetStatsScope(EGameItemsNetStatCategory::EquipmentList, DeltaParms);
 		return FFastArraySerializer::FastArrayDeltaSerialize<FGameEquipmentListEntry, FGameEquipmentList>(Entries, DeltaParms, *this);
 	}
 
@@ -162,11 +171,37 @@ struct FGameEquipmentList : public FFastArraySerializer
 
 	const TArray<FGameEquipmentListEntry>& GetEntries() const { return Entries; }
 
+	/** Return true if the list contains a valid equipment instance. */
+	bool Contains(const UGameEquipment* Equipment) const;
+
+	/** Return the first valid equipment instance that was created from a definition. */
+	UGameEquipment* FindEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef) const;
+
+	/** Return all valid equipment instances that were created from a definition. */
+	void FindAllEquipmentByDef(TSubclassOf<UGameEquipmentDef> EquipmentDef, TArray<UGameEquipment*>& OutEquipment) const;
+
 protected:
 	/** Replicated list of equipment entries */
 	UPROPERTY()
 	TArray<FGameEquipmentListEntry> Entries;
 
+	/** The index of each entry, by equipment instance. */
+	mutable TMap<const UGameEquipment*, int32> EntryIndicesByEquipment;
+
+	/** The indices of entries by equipment definition, in the order they were added. */
+	mutable TMultiMap<const UClass*, int32> EntryIndicesByDef;
+
+	/** True when entries have been removed or replicated, and the cached lookups need to be rebuilt. */
+	mutable bool bIndexCacheDirty = true;
+
+	/** Rebuild the cached lookups if needed. */
+	void UpdateIndexCache() const;
+
+	/** Add an entry to the cached lookups, if it has valid equipment. */
+	void AddToIndexCache(int32 Idx) const;
+
+	FORCEINLINE void MarkIndexCacheDirty() { bIndexCacheDirty = true; }
+
 public:
 	DECLARE_MULTICAST_DELEGATE_OneParam(FGameEquipmentListReplicateDelegate, FGameEquipmentListEntry& /*Entry*/);
 
@@ -29,6 +29,12 @@ struct FGameItemEquipmentConditionState
 	/** The conditions state. */
 	UPROPERTY(Transient)
 	FWorldConditionQueryState State;
+
+	/**
+	 * Hash of the containers and slots the item was in when the condition was last checked,
+	 * which are the inputs that can mark the condition dirty.
+	 */
+	uint32 InputsHash = 0;
 };
 
 
@@ -83,6 +89,27 @@ protected:
 	/** Check and re-apply the equipment for an item if the conditions are met. */
 	void CheckItemEquipmentCondition(UGameItem* Item, const UGameItemFragment_Equipment* EquipFrag);
 
+	/**
+	 * Queue an item's equipment condition to be checked on the next tick, once per item no matter how many times it changes.
+	 * The condition is only checked if the item's containers or slots are different from when it was last checked.
+	 */
+	void MarkItemConditionDirty(UGameItem* Item);
+
+	/**
+	 * Apply the net change in equipment since the last reconcile. Removes equipment for items that
+	 * were removed and not re-added, and checks the equipment conditions of all items that changed.
+	 */
+	void ReconcileItemEquipment();
+
+	/** Reconcile item equipment on the next tick, or immediately if there is no world. */
+	void ScheduleReconcileItemEquipment();
+
+	/**
+	 * Return a hash of the containers an item is in, and its slot in each unless bIgnoreSlotChangesWithinContainer is set.
+	 * These are the inputs that mark an item's equipment condition dirty.
+	 */
+	uint32 GetItemConditionInputsHash(const UGameItem* Item) const;
+
 	/** Remove equipment and deactivate the conditions for an item. */
 	void DeactivateItemEquipmentCondition(UGameItem* Item, const UGameItemFragment_Equipment* EquipFrag);
 
@@ -102,6 +129,23 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	bool bAutoFindContainerComponent = true;
 
+	/**
+	 * Only re-check an item's equipment condition when the containers it's in have changed,
+	 * ignoring moves between slots of the same container, e.g. when sorting.
+	 * Only enable this if no equipment conditions depend on which slot an item is in.
+	 * Otherwise conditions are re-checked when either the containers or slots of an item have changed.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	bool bIgnoreSlotChangesWithinContainer = false;
+
+	/**
+	 * Wait until the next tick to remove equipment for items that were removed, so that items moved
+	 * between containers keep their equipment instead of being unequipped and equipped again.
+	 * This delays every unequip by a frame, so only enable it if items are frequently moved between containers.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	bool bDeferEquipmentRemoval = false;
+
 protected:
 	/** The item containers to monitor for items with equipment. */
 	TArray<TWeakObjectPtr<UGameItemContainerComponent>> RegisteredContainerComponents;
@@ -110,6 +154,19 @@ protected:
 	UPROPERTY(Transient)
 	TMap<TObjectPtr<UGameItem>, FGameItemEquipmentConditionState> ItemConditionStates;
 
+	/** Items whose equipment conditions should be checked on the next tick. */
+	UPROPERTY(Transient)
+	TSet<TObjectPtr<UGameItem>> DirtyConditionItems;
+
+	/**
+	 * Items that were removed from a registered container component since the last reconcile.
+	 * Their equipment is only removed if they haven't been added back by then, e.g. when moving between containers.
+	 */
+	UPROPERTY(Transient)
+	TSet<TObjectPtr<UGameItem>> PendingRemovedItems;
+
+	FTimerHandle ReconcileItemEquipmentTimer;
+
 	/** Map of equipment definitions that were applied by source item, for removal. */
 	UPROPERTY(Transient)
 	TMap<TObjectPtr<UGameItem>, TSubclassOf<UGameEquipmentDef>> ItemEquipmentDefs;
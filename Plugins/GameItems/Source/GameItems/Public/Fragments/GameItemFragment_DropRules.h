@@ -33,4 +33,8 @@ public:
 	virtual float GetProbability(const FGameItemDropContext& Context) const;
 
 	virtual bool IsConditionMet(const FGameItemDropContext& Context) const;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 };
@@ -101,6 +101,9 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "GameItems")
 	TArray<UGameItemContainer*> GetContainers() const;
 
+	/** Return all containers that this item is in, without copying. May include containers that have been destroyed. */
+	const TArray<TWeakObjectPtr<UGameItemContainer>>& GetWeakContainers() const { return Containers; }
+
 	/** Return a debug string representation of this item instance. */
 	UFUNCTION(BlueprintPure, Category = "GameItems")
 	FString GetDebugString() const;
@@ -139,6 +142,9 @@ protected:
 	/** Clear all prediction / pending state variables (usually as part of accepting or rejecting the changes). */
 	void ResetPredictionState();
 
+	/** Register the pending prediction key with all containers of this item, so they can find it quickly when confirmed. */
+	void RegisterPendingNetChange();
+
 public:
 	DECLARE_MULTICAST_DELEGATE_ThreeParams(FCountChangedDelegate, UGameItem* /*Item*/, int32 /*NewCount*/, int32 /*OldCount*/);
 	DECLARE_MULTICAST_DELEGATE_FourParams(FTagStatChangedDelegate, UGameItem* /*Item*/, const FGameplayTag& /*Tag*/, int32 /*NewValue*/, int32 /*OldValue*/);
@@ -157,6 +163,7 @@ public:
 	/** Called when this item is removed from any container. */
 	FUnslottedDelegate OnUnslottedEvent;
 
+	virtual void BeginDestroy() override;
 	virtual bool IsSupportedForNetworking() const override { return true; }
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
 
@@ -59,6 +59,26 @@ struct FGameItemContainerAddPlan
 };
 
 
+/**
+ * Slots and quantities reserved by add plans that haven't been applied yet.
+ * Used to plan adding several items to the same container at once.
+ */
+struct GAMEITEMS_API FGameItemContainerAddReservations
+{
+	/** The quantity reserved in each slot. */
+	TMap<int32, int32> SlotCounts;
+
+	/** The first item reserved in each slot, used to check stacking with slots that are still empty. */
+	TMap<int32, const UGameItem*> SlotItems;
+
+	/** The quantity reserved for each item definition. */
+	TMap<TSubclassOf<UGameItemDef>, int32> ItemDefCounts;
+
+	/** Reserve all slots and quantities from a plan for adding an item. */
+	void Reserve(const UGameItem* Item, const FGameItemContainerAddPlan& Plan);
+};
+
+
 /**
  * Object that contains one or more game item instances,
  * like an inventory, treasure chest, or just a simple item pickup.
@@ -104,6 +124,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GameItemContainer")
 	FGameplayTagContainer GetOwnedTags() const;
 
+	/** Return true if this container has any of the given tags, without building its owned tags. */
+	bool HasAnyOwnedTags(const FGameplayTagContainer& Tags) const;
+
 	/**
 	 * Check if an item can be fully added to a container and whether it will be split when added.
 	 * @param Item The item to be added.
@@ -114,6 +137,19 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, Meta = (AdvancedDisplay = "2"), Category = "GameItemContainer")
 	FGameItemContainerAddPlan CheckAddItem(UGameItem* Item, int32 TargetSlot = -1, UGameItemContainer* OldContainer = nullptr) const;
 
+	/**
+	 * Check if a batch of items can all be fully added to this container.
+	 * Each item is checked as if the items before it had already been added.
+	 * @param Moves The items to add and their target slots.
+	 * @param OldContainer A container from which the items are being moved, if applicable, which will be used to check collection rules.
+	 * @param OutFailedIndices The indices of moves that will not be fully added.
+	 * @return True if every item will be fully added.
+	 */
+	bool CheckAddItems(TConstArrayView<FGameItemMove> Moves, UGameItemContainer* OldContainer, TArray<int32>& OutFailedIndices) const;
+
+	/** Check adding an item on top of the slots and quantities already reserved by other plans that haven't been applied yet. */
+	FGameItemContainerAddPlan CheckAddItemWithReservations(UGameItem* Item, int32 TargetSlot, const FGameItemContainerAddReservations& Reservations) const;
+
 public:
 	/**
 	 * Add an item to this container. This does not remove the item from any existing containers.
@@ -436,6 +472,15 @@ public:
 	/** Called when a range of item slots have changed. */
 	FItemSlotsChangedDelegate OnItemSlotsChangedEvent;
 
+	/**
+	 * Return an event that is only called when the item in a specific slot has changed.
+	 * Cheaper than OnItemSlotChangedEvent for listeners that only care about one slot, e.g. slot view models.
+	 */
+	FItemSlotChangedDelegate& GetSlotChangedEvent(int32 Slot);
+
+	/** Remove all bindings for an object from the slot changed event of a slot. */
+	void RemoveSlotChangedListener(int32 Slot, const void* UserObject);
+
 	/** Called when the total number of slots has changed. */
 	FNumSlotsChangedDelegate OnNumSlotsChangedEvent;
 
@@ -457,6 +502,20 @@ public:
 	 */
 	bool ItemsExistOnServer() const;
 
+	/**
+	 * Set which connections this container, its items, and its rules replicate to.
+	 * Defaults to the container definition, and must be set before the container is registered for replication.
+	 */
+	void SetReplicationCondition(EGameItemContainerReplicationCondition NewCondition, FName NewNetConditionGroup = NAME_None);
+
+	FORCEINLINE EGameItemContainerReplicationCondition GetReplicationCondition() const { return ReplicationCondition; }
+
+	/** Return the net condition group to replicate to when using the Custom replication condition. */
+	FORCEINLINE FName GetNetConditionGroup() const { return NetConditionGroup; }
+
+	/** Return the lifetime condition to use when registering this container and its subobjects for replication. */
+	ELifetimeCondition GetSubObjectNetCondition() const;
+
 	/** Return the actor that should be used for network role / authority checks. */
 	virtual AActor* GetNetworkOwner() const;
 
@@ -475,6 +534,9 @@ public:
 	/** Accept or reject predicted changes for a key. */
 	virtual void ConfirmPredictionKey(const FGameItemsPredictionKey& PredictionKey, bool bAccepted);
 
+	/** Track an item in this container that has a pending net change, so it can be found quickly when the key is confirmed. */
+	void AddPendingNetChangeItem(const FGameItemsPredictionKey& PredictionKey, UGameItem* Item);
+
 	UFUNCTION(Server, Reliable)
 	void ServerAddItem(UGameItem* Item, int32 TargetSlot = -1);
 
@@ -511,6 +573,12 @@ public:
 protected:
 	static bool IsLocallyControlledActor(const AActor* InActor);
 
+	/**
+	 * Consume the operation budget of the client connection that owns this container.
+	 * Called by server RPC implementations, which ignore the request if this returns false.
+	 */
+	bool ConsumeServerRpcBudget(const TCHAR* FuncName, int32 Cost = 1) const;
+
 public:
 	/** Groups multiple slot changes during the scope, and broadcasts them all when completed. */
 	struct FScopedSlotChanges
@@ -553,6 +621,14 @@ protected:
 	UPROPERTY()
 	TScriptInterface<IGameItemCollectionInterface> Collection;
 
+	/** Determines which connections this container, its items, and its rules replicate to. */
+	UPROPERTY(Transient)
+	EGameItemContainerReplicationCondition ReplicationCondition = EGameItemContainerReplicationCondition::Default;
+
+	/** The net condition group to replicate to when using the Custom replication condition. */
+	UPROPERTY(Transient)
+	FName NetConditionGroup;
+
 	/** Have the default items already been added to this container? */
 	UPROPERTY(Transient, Replicated)
 	bool bHasDefaultItems = false;
@@ -566,12 +642,19 @@ protected:
 	/** Set of slots that were changed during change operations. */
 	TSet<int32> PendingChangedSlots;
 
+	/**
+	 * Events for listeners of individual slots, see GetSlotChangedEvent.
+	 * Shared so that listeners can be added or removed while an event is being broadcast.
+	 */
+	TMap<int32, TSharedRef<FItemSlotChangedDelegate>> SlotChangedEvents;
+
 	/**
 	 * Return a plan representing how an item will be added to this container,
 	 * including exactly which slots and quantities should be added.
 	 * Can be used to check for item loss or split before adding.
 	 */
-	FGameItemContainerAddPlan GetAddItemPlan(UGameItem* Item, int32 TargetSlot = -1, bool bIgnoreCollectionLimit = false, bool bWarn = true) const;
+	FGameItemContainerAddPlan GetAddItemPlan(UGameItem* Item, int32 TargetSlot = -1, bool bIgnoreCollectionLimit = false, bool bWarn = true,
+	                                         const FGameItemContainerAddReservations* Reservations = nullptr) const;
 
 	virtual void OnItemAdded(UGameItem* Item, int32 Slot);
 	virtual void OnItemRemoved(UGameItem* Item, int32 Slot);
@@ -596,6 +679,7 @@ protected:
 
 public:
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void BeginDestroy() override;
 	virtual bool IsSupportedForNetworking() const override;
 	virtual int32 GetFunctionCallspace(UFunction* Function, FFrame* Stack) override;
 	virtual bool CallRemoteFunction(UFunction* Function, void* Parms, struct FOutParmRec* OutParms, FFrame* Stack) override;
@@ -611,6 +695,10 @@ public:
 	UPROPERTY(Transient)
 	TArray<FGameItemPendingAdd> PendingAddExistingItems;
 
+protected:
+	/** Items in this container with pending net changes, by prediction key. */
+	TMap<FGameItemsPredictionKey, TArray<TWeakObjectPtr<UGameItem>>> PendingNetChangeItems;
+
 public:
 	/** Return a readable name for this container object for debugging. */
 	UFUNCTION(BlueprintPure, Category = "GameItems")
@@ -269,6 +269,12 @@ protected:
 	/** Unregister the container and any of its relevant subobjects from replication. */
 	virtual void RemoveReplicatedContainerSubObjects(UGameItemContainer* Container);
 
+	/** Register a container, item, or rule for replication using the replication condition of the container. */
+	void AddReplicatedContainerSubObject(const UGameItemContainer* Container, UObject* SubObject);
+
+	/** Unregister a container, item, or rule from replication, and from the container's net condition group if any. */
+	void RemoveReplicatedContainerSubObject(const UGameItemContainer* Container, UObject* SubObject);
+
 	/** Add new link rules to a container. */
 	void AddMatchingLinkRulesToContainer(UGameItemContainer* Container, const TArray<FActiveGameItemContainerLink>& InLinks);
 
@@ -65,6 +65,20 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network")
 	EGameItemContainerNetExecutionPolicy NetExecutionPolicy = EGameItemContainerNetExecutionPolicy::LocalPredicted;
 
+	/**
+	 * Determines which connections the container, its items, and its rules replicate to.
+	 * Use OwnerOnly for private containers like player bags or quest items that other players never see.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network")
+	EGameItemContainerReplicationCondition ReplicationCondition = EGameItemContainerReplicationCondition::Default;
+
+	/**
+	 * The net condition group to replicate to when using the Custom replication condition.
+	 * Player controllers must be added to the group using APlayerController::IncludeInNetConditionGroup.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Meta = (EditCondition = "ReplicationCondition == EGameItemContainerReplicationCondition::Custom"), Category = "Network")
+	FName NetConditionGroup;
+
 #if WITH_EDITOR
 	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
 #endif
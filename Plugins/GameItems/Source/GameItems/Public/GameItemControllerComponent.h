@@ -26,6 +26,17 @@ public:
 
 	virtual FString GetDebugPrefix() const;
 
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parms, struct FOutParmRec* OutParms, FFrame* Stack) override;
+
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FMoveResultDelegate, const FGameItemsPredictionKey& /*PredictionKey*/, const FGameItemMoveResult& /*Result*/);
+
+	/**
+	 * Called when a move of items from a client-only container has been rejected.
+	 * The prediction key is invalid if the move was rejected locally before being sent.
+	 */
+	FMoveResultDelegate OnMoveResultEvent;
+
 	/** Move an item from one slot to another, swapping or stacking as needed. */
 	UFUNCTION(BlueprintCallable)
 	virtual void MoveSwapOrStackItem(UGameItemContainer* From, UGameItem* Item, UGameItemContainer* To, int32 ToSlot, bool bAllowPartial = true);
@@ -48,6 +59,49 @@ public:
 	 */
 	virtual bool HandleNetMove(const FGameItemMoveSpec& MoveSpec);
 
+	/**
+	 * Begin recording container operations requested by this client.
+	 * Operations that would normally call their own Server RPC are instead sent together in a
+	 * single RPC with one prediction key when the outermost transaction is committed.
+	 */
+	UFUNCTION(BlueprintCallable)
+	virtual void BeginTransaction();
+
+	/** Send all container operations recorded since BeginTransaction to the server. */
+	UFUNCTION(BlueprintCallable)
+	virtual void CommitTransaction();
+
+	/** Return true if container operations are currently being recorded into a transaction. */
+	UFUNCTION(BlueprintPure)
+	bool IsRecordingTransaction() const { return TransactionDepth > 0; }
+
+	/**
+	 * Record an operation in the active transaction of the controller that can control the op's container, if any.
+	 * @return True if the operation was recorded and will be sent to the server later.
+	 */
+	static bool RecordTransactionOp(const FGameItemContainerOp& Op);
+
+	/** Records all container operations made during the scope, and sends them to the server as a single transaction. */
+	struct FScopedTransaction
+	{
+		FScopedTransaction(UGameItemControllerComponent* InController)
+			: Controller(InController)
+		{
+			check(Controller);
+			Controller->BeginTransaction();
+		}
+
+		~FScopedTransaction()
+		{
+			if (Controller)
+			{
+				Controller->CommitTransaction();
+			}
+		}
+
+		UGameItemControllerComponent* Controller;
+	};
+
 public:
 	/** Move items from a local-only client container to a server-owned container. */
 	void MoveClientItemsToServer(const FGameItemMoveSpec& MoveSpec);
@@ -71,12 +125,96 @@ public:
 	UFUNCTION(Server, Reliable)
 	void ServerMoveItems(const TArray<FGameItemMove>& Moves, const FGameItemContainerPair& Containers, FGameItemsPredictionKey PredictionKey);
 
+	/** Validate and apply a set of container operations recorded by the client. */
+	UFUNCTION(Server, Reliable)
+	void ServerExecuteTransaction(const FGameItemContainerTransaction& Transaction, FGameItemsPredictionKey PredictionKey);
+
+	/** Called from server to accept or reject a move of items from a client-only container, with details about which moves failed. */
+	UFUNCTION(Client, Reliable)
+	void ClientConfirmItemMoves(const FGameItemsPredictionKey& PredictionKey, const FGameItemMoveResult& Result);
+
 	/** Called from server to accept or reject some predicted changes to this container or its items. */
 	UFUNCTION(Client, Reliable)
 	void ClientConfirmPredictionKey(const FGameItemsPredictionKey& PredictionKey, bool bAccepted = false);
 
+	/** Called from server to accept or reject predicted changes for several keys at once. */
+	UFUNCTION(Client, Reliable)
+	void ClientConfirmPredictionKeys(const FGameItemsPredictionKeyConfirmations& Confirmations);
+
+	/**
+	 * Queue a prediction key to be accepted or rejected on the client.
+	 * All keys queued during a frame are sent together in a single RPC.
+	 */
+	void QueueConfirmPredictionKey(const FGameItemsPredictionKey& PredictionKey, bool bAccepted);
+
+	/** Send all queued prediction key confirmations to the client. */
+	void FlushPredictionKeyConfirmations();
+
+	/** Create a new client prediction key for this connection. */
+	FGameItemsPredictionKey CreatePredictionKey();
+
+	/** Return the number of prediction keys created by this client that are still awaiting confirmation. */
+	int32 GetNumPendingPredictionKeys() const { return PredictionKeyGenerator.NumPendingKeys(); }
+
 protected:
 	/** Map of containers involved in any actions for each prediction key. */
 	UPROPERTY(Transient)
 	TMap<FGameItemsPredictionKey, FGameItemContainerPair> PredictionContainerMap;
+
+	/** Map of transactions awaiting confirmation for each prediction key. */
+	UPROPERTY(Transient)
+	TMap<FGameItemsPredictionKey, FGameItemContainerTransaction> PendingTransactions;
+
+	/** The operations recorded in the current transaction. */
+	UPROPERTY(Transient)
+	FGameItemContainerTransaction ActiveTransaction;
+
+	/** Prediction keys waiting to be confirmed on the client, and whether they were accepted. */
+	TMap<int32, bool> QueuedConfirmations;
+
+	/** Generates prediction keys for this client, and tracks the ones awaiting confirmation. */
+	FGameItemsPredictionKeyGenerator PredictionKeyGenerator;
+
+	/** Timer used to expire prediction keys that are never confirmed. */
+	FTimerHandle ExpirePredictionKeysTimer;
+
+	/** The highest prediction key id received from the client, used on the server to reject keys outside of the window. */
+	int32 HighestReceivedKeyId = 0;
+
+	/** Return true if a prediction key received from the client is valid and within the window of keys that may still be pending. */
+	bool ReceivePredictionKey(const FGameItemsPredictionKey& PredictionKey);
+
+	/** Consume the operation budget of the client connection, returning false if the request should be ignored. */
+	bool ConsumeServerRpcBudget(const TCHAR* FuncName, int32 Cost) const;
+
+	/** Expire prediction keys that have not been confirmed in time, rejecting their changes. */
+	void ExpirePredictionKeys();
+
+	/** Accept or reject the changes for a prediction key in all affected containers. */
+	void ApplyPredictionKeyConfirmation(const FGameItemsPredictionKey& PredictionKey, bool bAccepted);
+
+	/** The number of nested transactions that have begun and not been committed. */
+	int32 TransactionDepth = 0;
+
+	/**
+	 * Return true if a transaction is valid and every operation can be fully applied.
+	 * Operations are checked in order against the expected state of each container after the operations before them.
+	 */
+	virtual bool CanExecuteTransaction(const FGameItemContainerTransaction& Transaction) const;
+
+	/**
+	 * Return true if the client that owns this component is allowed to change a container via transactions.
+	 * By default the container must be predicted, and owned by the same connection as this component.
+	 */
+	virtual bool CanControlContainer(const UGameItemContainer* Container) const;
+
+	/**
+	 * Apply the operations of a transaction in order, stopping at the first operation that can't be fully applied.
+	 * @return False if an operation failed, in which case the transaction should be rejected so that the client
+	 *         rolls back its prediction, and receives whatever state the server ended up with.
+	 */
+	virtual bool ExecuteTransaction(const FGameItemContainerTransaction& Transaction);
+
+	/** Apply a single operation of a transaction, returning false if it couldn't be fully applied. */
+	virtual bool ExecuteTransactionOp(const FGameItemContainerOp& Op);
 };
@@ -67,6 +67,8 @@ public:
 #if WITH_EDITOR
 	/** Return the editor icon for this item. */
 	virtual TOptional<struct FSlateBrush> GetEditorIcon() const;
+
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
 
 protected:
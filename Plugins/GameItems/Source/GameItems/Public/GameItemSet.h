@@ -5,13 +5,32 @@
 #include "CoreMinimal.h"
 #include "GameItemTypes.h"
 #include "Engine/DataAsset.h"
+#include "UObject/ObjectKey.h"
 #include "UObject/ObjectSaveContext.h"
 #include "UObject/ScriptInterface.h"
+#include <atomic>
 #include "GameItemSet.generated.h"
 
 class IGameItemContainerInterface;
 class UGameItemFragment;
 class UGameItemSet;
+class UGameItemSetEntrySelector;
+
+
+/**
+ * Selection data cached by an entry selector for an item set.
+ */
+struct FGameItemSetSelectionCache
+{
+	/** The global selection data version when the cache was built, or 0 if it hasn't been built yet. */
+	uint32 DataVersion = 0;
+
+	/** True if item weights don't depend on the drop context, and the alias table can be used. */
+	bool bUseAliasTable = false;
+
+	/** Alias table for the items in the set, with one entry for every item. */
+	FGameItemAliasTable AliasTable;
+};
 
 
 /**
@@ -86,6 +105,26 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "GameItems")
 	virtual void AddToDefaultContainers(TScriptInterface<IGameItemContainerInterface> ContainerInterface) const;
 
+	/** Return the selection data cached for an entry selector, which may not be built yet. */
+	FGameItemSetSelectionCache& GetSelectionCache(const UGameItemSetEntrySelector* Selector) const;
+
+	/** Clear all cached selection data. Must be called after changing Items at runtime. */
+	UFUNCTION(BlueprintCallable, Category = "GameItems")
+	void InvalidateSelectionCache();
+
+	/** Invalidate the cached selection data of all item sets, e.g. after item drop rules have changed. */
+	static void InvalidateAllSelectionCaches();
+
+	/** Return the current global selection data version. Caches built with an older version must be rebuilt. */
+	static uint32 GetSelectionDataVersion() { return SelectionDataVersion.load(); }
+
+protected:
+	/** Selection data cached for each entry selector. */
+	mutable TMap<TObjectKey<UGameItemSetEntrySelector>, FGameItemSetSelectionCache> SelectionCache;
+
+	/** Incremented whenever data used by the selection caches of any item set changes. */
+	static std::atomic<uint32> SelectionDataVersion;
+
 #if WITH_EDITOR
 
 public:
@@ -9,6 +9,7 @@
 #include "UObject/SoftObjectPtr.h"
 #include "GameItemSettings.generated.h"
 
+class AActor;
 class UGameItemDef;
 class UGameItemCheatsExtension;
 
@@ -40,6 +41,49 @@ public:
 	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
 	TSoftClassPtr<UGameItemCheatsExtension> ItemCheatsExtensionClass;
 
+	/** The maximum number of container operations a client can send to the server in a single transaction. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	int32 MaxTransactionOps = 256;
+
+	/** The maximum number of prediction keys a client can be waiting on at once. Older keys are expired when exceeded. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	int32 PredictionKeyWindowSize = 256;
+
+	/** Seconds after which a prediction key that hasn't been confirmed by the server is expired and its changes rejected. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	float PredictionKeyTimeout = 30.f;
+
+	/**
+	 * Limit the rate of item operations each client can request from the server.
+	 * Transactions over budget are rejected as a whole, but other container requests over budget are ignored,
+	 * leaving the client's predicted changes in place until the server state replicates.
+	 */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	bool bEnableRpcBudget = false;
+
+	/** The number of item operations per second each client is allowed to request from the server. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnableRpcBudget", ClampMin = "0"))
+	float RpcBudgetOpsPerSecond = 30.f;
+
+	/**
+	 * The maximum number of item operations a client can request in a burst.
+	 * Larger requests are allowed once the budget is full, and must be paid off before any more requests are allowed.
+	 */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnableRpcBudget", ClampMin = "1"))
+	float RpcBudgetMaxOps = 300.f;
+
+	/** Reuse equipment actors that have bUsePool enabled, instead of destroying them when unequipped. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite)
+	bool bEnableEquipmentActorPool = true;
+
+	/** The maximum number of inactive equipment actors of each class to keep in the pool. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnableEquipmentActorPool", ClampMin = "0"))
+	int32 MaxPooledEquipmentActorsPerClass = 8;
+
+	/** The number of equipment actors of each class to spawn into the pool when a game world begins play. Classes must already be loaded. */
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bEnableEquipmentActorPool"))
+	TMap<TSoftClassPtr<AActor>, int32> EquipmentActorPoolWarmUp;
+
 	/** Return a clean name for an item definition, stripping _C and ItemAssetPrefix, e.g. ITM_MyItem_C -> "MyItem" */
 	FString GetItemDefShortName(const TSubclassOf<UGameItemDef>& ItemDef) const;
 
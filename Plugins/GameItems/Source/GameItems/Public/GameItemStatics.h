@@ -80,6 +80,11 @@ public:
 	UFUNCTION(BlueprintPure, Category="GameItems|Utilities")
 	static int32 GetWeightedRandomArrayIndex(const TArray<float>& Probabilities);
 
+	/** Return a random index for an array using a random stream, given an array (of matching size) of relative probabilities, or -1 if the array is empty. */
+	UFUNCTION(BlueprintPure, Category="GameItems|Utilities")
+	static int32 GetWeightedRandomArrayIndexFromStream(const TArray<float>& Probabilities, const FRandomStream& RandomStream);
+
+	/** Evaluate a condition once using a temporary query state. Use FGameItemConditionCache for conditions that are checked repeatedly. */
 	static bool EvaluateWorldCondition(const UObject* Owner, const FWorldConditionQueryDefinition& Condition,
 	                                   const FWorldConditionContextData& ContextData);
 
@@ -8,7 +8,9 @@
 #include "GameplayTagContainer.h"
 #include "DropTable/GameItemDropContext.h"
 #include "Engine/DataTable.h"
+#include "Engine/StreamableManager.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/ObjectKey.h"
 #include "GameItemSubsystem.generated.h"
 
 class AHUD;
@@ -17,8 +19,14 @@ class UCanvas;
 class UGameItem;
 class UGameItemContainer;
 class UGameItemContainerComponent;
+class UGameItemControllerComponent;
 class UGameItemDef;
 class UGameItemFragment;
+class UNetConnection;
+struct FGameItemDropTableRow;
+
+DECLARE_DELEGATE_OneParam(FGameItemDropItemsSelectedDelegate, const TArray<FGameItemDefStack>& /* Items */);
+DECLARE_DELEGATE_OneParam(FGameItemDropItemsCreatedDelegate, const TArray<UGameItem*>& /* Items */);
 
 
 /**
@@ -123,6 +131,37 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GameItems")
 	TArray<UGameItem*> CreateItemsFromDropTable(UObject* Outer, const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry);
 
+	/**
+	 * Select items from a drop table after asynchronously loading all item definitions and sets that it may select.
+	 * Completes immediately if everything is already loaded.
+	 * @return The handle for the load, or null if it completed immediately.
+	 */
+	TSharedPtr<FStreamableHandle> SelectItemsFromDropTableAsync(const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry,
+	                                                            FGameItemDropItemsSelectedDelegate OnComplete);
+
+	/**
+	 * Select and create new game items from a drop table after asynchronously loading all item definitions and sets that it may select.
+	 * Completes immediately if everything is already loaded. Completes with no items if the outer was destroyed while loading.
+	 * @return The handle for the load, or null if it completed immediately.
+	 */
+	TSharedPtr<FStreamableHandle> CreateItemsFromDropTableAsync(UObject* Outer, const FGameItemDropContext& Context, FDataTableRowHandle DropTableEntry,
+	                                                            FGameItemDropItemsCreatedDelegate OnComplete);
+
+	/**
+	 * Asynchronously load all item definitions and sets that may be selected from any row of a drop table,
+	 * and keep them loaded until ReleasePreloadedDropTable is called, e.g. to warm up an encounter.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GameItems")
+	void PreloadDropTable(const UDataTable* DropTable);
+
+	/** Release the references loaded by PreloadDropTable. */
+	UFUNCTION(BlueprintCallable, Category = "GameItems")
+	void ReleasePreloadedDropTable(const UDataTable* DropTable);
+
+	/** Return true if all item definitions and sets that may be selected from a drop table row are loaded. */
+	UFUNCTION(BlueprintPure, Category = "GameItems")
+	bool IsDropTableLoaded(FDataTableRowHandle DropTableEntry) const;
+
 	/**
 	 * Find a return an item fragment by class.
 	 * Convenience function that uses the GameItemSubsystem.
@@ -158,6 +197,48 @@ public:
 	/** Find a game item container interface from an actor. Attempts to cast the actor first, then search for a component. */
 	virtual const IGameItemContainerInterface* GetContainerInterfaceForActor(const AActor* Actor) const;
 
+	/**
+	 * Consume tokens from the operation budget of a client connection. Used by server RPC handlers
+	 * to protect against clients requesting more item operations than the server should process.
+	 * @param Connection The connection that sent the request. Requests without a connection are always allowed.
+	 * @param Cost The number of operations requested.
+	 * @param FuncName The name of the RPC, for logging.
+	 * @return False if the connection is over budget and the request should be ignored.
+	 */
+	bool ConsumeRpcBudget(const UNetConnection* Connection, int32 Cost, const TCHAR* FuncName);
+
+	/** Return the total number of client requests that have been throttled. */
+	int32 GetNumThrottledRpcs() const { return NumThrottledRpcs; }
+
+	/** Return the RPC budget for a client connection, if it has sent any requests. */
+	const FGameItemsRpcBudget* GetRpcBudget(const UNetConnection* Connection) const;
+
+	/** Add or remove a controller component that is recording a transaction. */
+	void SetControllerRecording(UGameItemControllerComponent* Controller, bool bIsRecording);
+
+	/** Return all controller components that are currently recording transactions. */
+	const TArray<TWeakObjectPtr<UGameItemControllerComponent>>& GetRecordingControllers() const { return RecordingControllers; }
+
 protected:
+	/** Controller components that are currently recording transactions, e.g. one for each local player. */
+	TArray<TWeakObjectPtr<UGameItemControllerComponent>> RecordingControllers;
+
+	/** The operation budget of each client connection. */
+	TMap<TObjectKey<UNetConnection>, FGameItemsRpcBudget> RpcBudgets;
+
+	/** The total number of client requests that have been throttled. */
+	int32 NumThrottledRpcs = 0;
+
+	/** The last time that budgets for closed connections were cleaned up. */
+	double LastRpcBudgetCleanupTime = 0.0;
+
+	FStreamableManager StreamableManager;
+
+	/** The load handles for drop tables loaded by PreloadDropTable. */
+	TMap<TObjectKey<UDataTable>, TSharedPtr<FStreamableHandle>> PreloadedDropTables;
+
+	/** Return the soft references of a drop table row that aren't loaded yet. */
+	static void GetUnloadedDropTableReferences(const FGameItemDropTableRow& Row, TArray<FSoftObjectPath>& OutPaths);
+
 	void OnShowDebugInfo(AHUD* HUD, UCanvas* Canvas, const FDebugDisplayInfo& DisplayInfo, float& YL, float& YPos);
 };
@@ -3,7 +3,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameItemsNetStats.h"
 #include "GameplayTagContainer.h"
+#include "Containers/Deque.h"
 #include "Net/Serialization/FastArraySerializer.h"
 #include "Templates/SubclassOf.h"
 #include "UObject/SoftObjectPtr.h"
@@ -37,6 +39,29 @@ enum class EGameItemContainerNetExecutionPolicy : uint8
 };
 
 
+/**
+ * Determines which connections a game item container, along with its items and rules, will replicate to.
+ */
+UENUM(BlueprintType)
+enum class EGameItemContainerReplicationCondition : uint8
+{
+	/** Replicate to every connection the owning actor is relevant to. */
+	Default,
+
+	/** Only replicate to the owner of the actor, e.g. for private player inventories. */
+	OwnerOnly,
+
+	/** Replicate to every connection except the owner of the actor. */
+	SkipOwner,
+
+	/** Only replicate to connections that have been included in the container's net condition group. */
+	Custom,
+
+	/** Never replicate the container to any connection. */
+	Never,
+};
+
+
 /**
  * Defines limitations for the quantity of an item.
  */
@@ -184,6 +209,7 @@ struct GAMEITEMS_API FGameItemTagStackContainer : public FFastArraySerializer
 
 	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
 	{
+		FGameItemsNetStatsSerializeScope NetStatsScope(EGameItemsNetStatCategory::TagStacks, DeltaParms);
 		return FastArrayDeltaSerialize<FGameItemTagStack, FGameItemTagStackContainer>(Stacks, DeltaParms, *this);
 	}
 
@@ -248,7 +274,10 @@ struct GAMEITEMS_API FGameItemListEntry : public FFastArraySerializerItem
 	UPROPERTY()
 	TObjectPtr<UGameItem> Item;
 
-	/** The slot index of this entry, since item list order is unstable. */
+	/**
+	 * The slot index of this entry, since item list order is unstable.
+	 * When the list uses ordered slots this is a sort key instead, see FGameItemList::GetEntrySlot.
+	 */
 	UPROPERTY()
 	int32 Slot = INDEX_NONE;
 
@@ -278,18 +307,32 @@ struct GAMEITEMS_API FGameItemList : public FFastArraySerializer
 
 	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
 	{
+		FGameItemsNetStatsSerializeScope NetStatsScope(EGameItemsNetStatCategory::ItemList, DeltaParms);
 		return FFastArraySerializer::FastArrayDeltaSerialize<FGameItemListEntry, FGameItemList>(Entries, DeltaParms, *this);
 	}
 
 	void PostSerialize(const FArchive& Ar);
 
-	/** Add an item/stack to the list at a specific index, expanding the list size as needed. */
+	/** Set the container that owns this list. */
+	void SetOwningContainer(UGameItemContainer* InContainer);
+
+	/**
+	 * Return true if slots are derived from the order of entries, instead of stored on each entry.
+	 * Used for containers with unlimited slots, which never have gaps, so that removing an entry
+	 * doesn't require changing (and replicating) the slot of every entry after it.
+	 */
+	bool UsesOrderedSlots() const;
+
+	/** Add an item/stack to the list at a specific index. Ordered slots are always added after the last entry. */
 	void AddEntryForSlot(UGameItem* Item, int32 Slot);
 
 	/** Remove an item/stack from the list. */
 	void RemoveEntry(UGameItem* Item);
 
-	/** Remove an entry from the list for a slot, optionally updating items in higher slots to remove gaps. */
+	/**
+	 * Remove an entry from the list for a slot, optionally updating items in higher slots to remove gaps.
+	 * Ordered slots are always collapsed without modifying other entries.
+	 */
 	UGameItem* RemoveEntryForSlot(int32 Slot, bool bCollapseSlots = false);
 
 	/** Return the item in a slot. */
@@ -310,6 +353,9 @@ struct GAMEITEMS_API FGameItemList : public FFastArraySerializer
 	/** Return slots with items, sorted. */
 	void GetAllSlots(TArray<int32>& OutSlots) const;
 
+	/** Return the slot of an entry in this list. */
+	int32 GetEntrySlot(const FGameItemListEntry& Entry) const;
+
 	/** Return all item entries. Remember that index and order of this array is unstable. */
 	FORCEINLINE const TArray<FGameItemListEntry>& GetEntries() const { return Entries; }
 
@@ -324,6 +370,7 @@ public:
 			: Item(InEntry.Item)
 			, Slot(InEntry.Slot)
 			, LastKnownSlot(InEntry.LastKnownSlot)
+			, ReplicationID(InEntry.ReplicationID)
 			, bIsRemoved(bInIsRemoved)
 		{
 		}
@@ -337,6 +384,9 @@ public:
 
 		int32 LastKnownSlot = INDEX_NONE;
 
+		/** The replication id of the changed entry, used to resolve ordered slots once all changes are received. */
+		int32 ReplicationID = INDEX_NONE;
+
 		bool bIsRemoved = false;
 	};
 
@@ -345,8 +395,44 @@ protected:
 	UPROPERTY()
 	TArray<FGameItemListEntry> Entries;
 
+	/** The container that owns this list. */
+	UPROPERTY(NotReplicated)
+	TObjectPtr<UGameItemContainer> OwningContainer;
+
 	TArray<FChange> PendingChanges;
 
+	/** The slot of each entry, by entry index. */
+	mutable TArray<int32> EntrySlots;
+
+	/** The index of each entry, by slot, when using ordered slots. */
+	mutable TArray<int32> EntryIndicesByOrder;
+
+	/** The index of each entry, by slot, when not using ordered slots. */
+	mutable TMap<int32, int32> EntryIndicesBySlot;
+
+	/** True when the slot cache was built for ordered slots. */
+	mutable bool bSlotCacheOrdered = false;
+
+	/**
+	 * True when entries have changed in a way that can't be updated in place, e.g. when replicated,
+	 * and the cached slot lookups need to be rebuilt.
+	 */
+	mutable bool bSlotCacheDirty = true;
+
+	/** Rebuild the cached slot lookups if needed. */
+	void UpdateSlotCache() const;
+
+	FORCEINLINE void MarkSlotCacheDirty() { bSlotCacheDirty = true; }
+
+	/** Return the index of the entry in a slot, or INDEX_NONE. */
+	int32 FindEntryIndexForSlot(int32 Slot) const;
+
+	/** Remove an entry by index, updating the slot cache in place. */
+	void RemoveEntryAt(int32 EntryIdx);
+
+	/** Return the sort key to use for a new entry added after all others when using ordered slots. */
+	int32 GetNextOrderKey();
+
 public:
 	DECLARE_MULTICAST_DELEGATE_OneParam(FPostReplicateChangesDelegate, const TArray<FChange>& /*Changes*/);
 
@@ -382,6 +468,18 @@ struct GAMEITEMS_API FGameItemContainerSpec
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FText DisplayName;
 
+	/** Override the replication condition of the container definition. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (InlineEditConditionToggle))
+	bool bOverrideReplicationCondition = false;
+
+	/** Determines which connections the container, its items, and its rules replicate to. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (EditCondition = "bOverrideReplicationCondition"))
+	EGameItemContainerReplicationCondition ReplicationCondition = EGameItemContainerReplicationCondition::Default;
+
+	/** The net condition group to replicate to when using the Custom replication condition. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (EditCondition = "bOverrideReplicationCondition"))
+	FName NetConditionGroup;
+
 	bool IsValid() const;
 };
 
@@ -522,7 +620,10 @@ struct GAMEITEMS_API FGameItemsPredictionKey
 	GENERATED_BODY()
 
 public:
-	/** Construct a new prediction key for client actions. */
+	/**
+	 * Construct a new prediction key for client actions.
+	 * Prefer UGameItemControllerComponent::CreatePredictionKey, which tracks keys per connection and expires them.
+	 */
 	static FGameItemsPredictionKey CreateNewClientPredictionKey(const AActor* Owner);
 
 	/** Construct a new server initiated key, for actions performed by the server */
@@ -531,7 +632,7 @@ public:
 public:
 	/** The unique id of this prediction key */
 	UPROPERTY()
-	int16 Id = 0;
+	int32 Id = 0;
 
 	/** True if this was created by the server, not used for prediction. */
 	UPROPERTY()
@@ -569,7 +670,7 @@ public:
 
 	friend uint32 GetTypeHash(const FGameItemsPredictionKey& InKey)
 	{
-		return ((InKey.Id << 1) | (InKey.bIsServerInitiated & 1));
+		return HashCombine(::GetTypeHash(InKey.Id), ::GetTypeHash(InKey.bIsServerInitiated));
 	}
 
 protected:
@@ -587,6 +688,145 @@ struct TStructOpsTypeTraits<FGameItemsPredictionKey> : public TStructOpsTypeTrai
 };
 
 
+/**
+ * A set of client prediction keys that were accepted or rejected, sent to the client together.
+ * Stored as bitsets relative to the lowest key, since keys confirmed together are almost always close together.
+ */
+USTRUCT()
+struct GAMEITEMS_API FGameItemsPredictionKeyConfirmations
+{
+	GENERATED_BODY()
+
+	/** The maximum distance between the lowest and highest key in one set of confirmations. */
+	static constexpr int32 MaxKeySpan = 1024;
+
+	/** The id of the lowest key. */
+	UPROPERTY()
+	int32 BaseId = 0;
+
+	/** One bit per key id starting from BaseId, set if the key is confirmed. */
+	UPROPERTY()
+	TArray<uint8> ConfirmedBits;
+
+	/** One bit per key id starting from BaseId, set if the key was accepted. */
+	UPROPERTY()
+	TArray<uint8> AcceptedBits;
+
+	/**
+	 * Add a key to the confirmations. Keys must be added in ascending order.
+	 * @return False if the key could not be added because it's too far from the lowest key.
+	 */
+	bool Add(const FGameItemsPredictionKey& PredictionKey, bool bAccepted);
+
+	/** Return all confirmed keys, and whether each was accepted. */
+	void GetConfirmations(TArray<TPair<FGameItemsPredictionKey, bool>>& OutConfirmations) const;
+
+	bool IsEmpty() const { return ConfirmedBits.IsEmpty(); }
+
+	void Reset();
+};
+
+
+/**
+ * Generates client prediction keys for a single connection, and tracks the keys awaiting
+ * confirmation in a sliding window so that keys that are never confirmed can be expired.
+ */
+struct GAMEITEMS_API FGameItemsPredictionKeyGenerator
+{
+	~FGameItemsPredictionKeyGenerator();
+
+	/** Create a new key and start waiting for its confirmation. */
+	FGameItemsPredictionKey CreateKey(double CurrentTime);
+
+	/**
+	 * Stop waiting for confirmation of a key.
+	 * @return False if the key was not pending, e.g. because it already expired.
+	 */
+	bool Acknowledge(const FGameItemsPredictionKey& PredictionKey);
+
+	/**
+	 * Expire all keys that have been pending for longer than the timeout, or that no longer fit in the window.
+	 * @param OutExpiredKeys The keys that were expired.
+	 */
+	void ExpireKeys(double CurrentTime, double Timeout, int32 WindowSize, TArray<FGameItemsPredictionKey>& OutExpiredKeys);
+
+	/** Return the number of keys awaiting confirmation. */
+	int32 NumPendingKeys() const { return PendingKeyIds.Num(); }
+
+private:
+	int32 NextId = 1;
+
+	/** The ids of all keys awaiting confirmation. */
+	TSet<int32> PendingKeyIds;
+
+	/** All created keys and their creation time in order, including ones that have since been acknowledged. */
+	TDeque<TPair<int32, double>> KeyHistory;
+};
+
+
+/**
+ * A token bucket that limits the rate of item operations a single client connection can request from the server.
+ * Tokens refill continuously up to a maximum, and each operation consumes one or more tokens.
+ */
+struct GAMEITEMS_API FGameItemsRpcBudget
+{
+	/**
+	 * Refill the bucket and consume tokens for an operation.
+	 * Operations that cost more than MaxTokens are allowed when the bucket is full, leaving it in debt.
+	 * @return False if there are not enough tokens, and the operation should be ignored.
+	 */
+	bool TryConsume(double Cost, double CurrentTime, double TokensPerSecond, double MaxTokens);
+
+	/** The number of operations that have been throttled. */
+	int32 NumThrottled = 0;
+
+	/** The number of operations that have been allowed. */
+	int32 NumAllowed = 0;
+
+private:
+	/** The available tokens, which are negative while in debt. */
+	double Tokens = 0.0;
+
+	double LastRefillTime = 0.0;
+
+	bool bInitialized = false;
+};
+
+
+/**
+ * A precomputed table for selecting weighted random indices in constant time, using Vose's alias method.
+ * Building the table is O(n), so it should be cached and rebuilt only when the weights change.
+ */
+struct GAMEITEMS_API FGameItemAliasTable
+{
+	/**
+	 * Build the table from relative weights. Negative weights are treated as zero.
+	 * If all weights are zero, the first index is always selected, matching UGameItemStatics::GetWeightedRandomArrayIndex.
+	 */
+	void Build(TConstArrayView<float> Weights);
+
+	void Reset();
+
+	/** Return the number of weights in the table. */
+	int32 Num() const { return Probabilities.Num(); }
+
+	bool IsEmpty() const { return Probabilities.IsEmpty(); }
+
+	/** Return a weighted random index, or INDEX_NONE if the table is empty. */
+	int32 Sample() const;
+
+	/** Return a weighted random index using a random stream, or INDEX_NONE if the table is empty. */
+	int32 Sample(const FRandomStream& RandomStream) const;
+
+private:
+	/** The probability of selecting each index instead of its alias, once the index has been picked uniformly. */
+	TArray<float> Probabilities;
+
+	/** The alternate index for each index. */
+	TArray<int32> Aliases;
+};
+
+
 /**
  * A pair of containers used when moving items.
  */
@@ -672,6 +912,139 @@ struct GAMEITEMS_API FGameItemSerializedMove
 };
 
 
+/**
+ * Result codes for a request to move items from a client-only container to the server.
+ */
+UENUM(BlueprintType)
+enum class EGameItemMoveResultCode : uint8
+{
+	/** All items were moved. */
+	Success,
+
+	/** The containers were invalid. */
+	InvalidContainers,
+
+	/** One or more items were invalid, already pending another change, or could not be recreated. */
+	InvalidItems,
+
+	/** One or more items could not be fully added to the target container. */
+	CantAddItems,
+};
+
+
+/**
+ * The result of a request to move items, including which moves caused it to fail.
+ * Moves are all-or-nothing, if any fail then no items are moved.
+ */
+USTRUCT(BlueprintType)
+struct GAMEITEMS_API FGameItemMoveResult
+{
+	GENERATED_BODY()
+
+	FGameItemMoveResult()
+	{
+	}
+
+	FGameItemMoveResult(EGameItemMoveResultCode InCode, const TArray<int32>& InFailedMoveIndices = TArray<int32>())
+		: Code(InCode)
+		, FailedMoveIndices(InFailedMoveIndices)
+	{
+	}
+
+	UPROPERTY(BlueprintReadOnly, Category = "GameItems")
+	EGameItemMoveResultCode Code = EGameItemMoveResultCode::Success;
+
+	/** The indices of the requested moves that failed. */
+	UPROPERTY(BlueprintReadOnly, Category = "GameItems")
+	TArray<int32> FailedMoveIndices;
+
+	bool WasSuccessful() const { return Code == EGameItemMoveResultCode::Success; }
+};
+
+
+/**
+ * The types of container operations that can be sent to the server in a transaction.
+ */
+UENUM()
+enum class EGameItemContainerOpType : uint8
+{
+	AddItem,
+	RemoveItem,
+	RemoveItemAt,
+	SwapItems,
+	StackItems,
+	SetItemAt,
+};
+
+
+/**
+ * A single container operation requested by a client, recorded as part of a transaction.
+ * See UGameItemControllerComponent::BeginTransaction.
+ */
+USTRUCT()
+struct GAMEITEMS_API FGameItemContainerOp
+{
+	GENERATED_BODY()
+
+	FGameItemContainerOp()
+	{
+	}
+
+	FGameItemContainerOp(EGameItemContainerOpType InType, UGameItemContainer* InContainer, UGameItem* InItem,
+	                     int32 InSlotA = INDEX_NONE, int32 InSlotB = INDEX_NONE, bool bInAllowPartial = true)
+		: Type(InType)
+		, Container(InContainer)
+		, Item(InItem)
+		, SlotA(InSlotA)
+		, SlotB(InSlotB)
+		, bAllowPartial(bInAllowPartial)
+	{
+	}
+
+	UPROPERTY()
+	EGameItemContainerOpType Type = EGameItemContainerOpType::AddItem;
+
+	UPROPERTY()
+	TObjectPtr<UGameItemContainer> Container;
+
+	UPROPERTY()
+	TObjectPtr<UGameItem> Item;
+
+	/** The target slot, or the 'from' slot for swaps and stacks. */
+	UPROPERTY()
+	int32 SlotA = INDEX_NONE;
+
+	/** The 'to' slot for swaps and stacks. */
+	UPROPERTY()
+	int32 SlotB = INDEX_NONE;
+
+	UPROPERTY()
+	bool bAllowPartial = true;
+};
+
+
+/**
+ * A set of container operations sent to the server together using one prediction key.
+ */
+USTRUCT()
+struct GAMEITEMS_API FGameItemContainerTransaction
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FGameItemContainerOp> Ops;
+
+	/**
+	 * Add an operation, coalescing it with the previous one when possible,
+	 * e.g. swapping the same two occupied slots twice in a row cancels out both swaps.
+	 */
+	void AddOp(const FGameItemContainerOp& Op);
+
+	/** Return a copy of this transaction with all redundant operations coalesced. */
+	FGameItemContainerTransaction GetCoalesced() const;
+};
+
+
 /**
  * A pending, predicted add of an item to a container.
  */
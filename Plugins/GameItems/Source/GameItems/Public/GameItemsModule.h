@@ -3,12 +3,25 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
 #include "Modules/ModuleManager.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
 
 struct FAutoCompleteCommand;
 
 GAMEITEMS_API DECLARE_LOG_CATEGORY_EXTERN(LogGameItems, Log, All);
 
+DECLARE_STATS_GROUP(TEXT("GameItems"), STATGROUP_GameItems, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Items"), STAT_GameItems_LiveItems, STATGROUP_GameItems, GAMEITEMS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Containers"), STAT_GameItems_LiveContainers, STATGROUP_GameItems, GAMEITEMS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Predictions"), STAT_GameItems_PendingPredictions, STATGROUP_GameItems, GAMEITEMS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cached Condition States"), STAT_GameItems_CachedConditionStates, STATGROUP_GameItems, GAMEITEMS_API);
+
+/** LLM tag for memory used by game items and containers. */
+LLM_DECLARE_TAG_API(GameItems, GAMEITEMS_API);
+
 namespace ShowDebugNames
 {
 	/** ShowDebug name for displaying game item debug info. */
@@ -0,0 +1,162 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class AActor;
+class UFunction;
+class UNetConnection;
+struct FNetDeltaSerializeInfo;
+
+
+/**
+ * The types of replicated data tracked by FGameItemsNetStats.
+ */
+enum class EGameItemsNetStatCategory : uint8
+{
+	ItemList,
+	TagStacks,
+	EquipmentList,
+
+	MAX
+};
+
+
+/**
+ * Tracks the network bandwidth used by game items, containers and equipment, including bytes serialized
+ * per connection, object and actor, RPCs sent by function, and items received per second.
+ *
+ * Recording is disabled by default. Enable it with 'GameItems.NetStats.Enabled 1', and print the results with
+ * 'GameItems.NetStats.Dump'. It is also enabled while capturing a CSV profile, where totals are reported
+ * in the GameItemsNet category.
+ *
+ * Byte counts are measured using the generic replication system. When using Iris, delta serialization
+ * is not called and RPCs are sent later, so only RPC and item counts are recorded.
+ */
+class GAMEITEMS_API FGameItemsNetStats
+{
+public:
+	struct FCounter
+	{
+		/** The total number of bytes sent or received. */
+		int64 NumBytes = 0;
+
+		/** The number of times data was sent or received. */
+		int32 Count = 0;
+
+		void Add(int64 NumBits)
+		{
+			NumBytes += (NumBits + 7) / 8;
+			++Count;
+		}
+	};
+
+	struct FNamedCounter : FCounter
+	{
+		/** The name of the object, stored on first use so that destroyed objects can still be reported. */
+		FString Name;
+	};
+
+	struct FConnectionStats
+	{
+		/** The name of the connection's player controller, or of the connection until it has one. */
+		FString Name;
+
+		bool bHasPlayerControllerName = false;
+
+		/** Replicated item data sent to the connection. */
+		FCounter Sent;
+
+		/** Replicated item data received from the connection. */
+		FCounter Received;
+
+		/** RPCs sent to the connection. */
+		FCounter Rpcs;
+	};
+
+	/** Return the global net stats. */
+	static FGameItemsNetStats& Get();
+
+	/** Return true if net stats should be recorded. */
+	static bool IsEnabled();
+
+	/** Record the bits read or written when delta serializing replicated data owned by an object. */
+	void RecordSerialize(EGameItemsNetStatCategory Category, const UObject* Object, const UNetConnection* Connection, int64 NumBits, bool bIsWriting);
+
+	/** Record the bits written when sending an RPC. */
+	void RecordRpc(const UFunction* Function, const UNetConnection* Connection, int64 NumBits);
+
+	/** Return the stats recorded for a connection, or null if nothing has been recorded for it. */
+	const FConnectionStats* FindConnectionStats(const UNetConnection* Connection) const;
+
+	/** Record items that were received by replication. */
+	void RecordItemsReplicated(int32 NumItems);
+
+	/** Print all stats, listing at most MaxEntries objects, actors and functions each. */
+	void Dump(FOutputDevice& Ar, int32 MaxEntries = 20) const;
+
+	/** Reset all stats. */
+	void Reset();
+
+private:
+	FCounter SentByCategory[static_cast<int32>(EGameItemsNetStatCategory::MAX)];
+	FCounter ReceivedByCategory[static_cast<int32>(EGameItemsNetStatCategory::MAX)];
+
+	/** Stats for each connection that item data was sent to or received from. */
+	TMap<TObjectKey<UNetConnection>, FConnectionStats> StatsByConnection;
+
+	/** Bytes sent for each object that owns replicated item data, e.g. a container or equipment component. */
+	TMap<TObjectKey<UObject>, FNamedCounter> SentByObject;
+
+	/** Bytes sent for each actor that owns replicated item data. */
+	TMap<TObjectKey<AActor>, FNamedCounter> SentByActor;
+
+	/** RPCs sent for each function. */
+	TMap<TObjectKey<UFunction>, FNamedCounter> RpcsByFunction;
+
+	int64 NumItemsReplicated = 0;
+
+	/** The number of items replicated during the current sample, used to calculate ItemsPerSecond. */
+	int32 NumSampleItemsReplicated = 0;
+
+	double SampleStartTime = 0.0;
+
+	/** The number of items replicated per second during the last full sample. */
+	float ItemsPerSecond = 0.f;
+
+	FConnectionStats* FindOrAddConnectionStats(const UNetConnection* Connection);
+};
+
+
+/**
+ * Measures the bits read or written by a net delta serializer during the scope, and records them in FGameItemsNetStats.
+ */
+struct GAMEITEMS_API FGameItemsNetStatsSerializeScope
+{
+	FGameItemsNetStatsSerializeScope(EGameItemsNetStatCategory InCategory, const FNetDeltaSerializeInfo& InDeltaParms);
+	~FGameItemsNetStatsSerializeScope();
+
+private:
+	EGameItemsNetStatCategory Category;
+	const FNetDeltaSerializeInfo& DeltaParms;
+	int64 StartBits = INDEX_NONE;
+};
+
+
+/**
+ * Measures the bits written to an actor's connection while sending an RPC during the scope, and records them in FGameItemsNetStats.
+ */
+struct GAMEITEMS_API FGameItemsNetStatsRpcScope
+{
+	FGameItemsNetStatsRpcScope(const UFunction* InFunction, const AActor* Actor);
+	~FGameItemsNetStatsRpcScope();
+
+private:
+	const UFunction* Function = nullptr;
+	const UNetConnection* Connection = nullptr;
+	int64 StartBits = 0;
+
+	static int64 GetConnectionBitsWritten(const UNetConnection* InConnection);
+};
@@ -0,0 +1,97 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Config.h"
+#include "Trace/Trace.h"
+
+class UGameItem;
+class UGameItemContainer;
+
+#define GAMEITEMS_TRACE_ENABLED (UE_TRACE_ENABLED && !IS_PROGRAM && !UE_BUILD_SHIPPING)
+
+#if GAMEITEMS_TRACE_ENABLED
+UE_TRACE_CHANNEL_EXTERN(GameItemsChannel, GAMEITEMS_API);
+#endif
+
+
+/**
+ * The types of item operations written to the GameItems trace channel.
+ */
+enum class EGameItemsTraceOp : uint8
+{
+	ItemCreated,
+	ItemAdded,
+	ItemRemoved,
+	ItemCountChanged,
+	ItemMoved,
+	ItemsSwapped,
+	SlotsChanged,
+	TransactionSent,
+	TransactionReceived,
+	PredictionAccepted,
+	PredictionRejected,
+	PredictionExpired,
+};
+
+
+/**
+ * Writes compact item lifecycle events to the GameItems trace channel, for viewing item operations
+ * over time in Unreal Insights. Enable with '-trace=default,GameItems' or 'Trace.Enable GameItems'.
+ *
+ * Each GameItems.ItemOp event contains the frame number, cycle, operation, and the ids of the item,
+ * item definition and container involved, along with the slot, count delta and prediction key.
+ * Object ids are unique for the lifetime of the process (or very nearly so for objects that have never
+ * been weakly referenced, whose ids use their name instead of a serial number), and a GameItems.ObjectName event
+ * is written the first time each id is used, and again if the id has since been forgotten,
+ * see GameItems.Trace.MaxNamedObjects.
+ *
+ * Use the TRACE_GAMEITEMS_OP macro instead of calling this directly, which costs
+ * nothing more than a channel check while the channel is disabled.
+ */
+struct GAMEITEMS_API FGameItemsTrace
+{
+	/**
+	 * Write an item operation event.
+	 * @param Op The operation.
+	 * @param Item The item involved, if any.
+	 * @param Container The container involved, if any.
+	 * @param Slot The slot involved, or INDEX_NONE.
+	 * @param Delta The change in item count, or the number of things affected for operations that aren't about a single item.
+	 * @param PredictionKeyId The id of the prediction key used for the operation, or 0.
+	 * @param OtherSlot The second slot involved, e.g. when swapping items, or INDEX_NONE.
+	 */
+	static void OutputItemOp(EGameItemsTraceOp Op, const UGameItem* Item, const UGameItemContainer* Container,
+	                         int32 Slot, int32 Delta, int32 PredictionKeyId, int32 OtherSlot = INDEX_NONE);
+
+	/** Return the trace id for an object, writing its name the first time the id is used. */
+	static uint64 GetObjectId(const UObject* Object);
+
+	/** Start listening for new traces, so that object names are written again to each one. */
+	static void Initialize();
+
+	static void Shutdown();
+
+private:
+	static void OnTraceStarted();
+	static void OnTraceStopped();
+};
+
+
+#if GAMEITEMS_TRACE_ENABLED
+
+#define TRACE_GAMEITEMS_OP(Op, Item, Container, Slot, Delta, PredictionKeyId, ...) \
+	do \
+	{ \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(GameItemsChannel)) \
+		{ \
+			FGameItemsTrace::OutputItemOp(Op, Item, Container, Slot, Delta, PredictionKeyId, ##__VA_ARGS__); \
+		} \
+	} while (0)
+
+#else
+
+#define TRACE_GAMEITEMS_OP(...)
+
+#endif
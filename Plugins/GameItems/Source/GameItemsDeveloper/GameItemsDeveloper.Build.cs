@@ -0,0 +1,22 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class GameItemsDeveloper : ModuleRules
+{
+	public GameItemsDeveloper(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PublicDependencyModuleNames.AddRange(new string[]
+		{
+			"Core",
+			"CoreUObject",
+			"Engine",
+			"GameItems",
+		});
+
+		PrivateDependencyModuleNames.AddRange(new string[]
+		{
+			"NetCore",
+		});
+	}
+}
\ No newline at end of file
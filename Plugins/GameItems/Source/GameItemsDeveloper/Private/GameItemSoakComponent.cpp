@@ -0,0 +1,479 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "GameItemSoakComponent.h"
+
+#include "GameItem.h"
+#include "GameItemContainer.h"
+#include "GameItemControllerComponent.h"
+#include "GameItemDef.h"
+#include "GameItemsBenchmark.h"
+#include "GameItemsModule.h"
+#include "GameItemsNetStats.h"
+#include "GameItemStatics.h"
+#include "GameItemSubsystem.h"
+#include "TimerManager.h"
+#include "CoreGlobals.h"
+#include "Containers/Ticker.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "Net/UnrealNetwork.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameItemSoakComponent)
+
+CSV_DEFINE_CATEGORY(GameItemsSoak, true);
+
+
+namespace GameItems::Soak
+{
+	/** Records server frame times while soaking. */
+	struct FFrameStats
+	{
+		FTSTicker::FDelegateHandle TickerHandle;
+		int32 NumFrames = 0;
+		double TotalGameThreadMs = 0.0;
+		double MaxGameThreadMs = 0.0;
+
+		bool Tick(float DeltaTime)
+		{
+			const double GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+			++NumFrames;
+			TotalGameThreadMs += GameThreadMs;
+			MaxGameThreadMs = FMath::Max(MaxGameThreadMs, GameThreadMs);
+
+			CSV_CUSTOM_STAT(GameItemsSoak, ServerGameThreadMs, static_cast<float>(GameThreadMs), ECsvCustomStatOp::Set);
+			return true;
+		}
+	};
+
+	FFrameStats FrameStats;
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice StartCommand(
+		TEXT("GameItems.Soak.Start"),
+		TEXT("Start soak testing item replication with bots for all players. Must be run on the server. Usage: GameItems.Soak.Start [OpsPerSecond]"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			const float OpsPerSecond = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 10.f;
+			UGameItemSoakComponent::StartSoak(World, OpsPerSecond);
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice StopCommand(
+		TEXT("GameItems.Soak.Stop"),
+		TEXT("Stop soak testing item replication, and print the results."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UGameItemSoakComponent::DumpStats(World, Ar);
+			UGameItemSoakComponent::StopSoak(World);
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpCommand(
+		TEXT("GameItems.Soak.Dump"),
+		TEXT("Print the server frame times, bandwidth, prediction counts and divergences recorded while soak testing."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UGameItemSoakComponent::DumpStats(World, Ar);
+		}));
+}
+
+
+UGameItemSoakComponent::UGameItemSoakComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	SetIsReplicatedByDefault(true);
+}
+
+void UGameItemSoakComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	Params.Condition = COND_OwnerOnly;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, OpsPerSecond, Params);
+}
+
+void UGameItemSoakComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	StartBot();
+}
+
+void UGameItemSoakComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(BotTimer);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGameItemSoakComponent::StartSoak(UWorld* World, float InOpsPerSecond)
+{
+	if (!World || World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogGameItems, Error, TEXT("[%hs] Soak testing must be started on the server"), __func__);
+		return;
+	}
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (!PlayerController)
+		{
+			continue;
+		}
+
+		UGameItemSoakComponent* SoakComponent = PlayerController->FindComponentByClass<UGameItemSoakComponent>();
+		if (!SoakComponent)
+		{
+			SoakComponent = NewObject<UGameItemSoakComponent>(PlayerController);
+			SoakComponent->OpsPerSecond = InOpsPerSecond;
+			SoakComponent->RegisterComponent();
+		}
+		else
+		{
+			SoakComponent->OpsPerSecond = InOpsPerSecond;
+			MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, OpsPerSecond, SoakComponent);
+			SoakComponent->StartBot();
+		}
+
+		// give each player something to start with
+		SoakComponent->LootItems();
+	}
+
+	GameItems::Soak::FFrameStats& FrameStats = GameItems::Soak::FrameStats;
+	if (!FrameStats.TickerHandle.IsValid())
+	{
+		FrameStats = GameItems::Soak::FFrameStats();
+		FrameStats.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateRaw(&FrameStats, &GameItems::Soak::FFrameStats::Tick));
+	}
+
+	UE_LOG(LogGameItems, Log, TEXT("[%hs] Started soak testing with %.1f ops/s"), __func__, InOpsPerSecond);
+}
+
+void UGameItemSoakComponent::StopSoak(UWorld* World)
+{
+	if (World)
+	{
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			APlayerController* PlayerController = It->Get();
+			if (UGameItemSoakComponent* SoakComponent = PlayerController ? PlayerController->FindComponentByClass<UGameItemSoakComponent>() : nullptr)
+			{
+				SoakComponent->DestroyComponent();
+			}
+		}
+	}
+
+	GameItems::Soak::FFrameStats& FrameStats = GameItems::Soak::FrameStats;
+	if (FrameStats.TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(FrameStats.TickerHandle);
+		FrameStats.TickerHandle.Reset();
+	}
+}
+
+void UGameItemSoakComponent::DumpStats(UWorld* World, FOutputDevice& Ar)
+{
+	const GameItems::Soak::FFrameStats& FrameStats = GameItems::Soak::FrameStats;
+
+	Ar.Logf(TEXT("Game Items Soak Stats"));
+	Ar.Logf(TEXT("Server game thread: avg %.2f ms, max %.2f ms (%d frames)"),
+	        FrameStats.NumFrames > 0 ? FrameStats.TotalGameThreadMs / FrameStats.NumFrames : 0.0,
+	        FrameStats.MaxGameThreadMs, FrameStats.NumFrames);
+
+	if (!World)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		const UGameItemSoakComponent* SoakComponent = PlayerController ? PlayerController->FindComponentByClass<UGameItemSoakComponent>() : nullptr;
+		if (!SoakComponent)
+		{
+			continue;
+		}
+
+		const UNetConnection* Connection = PlayerController->GetNetConnection();
+		Ar.Logf(TEXT("  %s: in %d B/s, out %d B/s, %d ops, %d reports, %d divergences, %d pending predictions (max %d)"),
+		        *PlayerController->GetName(),
+		        Connection ? Connection->InBytesPerSecond : 0,
+		        Connection ? Connection->OutBytesPerSecond : 0,
+		        SoakComponent->ReportedNumOps, SoakComponent->NumReports, SoakComponent->NumDivergences,
+		        SoakComponent->ReportedPendingPredictions, SoakComponent->ReportedMaxPendingPredictions);
+
+		// only recorded while GameItems.NetStats.Enabled is set or a CSV profile is capturing
+		if (const FGameItemsNetStats::FConnectionStats* NetStats = FGameItemsNetStats::Get().FindConnectionStats(Connection))
+		{
+			Ar.Logf(TEXT("    game items sent: %lld bytes, received: %lld bytes, RPCs: %lld bytes (%d)"),
+			        NetStats->Sent.NumBytes, NetStats->Received.NumBytes, NetStats->Rpcs.NumBytes, NetStats->Rpcs.Count);
+		}
+	}
+}
+
+uint32 UGameItemSoakComponent::GetContainerChecksum(const UGameItemContainer* Container)
+{
+	if (!Container)
+	{
+		return 0;
+	}
+
+	TMap<int32, UGameItem*> ItemsBySlot = Container->GetAllItems();
+	ItemsBySlot.KeySort(TLess<int32>());
+
+	// use item def paths since names are not guaranteed to hash the same in different processes
+	uint32 Checksum = 0;
+	for (const auto& Elem : ItemsBySlot)
+	{
+		const UGameItem* Item = Elem.Value;
+		Checksum = HashCombine(Checksum, GetTypeHash(Elem.Key));
+		Checksum = HashCombine(Checksum, Item && Item->GetItemDef() ? GetTypeHash(Item->GetItemDef()->GetPathName()) : 0);
+		Checksum = HashCombine(Checksum, Item ? GetTypeHash(Item->GetCount()) : 0);
+	}
+	return Checksum;
+}
+
+void UGameItemSoakComponent::OnRep_OpsPerSecond()
+{
+	StartBot();
+}
+
+void UGameItemSoakComponent::ServerReportState_Implementation(
+	const TArray<FGameItemSoakContainerState>& States,
+	int32 NumOps,
+	int32 NumPendingPredictions,
+	int32 InMaxPendingPredictions)
+{
+	++NumReports;
+	ReportedNumOps = NumOps;
+	ReportedPendingPredictions = NumPendingPredictions;
+	ReportedMaxPendingPredictions = FMath::Max(ReportedMaxPendingPredictions, InMaxPendingPredictions);
+
+	int32 NumNewDivergences = 0;
+	for (const FGameItemSoakContainerState& State : States)
+	{
+		// client-only containers can't be resolved on the server
+		if (!State.Container)
+		{
+			continue;
+		}
+
+		if (GetContainerChecksum(State.Container) != State.Checksum)
+		{
+			++NumNewDivergences;
+			UE_LOG(LogGameItems, Warning, TEXT("%s [%hs] Client container diverged from server: %s (Server: %d items, Client: %d items)"),
+			       *UGameItemStatics::GetNetDebugPrefix(this), __func__, *State.Container->GetReadableName(),
+			       State.Container->GetNumItems(), State.NumItems);
+		}
+	}
+	NumDivergences += NumNewDivergences;
+
+	CSV_CUSTOM_STAT(GameItemsSoak, Reports, 1, ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(GameItemsSoak, Divergences, NumNewDivergences, ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(GameItemsSoak, MaxPendingPredictions, InMaxPendingPredictions, ECsvCustomStatOp::Max);
+
+	LootItems();
+}
+
+void UGameItemSoakComponent::StartBot()
+{
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (!PlayerController || !PlayerController->IsLocalController() || !HasBegunPlay())
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	if (OpsPerSecond <= 0.f)
+	{
+		World->GetTimerManager().ClearTimer(BotTimer);
+		return;
+	}
+
+	SettleStartTime = World->GetTimeSeconds() + ActiveTime;
+	World->GetTimerManager().SetTimer(BotTimer, this, &UGameItemSoakComponent::TickBot, 1.f / OpsPerSecond, true);
+}
+
+void UGameItemSoakComponent::TickBot()
+{
+	const UGameItemControllerComponent* Controller = GetControllerComponent();
+	if (!Controller)
+	{
+		return;
+	}
+
+	const int32 NumPendingPredictions = Controller->GetNumPendingPredictionKeys();
+	MaxPendingPredictions = FMath::Max(MaxPendingPredictions, NumPendingPredictions);
+
+	const double Time = GetWorld()->GetTimeSeconds();
+	if (Time < SettleStartTime)
+	{
+		PerformRandomOp();
+		return;
+	}
+
+	// wait for replication and confirmations to catch up before comparing state with the server
+	const double SettleElapsed = Time - SettleStartTime;
+	if (SettleElapsed < SettleTime || (NumPendingPredictions > 0 && SettleElapsed < SettleTimeout))
+	{
+		return;
+	}
+
+	TArray<FGameItemSoakContainerState> States;
+	for (UGameItemContainer* Container : GetPlayerContainers())
+	{
+		FGameItemSoakContainerState& State = States.AddDefaulted_GetRef();
+		State.Container = Container;
+		State.Checksum = GetContainerChecksum(Container);
+		State.NumItems = Container->GetNumItems();
+	}
+
+	ServerReportState(States, NumBotOps, NumPendingPredictions, MaxPendingPredictions);
+
+	MaxPendingPredictions = 0;
+	SettleStartTime = Time + ActiveTime;
+}
+
+void UGameItemSoakComponent::PerformRandomOp()
+{
+	UGameItemControllerComponent* Controller = GetControllerComponent();
+	const TArray<UGameItemContainer*> Containers = GetPlayerContainers();
+	if (!Controller || Containers.IsEmpty())
+	{
+		return;
+	}
+
+	UGameItemContainer* From = Containers[FMath::RandHelper(Containers.Num())];
+	UGameItemContainer* To = Containers[FMath::RandHelper(Containers.Num())];
+
+	const TMap<int32, UGameItem*> ItemsBySlot = From->GetAllItems();
+	if (ItemsBySlot.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<int32> Slots;
+	ItemsBySlot.GetKeys(Slots);
+	const int32 Slot = Slots[FMath::RandHelper(Slots.Num())];
+	UGameItem* Item = ItemsBySlot.FindRef(Slot);
+
+	++NumBotOps;
+
+	switch (FMath::RandHelper(6))
+	{
+	case 0:
+		From->SwapItems(Slot, FMath::RandHelper(From->GetNumSlots()));
+		break;
+	case 1:
+		for (const auto& Elem : ItemsBySlot)
+		{
+			if (Elem.Key != Slot && Elem.Value && Elem.Value->IsMatching(Item))
+			{
+				From->StackItems(Slot, Elem.Key);
+				break;
+			}
+		}
+		break;
+	case 2:
+		Controller->MoveSwapOrStackItem(From, Item, To, FMath::RandHelper(FMath::Max(To->GetNumSlots(), 1)));
+		break;
+	case 3:
+		Controller->MoveItem(From, To, Item);
+		break;
+	case 4:
+		{
+			UGameItemControllerComponent::FScopedTransaction Transaction(Controller);
+			From->SwapItems(Slot, FMath::RandHelper(From->GetNumSlots()));
+			From->SwapItems(FMath::RandHelper(From->GetNumSlots()), FMath::RandHelper(From->GetNumSlots()));
+			break;
+		}
+	default:
+		From->RemoveItem(Item);
+		break;
+	}
+}
+
+void UGameItemSoakComponent::LootItems()
+{
+	UGameItemSubsystem* ItemSubsystem = UGameItemSubsystem::Get(this);
+	TArray<UGameItemContainer*> Containers = GetPlayerContainers();
+	Containers.RemoveAll([](const UGameItemContainer* Container)
+	{
+		return Container->IsChild();
+	});
+	if (!ItemSubsystem || Containers.IsEmpty())
+	{
+		return;
+	}
+
+	// loot more of the items the player already has, so that they can be stacked
+	TArray<TSubclassOf<UGameItemDef>> ItemDefs;
+	int32 NumItems = 0;
+	for (const UGameItemContainer* Container : Containers)
+	{
+		for (const auto& Elem : Container->GetAllItems())
+		{
+			if (Elem.Value)
+			{
+				ItemDefs.AddUnique(Elem.Value->GetItemDef());
+			}
+		}
+		NumItems += Container->GetNumItems();
+	}
+	if (ItemDefs.IsEmpty())
+	{
+		ItemDefs.Add(UGameItemDef_Benchmark::StaticClass());
+	}
+
+	const int32 NumToLoot = FMath::Min(FMath::RandRange(1, 3), MaxLootedItems - NumItems);
+	for (int32 Idx = 0; Idx < NumToLoot; ++Idx)
+	{
+		UGameItemContainer* Container = Containers[FMath::RandHelper(Containers.Num())];
+		ItemSubsystem->CreateItemInContainer(Container, ItemDefs[FMath::RandHelper(ItemDefs.Num())], FMath::RandRange(1, 5), false);
+	}
+}
+
+UGameItemControllerComponent* UGameItemSoakComponent::GetControllerComponent() const
+{
+	return GetOwner() ? GetOwner()->FindComponentByClass<UGameItemControllerComponent>() : nullptr;
+}
+
+TArray<UGameItemContainer*> UGameItemSoakComponent::GetPlayerContainers() const
+{
+	TArray<UGameItemContainer*> Containers;
+
+	APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (!PlayerController)
+	{
+		return Containers;
+	}
+
+	AActor* Actors[] = {PlayerController, PlayerController->GetPlayerState<APlayerState>(), PlayerController->GetPawn()};
+	for (AActor* Actor : Actors)
+	{
+		if (!Actor)
+		{
+			continue;
+		}
+
+		for (UGameItemContainer* Container : UGameItemStatics::GetAllItemContainersForActor(Actor))
+		{
+			// only soak containers that exist on both server and client
+			if (Container && Container->IsReplicated())
+			{
+				Containers.AddUnique(Container);
+			}
+		}
+	}
+	return Containers;
+}
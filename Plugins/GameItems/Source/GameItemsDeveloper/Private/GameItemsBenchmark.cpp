@@ -0,0 +1,442 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "GameItemsBenchmark.h"
+
+#include "GameItem.h"
+#include "GameItemContainer.h"
+#include "GameItemSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "UObject/UObjectArray.h"
+#include "UObject/UObjectGlobals.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameItemsBenchmark)
+
+
+UGameItemDef_Benchmark::UGameItemDef_Benchmark(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	StackLimit.bLimitCount = true;
+	StackLimit.MaxCount = 100;
+}
+
+UGameItemContainerDef_BenchmarkLimited::UGameItemContainerDef_BenchmarkLimited(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bLimitSlots = true;
+	SlotCount = 10;
+	NetExecutionPolicy = EGameItemContainerNetExecutionPolicy::LocalOnly;
+}
+
+UGameItemContainerDef_BenchmarkUnlimited::UGameItemContainerDef_BenchmarkUnlimited(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	NetExecutionPolicy = EGameItemContainerNetExecutionPolicy::LocalOnly;
+}
+
+
+namespace GameItems::Benchmark
+{
+	/** Counts the UObjects created while in scope. */
+	class FObjectCreateCounter : public FUObjectArray::FUObjectCreateListener
+	{
+	public:
+		FObjectCreateCounter()
+		{
+			GUObjectArray.AddUObjectCreateListener(this);
+		}
+
+		~FObjectCreateCounter()
+		{
+			GUObjectArray.RemoveUObjectCreateListener(this);
+		}
+
+		virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override
+		{
+			++NumCreated;
+		}
+
+		virtual void OnUObjectArrayShutdown() override
+		{
+			GUObjectArray.RemoveUObjectCreateListener(this);
+		}
+
+		int32 NumCreated = 0;
+	};
+
+	bool FRunner::Run(const TArray<int32>& Sizes, int32 NumRuns)
+	{
+		ItemSubsystem = UGameItemSubsystem::Get(World);
+		if (!ItemSubsystem)
+		{
+			Ar.Logf(ELogVerbosity::Error, TEXT("GameItems.Benchmark requires a game world with a game instance"));
+			return false;
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		OwnerActor = World->SpawnActor<AActor>(SpawnParams);
+		if (!OwnerActor)
+		{
+			Ar.Logf(ELogVerbosity::Error, TEXT("GameItems.Benchmark failed to spawn owner actor"));
+			return false;
+		}
+
+		// all items fit exactly in limited containers, restoring the default when done
+		UGameItemContainerDef_BenchmarkLimited* LimitedContainerDef = GetMutableDefault<UGameItemContainerDef_BenchmarkLimited>();
+		TGuardValue<int32> SlotCountGuard(LimitedContainerDef->SlotCount, LimitedContainerDef->SlotCount);
+
+		for (const int32 NumItems : Sizes)
+		{
+			LimitedContainerDef->SlotCount = NumItems;
+
+			RunAllCases(true, NumItems, NumRuns);
+			RunAllCases(false, NumItems, NumRuns);
+
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+
+		OwnerActor->Destroy();
+		OwnerActor = nullptr;
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		return true;
+	}
+
+	void FRunner::RunAllCases(bool bLimitSlots, int32 NumItems, int32 NumRuns)
+	{
+		UGameItemContainer* ContainerA = nullptr;
+		UGameItemContainer* ContainerB = nullptr;
+		TArray<UGameItem*> Items;
+		const TSubclassOf<UGameItemDef> ItemDef = UGameItemDef_Benchmark::StaticClass();
+
+		// counting is O(n) per call, so limit the number of calls for large containers
+		const int32 NumCountOps = FMath::Min(NumItems, 1000);
+
+		RunCase(TEXT("AddItem"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				Items = CreateItems(NumItems);
+			},
+			[&]
+			{
+				for (UGameItem* Item : Items)
+				{
+					ContainerA->AddItem(Item, INDEX_NONE, false);
+				}
+				return Items.Num();
+			});
+
+		RunCase(TEXT("RemoveItem"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				Items = CreateFilledContainer(ContainerA, NumItems);
+			},
+			[&]
+			{
+				for (UGameItem* Item : Items)
+				{
+					ContainerA->RemoveItem(Item);
+				}
+				return Items.Num();
+			});
+
+		RunCase(TEXT("StackItems"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				Items = CreateFilledContainer(ContainerA, NumItems);
+			},
+			[&]
+			{
+				// stack from the end, so that removing emptied stacks doesn't change the slots still to be stacked
+				const int32 NumPairs = NumItems / 2;
+				for (int32 Idx = NumPairs - 1; Idx >= 0; --Idx)
+				{
+					ContainerA->StackItems(Idx * 2 + 1, Idx * 2);
+				}
+				return NumPairs;
+			});
+
+		RunCase(TEXT("SwapItems"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				Items = CreateFilledContainer(ContainerA, NumItems);
+			},
+			[&]
+			{
+				const int32 NumPairs = NumItems / 2;
+				for (int32 Idx = 0; Idx < NumPairs; ++Idx)
+				{
+					ContainerA->SwapItems(Idx, NumItems - Idx - 1);
+				}
+				return NumPairs;
+			});
+
+		RunCase(TEXT("GetItemSlot"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				Items = CreateFilledContainer(ContainerA, NumItems);
+			},
+			[&]
+			{
+				int32 SlotSum = 0;
+				for (const UGameItem* Item : Items)
+				{
+					SlotSum += ContainerA->GetItemSlot(Item);
+				}
+				check(SlotSum >= 0);
+				return Items.Num();
+			});
+
+		RunCase(TEXT("GetTotalItemCountByDef"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				Items = CreateFilledContainer(ContainerA, NumItems);
+			},
+			[&]
+			{
+				int32 CountSum = 0;
+				for (int32 Idx = 0; Idx < NumCountOps; ++Idx)
+				{
+					CountSum += ContainerA->GetTotalItemCountByDef(ItemDef);
+				}
+				check(CountSum >= 0);
+				return NumCountOps;
+			});
+
+		RunCase(TEXT("MoveItem"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				ContainerB = CreateContainer(bLimitSlots);
+				Items = CreateFilledContainer(ContainerA, NumItems);
+			},
+			[&]
+			{
+				for (UGameItem* Item : Items)
+				{
+					ItemSubsystem->MoveItem(ContainerA, ContainerB, Item, INDEX_NONE, false);
+				}
+				return Items.Num();
+			});
+
+		RunCase(TEXT("MoveAllItems"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				ContainerB = CreateContainer(bLimitSlots);
+				Items = CreateFilledContainer(ContainerA, NumItems);
+			},
+			[&]
+			{
+				ItemSubsystem->MoveAllItems(ContainerA, ContainerB, false);
+				return Items.Num();
+			});
+
+		RunCase(TEXT("SaveLoad"), bLimitSlots, NumItems, NumRuns,
+			[&]
+			{
+				ContainerA = CreateContainer(bLimitSlots);
+				ContainerB = CreateContainer(bLimitSlots);
+				Items = CreateFilledContainer(ContainerA, NumItems);
+			},
+			[&]
+			{
+				// save, serialize to bytes and back, then load into another container
+				FGameItemContainerSaveData SaveData;
+				TMap<UGameItem*, FGuid> SavedItems;
+				ContainerA->CommitSaveData(SaveData, SavedItems);
+
+				TArray<uint8> Bytes;
+				FMemoryWriter MemWriter(Bytes);
+				FObjectAndNameAsStringProxyArchive WriteAr(MemWriter, true);
+				WriteAr.ArIsSaveGame = true;
+				FGameItemContainerSaveData::StaticStruct()->SerializeItem(WriteAr, &SaveData, nullptr);
+
+				FGameItemContainerSaveData LoadData;
+				FMemoryReader MemReader(Bytes);
+				FObjectAndNameAsStringProxyArchive ReadAr(MemReader, true);
+				ReadAr.ArIsSaveGame = true;
+				FGameItemContainerSaveData::StaticStruct()->SerializeItem(ReadAr, &LoadData, nullptr);
+
+				TMap<FGuid, UGameItem*> LoadedItems;
+				ContainerB->LoadSaveData(LoadData, false, LoadedItems);
+				return Items.Num();
+			});
+	}
+
+	void FRunner::RunCase(const TCHAR* Name, bool bLimitSlots, int32 NumItems, int32 NumRuns, TFunctionRef<void()> Setup, TFunctionRef<int32()> Op)
+	{
+		FResult& Result = Results.AddDefaulted_GetRef();
+		Result.Name = Name;
+		Result.bLimitSlots = bLimitSlots;
+		Result.NumItems = NumItems;
+
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			Setup();
+
+			const uint64 StartUsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+			FObjectCreateCounter ObjectCounter;
+
+			const double StartTime = FPlatformTime::Seconds();
+			Result.NumOps = Op();
+			const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+			++Result.NumRuns;
+			Result.TotalSeconds += Seconds;
+			if (Seconds < Result.MinSeconds)
+			{
+				Result.MinSeconds = Seconds;
+				Result.NumObjectsCreated = ObjectCounter.NumCreated;
+				Result.UsedMemoryDelta = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<int64>(StartUsedMemory);
+			}
+
+			FinishRun();
+		}
+
+		Ar.Logf(TEXT("  %-24s %-9s %6d items: %12.1f ns/op (mean %12.1f), %6d objects"),
+			*Result.Name, bLimitSlots ? TEXT("Limited") : TEXT("Unlimited"), NumItems,
+			Result.GetNsPerOp(), Result.GetMeanNsPerOp(), Result.NumObjectsCreated);
+	}
+
+	UGameItemContainer* FRunner::CreateContainer(bool bLimitSlots)
+	{
+		UGameItemContainer* Container = NewObject<UGameItemContainer>(OwnerActor, NAME_None, RF_Transient);
+		if (bLimitSlots)
+		{
+			Container->SetContainerDef(UGameItemContainerDef_BenchmarkLimited::StaticClass());
+		}
+		else
+		{
+			Container->SetContainerDef(UGameItemContainerDef_BenchmarkUnlimited::StaticClass());
+		}
+		RunObjects.Add(Container);
+		return Container;
+	}
+
+	TArray<UGameItem*> FRunner::CreateItems(int32 NumItems)
+	{
+		TArray<UGameItem*> NewItems;
+		NewItems.Reserve(NumItems);
+		for (int32 Idx = 0; Idx < NumItems; ++Idx)
+		{
+			UGameItem* Item = ItemSubsystem->CreateItem(OwnerActor, UGameItemDef_Benchmark::StaticClass(), 1);
+			NewItems.Add(Item);
+			RunObjects.Add(Item);
+		}
+		return NewItems;
+	}
+
+	TArray<UGameItem*> FRunner::CreateFilledContainer(UGameItemContainer* Container, int32 NumItems)
+	{
+		TArray<UGameItem*> NewItems = CreateItems(NumItems);
+		for (UGameItem* Item : NewItems)
+		{
+			Container->AddItem(Item, INDEX_NONE, false);
+		}
+		return NewItems;
+	}
+
+	void FRunner::FinishRun()
+	{
+		for (UObject* Object : RunObjects)
+		{
+			if (IsValid(Object))
+			{
+				Object->MarkAsGarbage();
+			}
+		}
+		RunObjects.Reset();
+	}
+
+	FString FRunner::ToJson() const
+	{
+		FString Json = TEXT("{\n\t\"results\": [\n");
+		for (int32 Idx = 0; Idx < Results.Num(); ++Idx)
+		{
+			const FResult& Result = Results[Idx];
+			Json += FString::Printf(
+				TEXT("\t\t{\"name\": \"%s\", \"slots\": \"%s\", \"items\": %d, \"ops\": %d, \"runs\": %d, ")
+				TEXT("\"nsPerOp\": %.1f, \"meanNsPerOp\": %.1f, \"objectsCreated\": %d, \"usedMemoryDelta\": %lld}%s\n"),
+				*Result.Name, Result.bLimitSlots ? TEXT("Limited") : TEXT("Unlimited"), Result.NumItems, Result.NumOps, Result.NumRuns,
+				Result.GetNsPerOp(), Result.GetMeanNsPerOp(), Result.NumObjectsCreated, Result.UsedMemoryDelta,
+				Idx < Results.Num() - 1 ? TEXT(",") : TEXT(""));
+		}
+		Json += TEXT("\t]\n}\n");
+		return Json;
+	}
+
+	FString FRunner::ToCsv() const
+	{
+		FString Csv = TEXT("Name,Slots,Items,Ops,Runs,NsPerOp,MeanNsPerOp,ObjectsCreated,UsedMemoryDelta\n");
+		for (const FResult& Result : Results)
+		{
+			Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%.1f,%.1f,%d,%lld\n"),
+				*Result.Name, Result.bLimitSlots ? TEXT("Limited") : TEXT("Unlimited"), Result.NumItems, Result.NumOps,
+				Result.NumRuns, Result.GetNsPerOp(), Result.GetMeanNsPerOp(), Result.NumObjectsCreated, Result.UsedMemoryDelta);
+		}
+		return Csv;
+	}
+
+	FString FRunner::SaveResults(const FString& FileName) const
+	{
+		const FString BasePath = FPaths::ConvertRelativePathToFull(FPaths::ProfilingDir() / TEXT("GameItems") / FileName);
+		FFileHelper::SaveStringToFile(ToJson(), *(BasePath + TEXT(".json")));
+		FFileHelper::SaveStringToFile(ToCsv(), *(BasePath + TEXT(".csv")));
+		return BasePath;
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice BenchmarkCommand(
+		TEXT("GameItems.Benchmark"),
+		TEXT("Benchmark container operations and write the results to Saved/Profiling/GameItems as json and csv. ")
+		TEXT("Usage: GameItems.Benchmark [Sizes=10,100,1000,10000] [Runs=3] [Out=FileName]"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			const FString Cmd = FString::Join(Args, TEXT(" "));
+
+			TArray<int32> Sizes = DefaultSizes;
+			FString SizesStr;
+			if (FParse::Value(*Cmd, TEXT("Sizes="), SizesStr, false))
+			{
+				TArray<FString> SizeStrs;
+				SizesStr.ParseIntoArray(SizeStrs, TEXT(","));
+				Sizes.Reset();
+				for (const FString& SizeStr : SizeStrs)
+				{
+					Sizes.Add(FMath::Max(FCString::Atoi(*SizeStr), 1));
+				}
+			}
+
+			int32 NumRuns = DefaultNumRuns;
+			FParse::Value(*Cmd, TEXT("Runs="), NumRuns);
+			NumRuns = FMath::Max(NumRuns, 1);
+
+			FString FileName = FString::Printf(TEXT("Benchmark-%s"), *FDateTime::Now().ToString());
+			FParse::Value(*Cmd, TEXT("Out="), FileName);
+
+			Ar.Logf(TEXT("Running GameItems benchmark (%d runs)..."), NumRuns);
+
+			FRunner Runner(World, Ar);
+			if (!Runner.Run(Sizes, NumRuns))
+			{
+				return;
+			}
+
+			const FString BasePath = Runner.SaveResults(FileName);
+			Ar.Logf(TEXT("Wrote GameItems benchmark results to %s.json/.csv"), *BasePath);
+		}));
+}
@@ -0,0 +1,141 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameItemContainerDef.h"
+#include "GameItemDef.h"
+#include "GameItemsBenchmark.generated.h"
+
+class AActor;
+class UGameItem;
+class UGameItemContainer;
+class UGameItemSubsystem;
+
+
+/**
+ * A stackable item used by the GameItems benchmark and soak tests.
+ */
+UCLASS(NotBlueprintable, HideDropdown)
+class UGameItemDef_Benchmark : public UGameItemDef
+{
+	GENERATED_BODY()
+
+public:
+	UGameItemDef_Benchmark(const FObjectInitializer& ObjectInitializer);
+};
+
+
+/**
+ * A local-only container with a limited number of slots, used by the GameItems benchmark.
+ * The slot count is set on the CDO during each benchmark to match the number of items, and restored afterwards.
+ */
+UCLASS(NotBlueprintable, HideDropdown)
+class UGameItemContainerDef_BenchmarkLimited : public UGameItemContainerDef
+{
+	GENERATED_BODY()
+
+public:
+	UGameItemContainerDef_BenchmarkLimited(const FObjectInitializer& ObjectInitializer);
+};
+
+
+/**
+ * A local-only container with unlimited slots, used by the GameItems benchmark.
+ */
+UCLASS(NotBlueprintable, HideDropdown)
+class UGameItemContainerDef_BenchmarkUnlimited : public UGameItemContainerDef
+{
+	GENERATED_BODY()
+
+public:
+	UGameItemContainerDef_BenchmarkUnlimited(const FObjectInitializer& ObjectInitializer);
+};
+
+
+namespace GameItems::Benchmark
+{
+	/** The container sizes to benchmark by default. */
+	inline const TArray<int32> DefaultSizes = {10, 100, 1000, 10000};
+
+	/** The number of runs of each case by default. */
+	constexpr int32 DefaultNumRuns = 3;
+
+	/** The results of a benchmark for one operation, container size and slot mode. */
+	struct FResult
+	{
+		FString Name;
+		bool bLimitSlots = false;
+		int32 NumItems = 0;
+
+		/** The number of operations performed in each run. */
+		int32 NumOps = 0;
+		int32 NumRuns = 0;
+
+		/** The fastest run, used for the reported ns/op since it's the least affected by noise. */
+		double MinSeconds = MAX_dbl;
+		double TotalSeconds = 0.0;
+
+		/** The number of UObjects created during the fastest run. */
+		int32 NumObjectsCreated = 0;
+
+		/** The change in used physical memory during the fastest run. */
+		int64 UsedMemoryDelta = 0;
+
+		double GetNsPerOp() const
+		{
+			return NumOps > 0 ? MinSeconds * 1e9 / NumOps : 0.0;
+		}
+
+		double GetMeanNsPerOp() const
+		{
+			return NumOps > 0 && NumRuns > 0 ? TotalSeconds * 1e9 / (NumOps * NumRuns) : 0.0;
+		}
+	};
+
+	/**
+	 * Runs each container operation for a range of container sizes in both limited and unlimited slot modes.
+	 * Items and containers are created on a transient actor, and everything created is garbage collected between sizes.
+	 */
+	class FRunner
+	{
+	public:
+		FRunner(UWorld* InWorld, FOutputDevice& InAr)
+			: World(InWorld),
+			  Ar(InAr)
+		{
+		}
+
+		bool Run(const TArray<int32>& Sizes, int32 NumRuns);
+
+		FString ToJson() const;
+		FString ToCsv() const;
+
+		/** Write the results to Saved/Profiling/GameItems as json and csv, returning the full path without extension. */
+		FString SaveResults(const FString& FileName) const;
+
+	private:
+		UWorld* World;
+		FOutputDevice& Ar;
+		UGameItemSubsystem* ItemSubsystem = nullptr;
+		AActor* OwnerActor = nullptr;
+		TArray<FResult> Results;
+
+		/** Everything created for the current run, marked as garbage when the run is complete. */
+		TArray<UObject*> RunObjects;
+
+		void RunAllCases(bool bLimitSlots, int32 NumItems, int32 NumRuns);
+
+		/**
+		 * Run an operation multiple times and record the result.
+		 * @param Setup Called before each run to create the containers and items needed, which is not measured.
+		 * @param Op Perform the operation being measured, returning the number of operations performed.
+		 */
+		void RunCase(const TCHAR* Name, bool bLimitSlots, int32 NumItems, int32 NumRuns, TFunctionRef<void()> Setup, TFunctionRef<int32()> Op);
+
+		UGameItemContainer* CreateContainer(bool bLimitSlots);
+		TArray<UGameItem*> CreateItems(int32 NumItems);
+		TArray<UGameItem*> CreateFilledContainer(UGameItemContainer* Container, int32 NumItems);
+		void FinishRun();
+	};
+}
@@ -0,0 +1,19 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#include "GameItemSoakComponent.h"
+#include "Modules/ModuleManager.h"
+
+
+class FGameItemsDeveloperModule : public IModuleInterface
+{
+	virtual void ShutdownModule() override;
+};
+
+IMPLEMENT_MODULE(FGameItemsDeveloperModule, GameItemsDeveloper)
+
+
+void FGameItemsDeveloperModule::ShutdownModule()
+{
+	// make sure the soak frame stats ticker doesn't outlive the module
+	UGameItemSoakComponent::StopSoak(nullptr);
+}
@@ -0,0 +1,40 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "GameItemsBenchmark.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameItemsBenchmarkTest, "GameItems.Benchmark",
+                                 EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGameItemsBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace GameItems::Benchmark;
+
+	// items are created by the item subsystem, so run in a new game world with its own game instance
+	UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->InitializeStandalone();
+	UWorld* World = GameInstance->GetWorld();
+
+	FRunner Runner(World, *GLog);
+	const bool bSuccess = Runner.Run(DefaultSizes, DefaultNumRuns);
+	if (bSuccess)
+	{
+		const FString BasePath = Runner.SaveResults(FString::Printf(TEXT("Benchmark-%s"), *FDateTime::Now().ToString()));
+		AddInfo(FString::Printf(TEXT("Wrote GameItems benchmark results to %s.json/.csv"), *BasePath));
+	}
+
+	GameInstance->Shutdown();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	TestTrue(TEXT("Benchmark completed"), bSuccess);
+	return true;
+}
+
+#endif
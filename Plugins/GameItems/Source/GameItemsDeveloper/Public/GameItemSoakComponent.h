@@ -0,0 +1,129 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GameItemSoakComponent.generated.h"
+
+class UGameItem;
+class UGameItemContainer;
+class UGameItemControllerComponent;
+
+
+/**
+ * The state of a container as seen by a client, sent to the server to check for divergence.
+ */
+USTRUCT()
+struct FGameItemSoakContainerState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UGameItemContainer> Container;
+
+	UPROPERTY()
+	uint32 Checksum = 0;
+
+	UPROPERTY()
+	int32 NumItems = 0;
+};
+
+
+/**
+ * Drives a scripted bot that moves, swaps, stacks, transfers and drops items for a player,
+ * while the server periodically loots new items into the player's containers.
+ * Used to soak test item replication and prediction under load.
+ *
+ * Added to all player controllers on the server by 'GameItems.Soak.Start', and removed by 'GameItems.Soak.Stop'.
+ * Only available in builds with developer tools, so it's never compiled into shipping builds.
+ * Run with a dedicated server and any number of clients, either in PIE using a single process,
+ * or as separate -nullrhi processes connected over loopback.
+ *
+ * Bots alternate between performing operations and settling. Once settled with no pending predictions,
+ * the client reports a checksum of each container to the server, which records any divergence from
+ * its own state. 'GameItems.Soak.Dump' prints server frame times, bandwidth and prediction counts per
+ * connection, and divergences. Totals are also reported in the GameItemsSoak CSV category.
+ */
+UCLASS(NotBlueprintable)
+class GAMEITEMSDEVELOPER_API UGameItemSoakComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UGameItemSoakComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Add soak components to all player controllers in a world. Must be called on the server. */
+	static void StartSoak(UWorld* World, float InOpsPerSecond);
+
+	/** Remove all soak components from player controllers in a world, and stop recording frame stats. */
+	static void StopSoak(UWorld* World);
+
+	/** Print the soak stats for all connections in a world. */
+	static void DumpStats(UWorld* World, FOutputDevice& Ar);
+
+	/** Return a checksum of the slots, definitions and counts of all items in a container. */
+	static uint32 GetContainerChecksum(const UGameItemContainer* Container);
+
+protected:
+	/** The number of bot operations to perform per second while active. */
+	UPROPERTY(ReplicatedUsing = OnRep_OpsPerSecond)
+	float OpsPerSecond = 10.f;
+
+	/** The time spent performing operations before settling and reporting container state. */
+	float ActiveTime = 4.f;
+
+	/** The time to wait without performing operations before reporting container state. */
+	float SettleTime = 1.f;
+
+	/** The maximum time to wait for pending predictions to be confirmed while settling. */
+	float SettleTimeout = 10.f;
+
+	/** The maximum number of items the server will loot into a player's containers. */
+	int32 MaxLootedItems = 40;
+
+	UFUNCTION()
+	void OnRep_OpsPerSecond();
+
+	/** Send the client's container state and prediction counts to the server, and receive more loot. */
+	UFUNCTION(Server, Reliable)
+	void ServerReportState(const TArray<FGameItemSoakContainerState>& States, int32 NumOps, int32 NumPendingPredictions, int32 InMaxPendingPredictions);
+
+	/** Start or restart the bot timer on the owning client. */
+	void StartBot();
+
+	void TickBot();
+
+	/** Perform a random operation on the player's containers. */
+	void PerformRandomOp();
+
+	/** Create new items in random containers, up to MaxLootedItems. */
+	void LootItems();
+
+	UGameItemControllerComponent* GetControllerComponent() const;
+
+	/** Return all containers for the player, from the controller, player state and pawn. */
+	TArray<UGameItemContainer*> GetPlayerContainers() const;
+
+	FTimerHandle BotTimer;
+
+	/** The time at which the bot will begin settling. */
+	double SettleStartTime = 0.0;
+
+	/** The number of operations performed by the bot on the client. */
+	int32 NumBotOps = 0;
+
+	/** The most pending prediction keys seen on the client since the last report. */
+	int32 MaxPendingPredictions = 0;
+
+	/** Stats received from the client on the server. */
+	int32 NumReports = 0;
+	int32 NumDivergences = 0;
+	int32 ReportedNumOps = 0;
+	int32 ReportedPendingPredictions = 0;
+	int32 ReportedMaxPendingPredictions = 0;
+};
@@ -0,0 +1,119 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+
+#include "GameItemDropSimulationCommandlet.h"
+
+#include "GameItemsEditorModule.h"
+#include "DropTable/GameItemDropParams.h"
+#include "DropTable/GameItemDropSimulation.h"
+#include "DropTable/GameItemDropTableRow.h"
+#include "Engine/DataTable.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(GameItemDropSimulationCommandlet)
+
+
+UGameItemDropSimulationCommandlet::UGameItemDropSimulationCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	ShowErrorCount = true;
+	HelpDescription = TEXT("Roll game item drop tables many times and report item frequencies, count distributions and econ value.");
+	HelpUsage = TEXT("-run=GameItemDropSimulation -Table=/Game/Path/DT_Loot [-Row=RowName] [-Rolls=100000] [-Seed=0] ")
+		TEXT("[-Tasks=0] [-EconValueMin=1] [-EconValueMax=1] [-Out=FileName]");
+}
+
+int32 UGameItemDropSimulationCommandlet::Main(const FString& Params)
+{
+	FString TablePath;
+	if (!FParse::Value(*Params, TEXT("Table="), TablePath))
+	{
+		UE_LOG(LogGameItemsEditor, Error, TEXT("Missing -Table argument. Usage: %s"), *HelpUsage);
+		return 1;
+	}
+
+	const UDataTable* DataTable = LoadObject<UDataTable>(nullptr, *TablePath);
+	if (!DataTable || !DataTable->GetRowStruct() || !DataTable->GetRowStruct()->IsChildOf(FGameItemDropTableRow::StaticStruct()))
+	{
+		UE_LOG(LogGameItemsEditor, Error, TEXT("%s is not a game item drop table."), *TablePath);
+		return 1;
+	}
+
+	FString RowName;
+	FParse::Value(*Params, TEXT("Row="), RowName);
+
+	FGameItemDropSimulation::FParams SimParams;
+	SimParams.NumRolls = 100000;
+	FParse::Value(*Params, TEXT("Rolls="), SimParams.NumRolls);
+	FParse::Value(*Params, TEXT("Seed="), SimParams.Seed);
+	FParse::Value(*Params, TEXT("Tasks="), SimParams.MaxTasks);
+
+	FGameItemDropContext Context;
+	float EconValueMin = 0.f;
+	float EconValueMax = 0.f;
+	const bool bHasEconMin = FParse::Value(*Params, TEXT("EconValueMin="), EconValueMin);
+	const bool bHasEconMax = FParse::Value(*Params, TEXT("EconValueMax="), EconValueMax);
+	if (bHasEconMin || bHasEconMax)
+	{
+		FGameItemDropParams_EconValue EconParams;
+		EconParams.EconValueMin = bHasEconMin ? EconValueMin : EconValueMax;
+		EconParams.EconValueMax = bHasEconMax ? EconValueMax : EconValueMin;
+		Context.Params = TInstancedStruct<FGameItemDropParams>::Make(EconParams);
+	}
+
+	TArray<FGameItemDropSimulationResult> Results;
+	DataTable->ForeachRow<FGameItemDropTableRow>(TEXT("UGameItemDropSimulationCommandlet"), [&](const FName& Key, const FGameItemDropTableRow& Row)
+	{
+		if (!RowName.IsEmpty() && Key != FName(*RowName))
+		{
+			return;
+		}
+
+		FGameItemDropSimulationResult& Result = Results.Add_GetRef(FGameItemDropSimulation::Run(Row, Context, SimParams));
+		Result.Name = Key.ToString();
+		Result.Dump(*GLog);
+	});
+
+	if (Results.IsEmpty())
+	{
+		UE_LOG(LogGameItemsEditor, Error, TEXT("No rows found to simulate in %s."), *TablePath);
+		return 1;
+	}
+
+	FString FileName = FString::Printf(TEXT("DropSimulation-%s-%s"), *DataTable->GetName(), *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("Out="), FileName);
+
+	FString Json = TEXT("[\n");
+	FString Csv;
+	for (int32 Idx = 0; Idx < Results.Num(); ++Idx)
+	{
+		Json += Results[Idx].ToJson() + (Idx < Results.Num() - 1 ? TEXT(",\n") : TEXT(""));
+
+		// prefix each csv line with the row name
+		TArray<FString> Lines;
+		Results[Idx].ToCsv().ParseIntoArrayLines(Lines);
+		for (int32 LineIdx = 0; LineIdx < Lines.Num(); ++LineIdx)
+		{
+			if (LineIdx == 0)
+			{
+				if (Idx == 0)
+				{
+					Csv += TEXT("Row,") + Lines[LineIdx] + TEXT("\n");
+				}
+				continue;
+			}
+			Csv += Results[Idx].Name + TEXT(",") + Lines[LineIdx] + TEXT("\n");
+		}
+	}
+	Json += TEXT("]\n");
+
+	const FString BasePath = FPaths::ProfilingDir() / TEXT("GameItems") / FileName;
+	FFileHelper::SaveStringToFile(Json, *(BasePath + TEXT(".json")));
+	FFileHelper::SaveStringToFile(Csv, *(BasePath + TEXT(".csv")));
+
+	UE_LOG(LogGameItemsEditor, Display, TEXT("Wrote drop simulation results to %s.json/.csv"), *FPaths::ConvertRelativePathToFull(BasePath));
+	return 0;
+}
@@ -0,0 +1,27 @@
+﻿// Copyright Bohdon Sayre, All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GameItemDropSimulationCommandlet.generated.h"
+
+
+/**
+ * Rolls the rows of a drop table many times without creating any items, and reports how often each item drops,
+ * the distribution of counts, the expected econ value and the number of rolls per second.
+ * Results are logged, and written to Saved/Profiling/GameItems as json and csv.
+ *
+ * Usage: -run=GameItemDropSimulation -Table=/Game/Path/DT_Loot [-Row=RowName] [-Rolls=100000] [-Seed=0]
+ *        [-Tasks=0] [-EconValueMin=1] [-EconValueMax=1] [-Out=FileName]
+ */
+UCLASS()
+class GAMEITEMSEDITOR_API UGameItemDropSimulationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UGameItemDropSimulationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
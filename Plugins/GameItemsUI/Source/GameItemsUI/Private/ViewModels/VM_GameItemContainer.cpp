@@ -4,8 +4,11 @@
 #include "ViewModels/VM_GameItemContainer.h"
 
 #include "GameItemContainer.h"
+#include "GameItemsModule.h"
 #include "ViewModels/VM_GameItemSlot.h"
 
+DECLARE_CYCLE_STAT(TEXT("VM GetSlotViewModels"), STAT_GameItemsUI_GetSlotViewModels, STATGROUP_GameItems);
+
 
 void UVM_GameItemContainer::SetContainer(UGameItemContainer* NewContainer)
 {
@@ -47,6 +50,9 @@ TArray<UGameItem*> UVM_GameItemContainer::GetItems() const
 
 TArray<UVM_GameItemSlot*> UVM_GameItemContainer::GetSlotViewModels() const
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UVM_GameItemContainer::GetSlotViewModels);
+	SCOPE_CYCLE_COUNTER(STAT_GameItemsUI_GetSlotViewModels);
+
 	UVM_GameItemContainer* MutableThis = const_cast<UVM_GameItemContainer*>(this);
 
 	const int32 OldNumSlots = SlotViewModels.Num();
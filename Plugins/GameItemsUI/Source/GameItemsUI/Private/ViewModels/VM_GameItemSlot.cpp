@@ -5,10 +5,14 @@
 
 #include "GameItemContainer.h"
 #include "GameItemContainerDef.h"
+#include "GameItemsModule.h"
 #include "GameItemSubsystem.h"
 #include "Engine/GameInstance.h"
 #include "Engine/World.h"
 
+DECLARE_CYCLE_STAT(TEXT("VM UpdateSlotItem"), STAT_GameItemsUI_UpdateSlotItem, STATGROUP_GameItems);
+DECLARE_CYCLE_STAT(TEXT("VM CreateSlotViewModels"), STAT_GameItemsUI_CreateSlotViewModels, STATGROUP_GameItems);
+
 
 UVM_GameItemSlot::UVM_GameItemSlot()
 	: Container(nullptr),
@@ -34,8 +38,7 @@ void UVM_GameItemSlot::SetContainerAndSlot(UGameItemContainer* NewContainer, int
 	{
 		if (Container)
 		{
-			Container->OnItemSlotChangedEvent.RemoveAll(this);
-			Container->OnItemSlotsChangedEvent.RemoveAll(this);
+			Container->RemoveSlotChangedListener(Slot, this);
 			Container->OnNumSlotsChangedEvent.RemoveAll(this);
 		}
 
@@ -44,8 +47,8 @@ void UVM_GameItemSlot::SetContainerAndSlot(UGameItemContainer* NewContainer, int
 
 		if (Container)
 		{
-			Container->OnItemSlotChangedEvent.AddUObject(this, &UVM_GameItemSlot::OnItemSlotChanged);
-			Container->OnItemSlotsChangedEvent.AddUObject(this, &UVM_GameItemSlot::OnItemSlotsChanged);
+			// listen to only this slot, so that changes to other slots don't notify every slot view model
+			Container->GetSlotChangedEvent(Slot).AddUObject(this, &UVM_GameItemSlot::OnItemSlotChanged);
 			Container->OnNumSlotsChangedEvent.AddUObject(this, &UVM_GameItemSlot::OnNumSlotsChanged);
 		}
 
@@ -79,6 +82,9 @@ void UVM_GameItemSlot::MoveItem(UGameItemContainer* ToContainer, bool bAllowPart
 
 void UVM_GameItemSlot::UpdateItem()
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UVM_GameItemSlot::UpdateItem);
+	SCOPE_CYCLE_COUNTER(STAT_GameItemsUI_UpdateSlotItem);
+
 	UGameItem* NewItem = nullptr;
 	if (Container && Slot != INDEX_NONE)
 	{
@@ -102,14 +108,6 @@ void UVM_GameItemSlot::OnItemSlotChanged(int32 InSlot)
 	}
 }
 
-void UVM_GameItemSlot::OnItemSlotsChanged(int32 StartSlot, int32 EndSlot)
-{
-	if (StartSlot <= Slot && Slot <= EndSlot)
-	{
-		UpdateItem();
-	}
-}
-
 void UVM_GameItemSlot::OnNumSlotsChanged(int32 NewNumSlots, int32 OldNumSlots)
 {
 	if (Slot >= NewNumSlots)
@@ -129,6 +127,9 @@ void UVM_GameItemSlot::OnNumSlotsChanged(int32 NewNumSlots, int32 OldNumSlots)
 
 TArray<UVM_GameItemSlot*> UVM_GameItemSlot::CreateSlotViewModelsForContainer(UObject* Outer, UGameItemContainer* InContainer)
 {
+	TRACE_CPUPROFILER_EVENT_SCOPE(UVM_GameItemSlot::CreateSlotViewModelsForContainer);
+	SCOPE_CYCLE_COUNTER(STAT_GameItemsUI_CreateSlotViewModels);
+
 	TArray<UVM_GameItemSlot*> Result;
 	if (!Outer || !InContainer)
 	{
@@ -66,7 +66,6 @@ protected:
 	void UpdateItem();
 
 	void OnItemSlotChanged(int32 InSlot);
-	void OnItemSlotsChanged(int32 StartSlot, int32 EndSlot);
 	void OnNumSlotsChanged(int32 NewNumSlots, int32 OldNumSlots);
 
 public:
@@ -3,6 +3,7 @@
 
 #include "Equipment/AbilityEquipment.h"
 
+#include "AbilitySystemComponent.h"
 #include "AbilitySystemGlobals.h"
 #include "GameItemsModule.h"
 #include "Equipment/AbilityEquipmentDef.h"
@@ -65,6 +66,10 @@ void UAbilityEquipment::GiveAbilitySets()
 	UE_LOG(LogGameItems, Verbose, TEXT("%s[%s] Giving %d ability sets"),
 		*GetOwner()->GetDebugPrefix(), *GetReadableName(), AbilityEquipDef->AbilitySets.Num());
 
+	TRACE_CPUPROFILER_EVENT_SCOPE(UAbilityEquipment::GiveAbilitySets);
+
+	const int32 AbilityLevel = GetAbilityLevel();
+	AbilitySetHandles.Reserve(AbilitySetHandles.Num() + AbilityEquipDef->AbilitySets.Num());
 	for (const UExtendedAbilitySet* AbilitySet : AbilityEquipDef->AbilitySets)
 	{
 		if (!AbilitySet)
@@ -74,7 +79,7 @@ void UAbilityEquipment::GiveAbilitySets()
 			continue;
 		}
 
-		AbilitySetHandles = AbilitySet->GiveToAbilitySystem(AbilitySystem, this, GetAbilityLevel());
+		AbilitySetHandles.Add(AbilitySet->GiveToAbilitySystem(AbilitySystem, this, AbilityLevel));
 	}
 }
 
@@ -85,13 +90,22 @@ void UAbilityEquipment::RemoveAbilitySets()
 		return;
 	}
 
+	TRACE_CPUPROFILER_EVENT_SCOPE(UAbilityEquipment::RemoveAbilitySets);
+
 	if (UAbilitySystemComponent* AbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(GetOwningActor()))
 	{
-		if (AbilitySetHandles.AbilitySet)
+		// remove in reverse order, in case any sets depend on those granted before them
+		for (int32 Idx = AbilitySetHandles.Num() - 1; Idx >= 0; --Idx)
 		{
-			AbilitySetHandles.AbilitySet->RemoveFromAbilitySystem(AbilitySystem, AbilitySetHandles, bEndImmediately, bKeepAttributeSets);
+			FExtendedAbilitySetHandles& Handles = AbilitySetHandles[Idx];
+			if (Handles.AbilitySet)
+			{
+				Handles.AbilitySet->RemoveFromAbilitySystem(AbilitySystem, Handles, bEndImmediately, bKeepAttributeSets);
+			}
 		}
 	}
+
+	AbilitySetHandles.Reset();
 }
 
 #if WITH_EDITOR
@@ -43,9 +43,9 @@ public:
 	virtual int32 GetAbilityLevel() const;
 
 protected:
-	/** Ability and effect handles that were granted by this equipment. */
+	/** Ability and effect handles that were granted by this equipment, for each ability set. */
 	UPROPERTY()
-	FExtendedAbilitySetHandles AbilitySetHandles;
+	TArray<FExtendedAbilitySetHandles> AbilitySetHandles;
 
 	virtual void OnEquipped() override;
 	virtual void OnUnequipped() override;